@@ -28,6 +28,17 @@ export interface ExportProgress {
 
 export type ProgressCallback = (progress: ExportProgress) => void;
 
+/**
+ * Renders a project directly, without an audio graph, returning one array
+ * per channel (e.g. through PluginHost.renderOffline())
+ */
+export type DirectRenderCallback = (
+  sampleRate: number,
+  length: number,
+  onProgress: (progress: number) => void,
+  isCancelled: () => boolean
+) => Promise<Float32Array[]>;
+
 /**
  * Audio Exporter class for offline rendering and encoding
  */
@@ -43,6 +54,50 @@ export class AudioExporter {
     duration: number,
     options: ExportOptions,
     onProgress?: ProgressCallback
+  ): Promise<Blob> {
+    return this.renderAndEncode(
+      (onRenderProgress) => this.renderOffline(
+        renderCallback,
+        duration,
+        options.sampleRate,
+        options.channels,
+        onRenderProgress
+      ),
+      options,
+      onProgress
+    );
+  }
+
+  /**
+   * Export audio rendered directly by the caller, faster than realtime:
+   * plugins are driven through their processOffline() export in large
+   * blocks instead of through an OfflineAudioContext graph
+   */
+  async exportDirect(
+    render: DirectRenderCallback,
+    duration: number,
+    options: ExportOptions,
+    onProgress?: ProgressCallback
+  ): Promise<Blob> {
+    return this.renderAndEncode(
+      async (onRenderProgress) => {
+        const length = Math.ceil(duration * options.sampleRate);
+        const rendered = await render(options.sampleRate, length, onRenderProgress, () => this.cancelled);
+        return this.createBuffer(rendered, length, options.sampleRate, options.channels);
+      },
+      options,
+      onProgress
+    );
+  }
+
+  /**
+   * Render with the given renderer, then normalize and encode, reporting
+   * progress for both phases
+   */
+  private async renderAndEncode(
+    render: (onProgress: (progress: number) => void) => Promise<AudioBuffer>,
+    options: ExportOptions,
+    onProgress?: ProgressCallback
   ): Promise<Blob> {
     this.cancelled = false;
 
@@ -54,19 +109,13 @@ export class AudioExporter {
         message: 'Initializing offline renderer...',
       });
 
-      const audioBuffer = await this.renderOffline(
-        renderCallback,
-        duration,
-        options.sampleRate,
-        options.channels,
-        (progress) => {
-          onProgress?.({
-            phase: 'rendering',
-            progress: progress * 0.5, // Rendering is 50% of total
-            message: `Rendering audio: ${Math.round(progress * 100)}%`,
-          });
-        }
-      );
+      const audioBuffer = await render((progress) => {
+        onProgress?.({
+          phase: 'rendering',
+          progress: progress * 0.5, // Rendering is 50% of total
+          message: `Rendering audio: ${Math.round(progress * 100)}%`,
+        });
+      });
 
       if (this.cancelled) {
         throw new Error('Export cancelled');
@@ -208,6 +257,46 @@ export class AudioExporter {
     }
   }
 
+  /**
+   * Wrap directly rendered channels in an AudioBuffer, mixing down to mono
+   * or duplicating a mono render as needed
+   */
+  private createBuffer(
+    rendered: Float32Array[],
+    length: number,
+    sampleRate: number,
+    channels: number
+  ): AudioBuffer {
+    const buffer = new AudioBuffer({
+      numberOfChannels: channels,
+      length,
+      sampleRate,
+    });
+
+    if (rendered.length === 0) {
+      return buffer;
+    }
+
+    if (channels === 1 && rendered.length > 1) {
+      const mono = buffer.getChannelData(0);
+      const gain = 1 / rendered.length;
+      for (const data of rendered) {
+        const count = Math.min(data.length, length);
+        for (let i = 0; i < count; i++) {
+          mono[i] += data[i] * gain;
+        }
+      }
+      return buffer;
+    }
+
+    for (let channel = 0; channel < channels; channel++) {
+      const data = rendered[Math.min(channel, rendered.length - 1)];
+      buffer.copyToChannel(data.length > length ? data.subarray(0, length) : data, channel);
+    }
+
+    return buffer;
+  }
+
   /**
    * Normalize audio buffer to peak at 0dB
    */
@@ -486,6 +486,29 @@ export class AutomationRecorder {
     return value * (lane.maxValue - lane.minValue) + lane.minValue;
   }
 
+  /**
+   * Points of a lane covering startTime to endTime, in the parameter's range:
+   * from the last point at or before startTime to the first at or after
+   * endTime, so the curve can be evaluated anywhere in between. This is the
+   * breakpoint window PluginHost.setAutomation() uploads to plugins.
+   */
+  getSegments(laneId: string, startTime: number, endTime: number): AutomationPoint[] {
+    const lane = this.lanes.get(laneId);
+    if (!lane || lane.points.length === 0) return [];
+    
+    const points = lane.points;
+    let first = 0;
+    while (first + 1 < points.length && points[first + 1].time <= startTime) first++;
+    let last = first;
+    while (last + 1 < points.length && points[last].time < endTime) last++;
+    
+    const range = lane.maxValue - lane.minValue;
+    return points.slice(first, last + 1).map(point => ({
+      ...point,
+      value: point.value * range + lane.minValue
+    }));
+  }
+
   /**
    * Clear all points from a lane
    */
@@ -8,9 +8,11 @@
  * - Stop on new selection
  * - Volume control
  * - Loop preview option
+ * - DrumSynth (.ds) patches, rendered through DrumSynthRenderer
  */
 
 import { clamp } from './utils/AudioMath';
+import { getDrumSynthRenderer, isDrumSynthPatch } from './plugins/DrumSynthRenderer';
 
 export interface SampleInfo {
   name: string;
@@ -110,6 +112,10 @@ export class SamplePreview {
   private async loadSample(path: string): Promise<AudioBuffer> {
     this.onLoadProgress?.(0);
     
+    if (isDrumSynthPatch(path)) {
+      return this.renderPatch(path);
+    }
+    
     const response = await fetch(path);
     
     if (!response.ok) {
@@ -154,6 +160,20 @@ export class SamplePreview {
     return audioBuffer;
   }
 
+  /**
+   * Render a DrumSynth patch at the context's rate (usually from the render cache)
+   */
+  private async renderPatch(path: string): Promise<AudioBuffer> {
+    const sampleRate = this.audioContext.sampleRate;
+    const pcm = await getDrumSynthRenderer().render(path, sampleRate);
+    
+    const buffer = this.audioContext.createBuffer(1, pcm.length, sampleRate);
+    buffer.copyToChannel(pcm, 0);
+    
+    this.onLoadProgress?.(1);
+    return buffer;
+  }
+
   /**
    * Add a sample to the cache
    */
@@ -76,7 +76,7 @@ export type { LoadedSample, ScheduledSample, SampleClipData } from './SamplePlay
 
 // Audio Exporter
 export { AudioExporter } from './AudioExporter';
-export type { ExportFormat, ExportOptions, ExportProgress, BitDepth, SampleRate } from './AudioExporter';
+export type { ExportFormat, ExportOptions, ExportProgress, BitDepth, SampleRate, DirectRenderCallback } from './AudioExporter';
 
 // Audio utilities
 export {
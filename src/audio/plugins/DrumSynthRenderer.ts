@@ -0,0 +1,410 @@
+// Copyright (c) 2025 Jema Technology.
+// Distributed under the license specified in the root directory of this project.
+/**
+ * DrumSynthRenderer - DrumSynth (.ds) patches rendered to PCM for auditioning
+ *
+ * Patches are rendered by wasm/drumsynth/drumsynth.c, one renderPatch() call
+ * per sound, on a pool of Web Workers. Every render is cached in the
+ * PluginLoader database under a key made of the content hashes of the patch
+ * and of the renderer module plus the sample rate, so a patch is rendered
+ * once per sample rate and reused across sessions, and a new renderer build
+ * never serves stale sounds.
+ *
+ * The sample browser calls prerender() with a folder's patches as it opens
+ * it, so they are ready before they are clicked; render() for an audition
+ * goes to the front of the queue.
+ */
+
+import { getPluginLoader, hashBytes, type RenderCacheEntry } from './PluginLoader';
+
+/**
+ * Where the renderer module is served
+ */
+export const DRUMSYNTH_WASM_URL = '/wasm/drumsynth.wasm';
+
+/**
+ * Cores left to the main thread and the audio thread
+ */
+const RESERVED_CORES = 2;
+const MAX_RENDER_WORKERS = 4;
+
+/**
+ * Renders kept in memory besides the database
+ */
+const MEMORY_CACHE_SIZE = 128;
+
+/**
+ * Workers to render on
+ */
+function poolSize(): number {
+  const cores = typeof navigator !== 'undefined' ? navigator.hardwareConcurrency || 1 : 1;
+  return Math.max(1, Math.min(MAX_RENDER_WORKERS, cores - RESERVED_CORES));
+}
+
+/**
+ * Whether a sample path is a DrumSynth patch
+ */
+export function isDrumSynthPatch(path: string): boolean {
+  return path.toLowerCase().endsWith('.ds');
+}
+
+interface DrumSynthExports {
+  memory: WebAssembly.Memory;
+  renderPatch: (textPtr: number, length: number, sampleRate: number) => number;
+  getRenderOutput: () => number;
+  malloc: (size: number) => number;
+  free: (ptr: number) => void;
+}
+
+/**
+ * Instantiate the renderer. It only needs libc, so imports are satisfied
+ * with Math or no-ops. Keep in sync with the worker source below.
+ */
+async function instantiateRenderer(module: WebAssembly.Module): Promise<DrumSynthExports> {
+  const imports: Record<string, Record<string, unknown>> = {};
+  for (const entry of WebAssembly.Module.imports(module)) {
+    if (entry.kind !== 'function') continue;
+    const scope = imports[entry.module] || (imports[entry.module] = {});
+    const math = Math as unknown as Record<string, unknown>;
+    scope[entry.name] = typeof math[entry.name] === 'function' ? math[entry.name] : () => 0;
+  }
+  const instance = await WebAssembly.instantiate(module, imports as WebAssembly.Imports);
+  return instance.exports as unknown as DrumSynthExports;
+}
+
+/**
+ * Render one patch, as the worker does. Returns null if the text is not a
+ * DrumSynth patch.
+ */
+function renderWith(exports: DrumSynthExports, patch: Uint8Array, sampleRate: number): Float32Array | null {
+  const textPtr = exports.malloc(patch.length);
+  if (!textPtr) throw new Error('DrumSynth patch allocation failed');
+
+  try {
+    new Uint8Array(exports.memory.buffer, textPtr, patch.length).set(patch);
+    const frames = exports.renderPatch(textPtr, patch.length, sampleRate);
+    // View created after the call, in case memory grew
+    return frames > 0 ? new Float32Array(exports.memory.buffer, exports.getRenderOutput(), frames).slice() : null;
+  } finally {
+    exports.free(textPtr);
+  }
+}
+
+/**
+ * Render worker: instantiates the module it is sent, then renders patches
+ * one message at a time
+ */
+const renderWorkerSource = `
+  let ready = null;
+
+  async function instantiateRenderer(wasmModule) {
+    const imports = {};
+    for (const entry of WebAssembly.Module.imports(wasmModule)) {
+      if (entry.kind !== 'function') continue;
+      const scope = imports[entry.module] || (imports[entry.module] = {});
+      scope[entry.name] = typeof Math[entry.name] === 'function' ? Math[entry.name] : () => 0;
+    }
+    const { exports } = await WebAssembly.instantiate(wasmModule, imports);
+    return exports;
+  }
+
+  self.onmessage = async (event) => {
+    const message = event.data;
+    if (message.type === 'init') {
+      ready = instantiateRenderer(message.wasmModule);
+      return;
+    }
+
+    const { id, patch, sampleRate } = message;
+    try {
+      const exports = await ready;
+      const textPtr = exports.malloc(patch.length);
+      if (!textPtr) throw new Error('DrumSynth patch allocation failed');
+      new Uint8Array(exports.memory.buffer, textPtr, patch.length).set(patch);
+      const frames = exports.renderPatch(textPtr, patch.length, sampleRate);
+      exports.free(textPtr);
+
+      const pcm = frames > 0 ? new Float32Array(exports.memory.buffer, exports.getRenderOutput(), frames).slice() : null;
+      self.postMessage({ id, pcm }, pcm ? [pcm.buffer] : []);
+    } catch (error) {
+      self.postMessage({ id, error: String(error) });
+    }
+  };
+`;
+
+let workerUrl: string | null = null;
+
+interface RenderJob {
+  id: number;
+  patch: Uint8Array;
+  sampleRate: number;
+  resolve: (pcm: Float32Array | null) => void;
+  reject: (error: Error) => void;
+}
+
+interface RenderWorker {
+  worker: Worker;
+  job: RenderJob | null;
+}
+
+export interface PrerenderOptions {
+  onProgress?: (done: number, total: number) => void;
+  /** Checked between patches; queued patches are dropped once it returns true */
+  isCancelled?: () => boolean;
+}
+
+/**
+ * DrumSynthRenderer class - renders, caches and serves DrumSynth patches
+ */
+export class DrumSynthRenderer {
+  private static instance: DrumSynthRenderer | null = null;
+
+  private wasmUrl: string;
+  private module: Promise<{ module: WebAssembly.Module; hash: string }> | null = null;
+
+  // Workers, or the renderer on this thread where workers are unavailable
+  private workers: RenderWorker[] = [];
+  private localRenderer: Promise<DrumSynthExports> | null = null;
+  private queue: RenderJob[] = [];
+  private nextJobId = 0;
+
+  // Patch text by URL, and renders by cache key (oldest first)
+  private patches: Map<string, Promise<Uint8Array>> = new Map();
+  private renders: Map<string, Float32Array> = new Map();
+  private pending: Map<string, Promise<Float32Array>> = new Map();
+
+  constructor(wasmUrl: string = DRUMSYNTH_WASM_URL) {
+    this.wasmUrl = wasmUrl;
+  }
+
+  /**
+   * Get singleton instance
+   */
+  public static getInstance(): DrumSynthRenderer {
+    if (!DrumSynthRenderer.instance) {
+      DrumSynthRenderer.instance = new DrumSynthRenderer();
+    }
+    return DrumSynthRenderer.instance;
+  }
+
+  /**
+   * Render the patch at a URL at sampleRate, from the cache when possible.
+   * Returns mono PCM.
+   */
+  public async render(url: string, sampleRate: number): Promise<Float32Array> {
+    const patch = await this.fetchPatch(url);
+    return this.renderPatch(patch, sampleRate, true);
+  }
+
+  /**
+   * Render patch text (the bytes of a .ds file) at sampleRate
+   */
+  public async renderPatch(patch: Uint8Array, sampleRate: number, urgent: boolean = true): Promise<Float32Array> {
+    const key = await this.cacheKey(patch, sampleRate);
+
+    const cached = this.getMemoryCached(key);
+    if (cached) return cached;
+
+    let pending = this.pending.get(key);
+    if (!pending) {
+      pending = (async () => {
+        const stored = (await getPluginLoader().loadRenders([key]).catch(() => new Map())).get(key);
+        const pcm = stored ? stored.channels[0] : await this.renderUncached(patch, sampleRate, key, urgent);
+        this.setMemoryCached(key, pcm);
+        return pcm;
+      })();
+      this.pending.set(key, pending);
+      pending.finally(() => this.pending.delete(key)).catch(() => undefined);
+    }
+    return pending;
+  }
+
+  /**
+   * Render a set of patches ahead of auditioning, in parallel on the worker
+   * pool, skipping those already cached. Resolves once all are cached or
+   * the render is cancelled.
+   */
+  public async prerender(urls: string[], sampleRate: number, options: PrerenderOptions = {}): Promise<void> {
+    const patches = await Promise.all(urls.map(url => this.fetchPatch(url).catch(() => null)));
+    const keys = await Promise.all(patches.map(patch => patch ? this.cacheKey(patch, sampleRate) : null));
+    const stored = await getPluginLoader()
+      .loadRenders(keys.filter((key): key is string => !!key && !this.renders.has(key)))
+      .catch(() => new Map<string, RenderCacheEntry>());
+
+    // One queued job per worker at a time, so auditions get ahead and a
+    // cancelled prerender leaves nothing behind
+    let next = 0;
+    let done = 0;
+    const lane = async () => {
+      while (next < urls.length && !options.isCancelled?.()) {
+        const i = next++;
+        const patch = patches[i];
+        const key = keys[i];
+        if (patch && key && !this.renders.has(key) && !stored.has(key)) {
+          await this.renderPatch(patch, sampleRate, false).catch(error => {
+            console.warn(`DrumSynth render failed for ${urls[i]}:`, error);
+          });
+        }
+        options.onProgress?.(++done, urls.length);
+      }
+    };
+    await Promise.all(Array.from({ length: poolSize() }, lane));
+  }
+
+  /**
+   * Stop the workers and forget the in-memory renders (the database keeps them)
+   */
+  public dispose(): void {
+    for (const { worker, job } of this.workers) {
+      worker.terminate();
+      job?.reject(new Error('DrumSynth renderer disposed'));
+    }
+    for (const job of this.queue) {
+      job.reject(new Error('DrumSynth renderer disposed'));
+    }
+    this.workers = [];
+    this.queue = [];
+    this.localRenderer = null;
+    this.renders.clear();
+    this.patches.clear();
+
+    if (DrumSynthRenderer.instance === this) {
+      DrumSynthRenderer.instance = null;
+    }
+  }
+
+  private fetchPatch(url: string): Promise<Uint8Array> {
+    let patch = this.patches.get(url);
+    if (!patch) {
+      patch = fetch(url).then(async response => {
+        if (!response.ok) {
+          throw new Error(`Failed to fetch DrumSynth patch: ${response.statusText}`);
+        }
+        return new Uint8Array(await response.arrayBuffer());
+      });
+      this.patches.set(url, patch);
+      patch.catch(() => this.patches.delete(url));
+    }
+    return patch;
+  }
+
+  private loadModule(): Promise<{ module: WebAssembly.Module; hash: string }> {
+    if (!this.module) {
+      this.module = getPluginLoader().compileFromUrl(this.wasmUrl);
+      this.module.catch(() => {
+        this.module = null;
+      });
+    }
+    return this.module;
+  }
+
+  private async cacheKey(patch: Uint8Array, sampleRate: number): Promise<string> {
+    const [{ hash: rendererHash }, patchHash] = await Promise.all([this.loadModule(), hashBytes(patch)]);
+    return `drumsynth/${rendererHash}/${sampleRate}/${patchHash}`;
+  }
+
+  private getMemoryCached(key: string): Float32Array | undefined {
+    const pcm = this.renders.get(key);
+    if (pcm) {
+      // Most recently used last
+      this.renders.delete(key);
+      this.renders.set(key, pcm);
+    }
+    return pcm;
+  }
+
+  private setMemoryCached(key: string, pcm: Float32Array): void {
+    this.renders.set(key, pcm);
+    if (this.renders.size > MEMORY_CACHE_SIZE) {
+      const oldest = this.renders.keys().next().value;
+      if (oldest !== undefined) this.renders.delete(oldest);
+    }
+  }
+
+  private async renderUncached(patch: Uint8Array, sampleRate: number, key: string, urgent: boolean): Promise<Float32Array> {
+    const pcm = await this.runJob(patch, sampleRate, urgent);
+    if (!pcm) {
+      throw new Error('Not a DrumSynth patch');
+    }
+
+    getPluginLoader()
+      .saveRenders([{ key, sampleRate, channels: [pcm], timestamp: Date.now() }])
+      .catch(error => console.warn('Failed to cache DrumSynth render:', error));
+    return pcm;
+  }
+
+  /**
+   * Queue a render, at the front if urgent
+   */
+  private async runJob(patch: Uint8Array, sampleRate: number, urgent: boolean): Promise<Float32Array | null> {
+    const { module } = await this.loadModule();
+
+    if (this.startWorkers(module) === 0) {
+      if (!this.localRenderer) this.localRenderer = instantiateRenderer(module);
+      return renderWith(await this.localRenderer, patch, sampleRate);
+    }
+
+    return new Promise((resolve, reject) => {
+      const job: RenderJob = { id: this.nextJobId++, patch, sampleRate, resolve, reject };
+      if (urgent) {
+        this.queue.unshift(job);
+      } else {
+        this.queue.push(job);
+      }
+      this.dispatch();
+    });
+  }
+
+  /**
+   * Start the pool on first use. Returns the number of workers.
+   */
+  private startWorkers(module: WebAssembly.Module): number {
+    if (this.workers.length > 0 || typeof Worker === 'undefined') {
+      return this.workers.length;
+    }
+
+    const count = poolSize();
+    if (!workerUrl) {
+      workerUrl = URL.createObjectURL(new Blob([renderWorkerSource], { type: 'application/javascript' }));
+    }
+
+    for (let i = 0; i < count; i++) {
+      const entry: RenderWorker = { worker: new Worker(workerUrl), job: null };
+      entry.worker.onmessage = (event: MessageEvent<{ id: number; pcm?: Float32Array | null; error?: string }>) => {
+        const job = entry.job;
+        entry.job = null;
+        if (job && job.id === event.data.id) {
+          if (event.data.error) {
+            job.reject(new Error(event.data.error));
+          } else {
+            job.resolve(event.data.pcm ?? null);
+          }
+        }
+        this.dispatch();
+      };
+      entry.worker.onerror = (event: ErrorEvent) => {
+        entry.job?.reject(new Error(event.message || 'DrumSynth render worker failed'));
+        entry.job = null;
+        this.dispatch();
+      };
+      entry.worker.postMessage({ type: 'init', wasmModule: module });
+      this.workers.push(entry);
+    }
+    return count;
+  }
+
+  /**
+   * Hand queued jobs to idle workers
+   */
+  private dispatch(): void {
+    for (const entry of this.workers) {
+      if (entry.job || this.queue.length === 0) continue;
+      const job = this.queue.shift()!;
+      entry.job = job;
+      entry.worker.postMessage({ type: 'render', id: job.id, patch: job.patch, sampleRate: job.sampleRate });
+    }
+  }
+}
+
+// Export singleton getter
+export const getDrumSynthRenderer = (): DrumSynthRenderer => DrumSynthRenderer.getInstance();
@@ -6,6 +6,24 @@
  */
 
 import type { EnvelopeParams } from '../../types/audio';
+import type { AutomationPoint } from '../AutomationRecorder';
+import {
+  SharedMeterSlot,
+  SharedParameterBlock,
+  sharedParameterReaderSource,
+  type SharedMeters
+} from './SharedParameterBlock';
+import { getPluginLoader } from './PluginLoader';
+import { getPluginLoadMonitor } from './PluginLoadMonitor';
+import {
+  WASMInstancePool,
+  pluginMemoryDescriptor,
+  wasmInstancePoolSource,
+  type PooledInstance,
+  type PooledModule
+} from './WASMInstancePool';
+import { OFFLINE_BLOCK_SIZE, renderPluginOffline, type OfflineRenderOptions } from './WASMOfflineRenderer';
+import { isThreadedModule, pluginWasmUrl, renderThreadsSource, startRenderThreads } from './WASMRenderThreads';
 
 /**
  * Plugin types
@@ -27,6 +45,8 @@ export interface WAPManifest {
   // WASM module info
   wasmUrl: string;
   wasmSize?: number;
+  /** Build with render threads, used instead of wasmUrl on cross-origin isolated pages */
+  wasmThreadsUrl?: string;
   
   // Audio configuration
   audioInputs: number;
@@ -104,6 +124,39 @@ export interface PluginEvent {
 
 export type PluginEventCallback = (event: PluginEvent) => void;
 
+/**
+ * Timestamped event types understood by processWithEvents()
+ * (mirrors TimedEventType in wasm/templates/dsp/events.h)
+ */
+export const TimedEventType = {
+  noteOn: 1,
+  noteOff: 2,
+  controlChange: 3,
+  pitchBend: 4
+} as const;
+
+/**
+ * Int32 fields per packed event: sampleOffset, type, data1, data2, channel
+ */
+export const TIMED_EVENT_INT32S = 5;
+
+/**
+ * Curve codes understood by setAutomation()
+ * (mirrors AutomationCurve in wasm/templates/dsp/automation.h)
+ */
+export const AutomationCurveCode = {
+  linear: 0,
+  smooth: 1,
+  step: 2,
+  exponential: 3,
+  bezier: 4
+} as const;
+
+/**
+ * 32-bit fields per packed breakpoint: frame, value, curve, tension
+ */
+export const AUTOMATION_POINT_INT32S = 4;
+
 /**
  * WASM Plugin Instance - represents a loaded plugin
  */
@@ -115,7 +168,14 @@ export interface WASMPluginInstance {
   workletNode?: AudioWorkletNode;
   memory: WebAssembly.Memory;
   
-  // Function exports from WASM
+  // This instance's handle in the module shared by all instances of the plugin
+  pooledInstance: PooledInstance;
+  moduleKey: string;
+  
+  // Lock-free parameter/meter exchange with the worklet (cross-origin isolated pages only)
+  sharedParams?: SharedParameterBlock;
+  
+  // Function exports from WASM, bound to this instance
   exports: {
     // Lifecycle
     init: (sampleRate: number, bufferSize: number) => void;
@@ -125,6 +185,10 @@ export interface WASMPluginInstance {
     // Audio processing
     process: (inputPtr: number, outputPtr: number, numSamples: number) => void;
     processBlock: (inputPtr: number, outputPtr: number, numSamples: number, numChannels: number) => void;
+    processWithEvents?: (inputPtr: number, outputPtr: number, numSamples: number, eventsPtr: number, numEvents: number) => void;
+    getEventBuffer?: () => number;
+    getEventBufferCapacity?: () => number;
+    processOffline?: (inputPtr: number, outputPtr: number, numSamples: number, eventsPtr: number, numEvents: number) => void;
     
     // Parameters
     getParameterCount: () => number;
@@ -136,11 +200,18 @@ export interface WASMPluginInstance {
     noteOff?: (note: number, channel: number) => void;
     controlChange?: (cc: number, value: number, channel: number) => void;
     pitchBend?: (value: number, channel: number) => void;
+    getActiveVoiceCount?: () => number;
+    isQuiescent?: () => number;
     
-    // State
+    // Automation curves (see wasm/templates/dsp/automation.h)
+    getAutomationBuffer?: (index: number) => number;
+    getAutomationCapacity?: () => number;
+    setAutomation?: (index: number, count: number) => void;
+    
+    // State snapshots (see wasm/templates/dsp/state.h)
     getStateSize?: () => number;
-    getState?: (ptr: number) => void;
-    setState?: (ptr: number, size: number) => void;
+    saveState?: (ptr: number) => number;
+    loadState?: (ptr: number, length: number) => number;
     
     // Memory management
     malloc: (size: number) => number;
@@ -148,6 +219,42 @@ export interface WASMPluginInstance {
   };
 }
 
+type PluginExports = WASMPluginInstance['exports'];
+
+/**
+ * Snapshot of a plugin instance through its saveState() export, or undefined
+ * if the plugin has none
+ */
+function savePluginState(exports: PluginExports, memory: WebAssembly.Memory): Uint8Array | undefined {
+  if (!exports.getStateSize || !exports.saveState) return undefined;
+  
+  const ptr = exports.malloc(exports.getStateSize());
+  if (!ptr) return undefined;
+  try {
+    const size = exports.saveState(ptr);
+    return new Uint8Array(memory.buffer, ptr, size).slice();
+  } finally {
+    exports.free(ptr);
+  }
+}
+
+/**
+ * Restore a snapshot through a plugin's loadState() export. Returns false if
+ * the plugin has none or rejects the snapshot.
+ */
+function loadPluginState(exports: PluginExports, memory: WebAssembly.Memory, state: Uint8Array): boolean {
+  if (!exports.loadState) return false;
+  
+  const ptr = exports.malloc(state.byteLength);
+  if (!ptr) return false;
+  try {
+    new Uint8Array(memory.buffer, ptr, state.byteLength).set(state);
+    return exports.loadState(ptr, state.byteLength) === 1;
+  } finally {
+    exports.free(ptr);
+  }
+}
+
 /**
  * Plugin Host - manages loading and running WASM plugins
  */
@@ -159,6 +266,10 @@ export class PluginHost {
   private pluginManifests: Map<string, WAPManifest> = new Map();
   private eventCallbacks: PluginEventCallback[] = [];
   
+  // saveState() requests waiting for their worklet's reply
+  private stateRequests: Map<number, (state: Uint8Array | null) => void> = new Map();
+  private nextStateRequest: number = 1;
+  
   // Worklet processor URL
   private workletProcessorUrl: string | null = null;
   private workletRegistered: boolean = false;
@@ -203,12 +314,24 @@ export class PluginHost {
           
           this.pluginId = options.processorOptions?.pluginId || '';
           this.wasmMemory = null;
+          this.pooled = null;
           this.inputPtr = 0;
           this.outputPtr = 0;
           this.bufferSize = 128;
           this.numChannels = 2;
           this.initialized = false;
           
+          // Timestamped events for processWithEvents()
+          this.eventPtr = 0;
+          this.eventCapacity = 0;
+          this.pendingEvents = [];
+          
+          // Shared parameter/meter block, if the page is cross-origin isolated
+          this.shared = null;
+          
+          // Snapshot received before the plugin was ready, loaded once it is
+          this.pendingState = null;
+          
           // Handle messages from main thread
           this.port.onmessage = (event) => {
             this.handleMessage(event.data);
@@ -226,67 +349,147 @@ export class PluginHost {
               }
               break;
             case 'noteOn':
-              if (this.wasmExports?.noteOn) {
+              if (this.eventCapacity > 0) {
+                this.queueEvent(${TimedEventType.noteOn}, data.note, data.velocity, data.channel, data.time);
+              } else if (this.wasmExports?.noteOn) {
                 this.wasmExports.noteOn(data.note, data.velocity, data.channel);
               }
               break;
             case 'noteOff':
-              if (this.wasmExports?.noteOff) {
+              if (this.eventCapacity > 0) {
+                this.queueEvent(${TimedEventType.noteOff}, data.note, 0, data.channel, data.time);
+              } else if (this.wasmExports?.noteOff) {
                 this.wasmExports.noteOff(data.note, data.channel);
               }
               break;
             case 'controlChange':
-              if (this.wasmExports?.controlChange) {
+              if (this.eventCapacity > 0) {
+                this.queueEvent(${TimedEventType.controlChange}, data.cc, data.value, data.channel, data.time);
+              } else if (this.wasmExports?.controlChange) {
                 this.wasmExports.controlChange(data.cc, data.value, data.channel);
               }
               break;
+            case 'pitchBend':
+              if (this.eventCapacity > 0) {
+                this.queueEvent(${TimedEventType.pitchBend}, data.value, 0, data.channel, data.time);
+              } else if (this.wasmExports?.pitchBend) {
+                this.wasmExports.pitchBend(data.value, data.channel);
+              }
+              break;
+            case 'setAutomation':
+              this.setAutomation(data.index, data.points, data.startFrame);
+              break;
+            case 'saveState': {
+              const state = this.saveState();
+              this.port.postMessage({ type: 'state', requestId: data.requestId, data: state }, state ? [state.buffer] : []);
+              break;
+            }
+            case 'loadState':
+              if (this.initialized) {
+                this.loadState(data.data);
+              } else {
+                this.pendingState = data.data;
+              }
+              break;
             case 'dispose':
               this.dispose();
               break;
           }
         }
         
+        // Upload packed breakpoints whose frames count from startFrame. Lanes
+        // are uploaded again every window, so they are dropped before init.
+        setAutomation(index, points, startFrame) {
+          const exports = this.wasmExports;
+          if (!this.initialized || !exports.setAutomation) return;
+          
+          const count = points.byteLength / (${AUTOMATION_POINT_INT32S} * 4);
+          if (count > 0) {
+            const ptr = exports.getAutomationBuffer(index);
+            if (!ptr) return;
+            const target = new Int32Array(this.wasmMemory.buffer, ptr, count * ${AUTOMATION_POINT_INT32S});
+            target.set(new Int32Array(points));
+            
+            // Frames count from the next processed frame inside the plugin
+            const shift = startFrame - currentFrame;
+            for (let i = 0; i < count; i++) {
+              target[i * ${AUTOMATION_POINT_INT32S}] += shift;
+            }
+          }
+          exports.setAutomation(index, count);
+        }
+        
+        // Snapshot of the plugin through saveState(), or null if it has none
+        saveState() {
+          const exports = this.wasmExports;
+          if (!this.initialized || !exports.getStateSize || !exports.saveState) return null;
+          
+          const ptr = exports.malloc(exports.getStateSize());
+          if (!ptr) return null;
+          const size = exports.saveState(ptr);
+          const state = new Uint8Array(this.wasmMemory.buffer, ptr, size).slice();
+          exports.free(ptr);
+          return state;
+        }
+        
+        loadState(state) {
+          const exports = this.wasmExports;
+          if (!exports.loadState) return;
+          
+          const ptr = exports.malloc(state.byteLength);
+          if (!ptr) return;
+          new Uint8Array(this.wasmMemory.buffer, ptr, state.byteLength).set(state);
+          exports.loadState(ptr, state.byteLength);
+          exports.free(ptr);
+        }
+        
         async initializeWASM(data) {
           try {
-            // Instantiate WASM module from transferred buffer
-            const wasmModule = await WebAssembly.compile(data.wasmBuffer);
-            
-            // Create shared memory
-            this.wasmMemory = new WebAssembly.Memory({
-              initial: 256,
-              maximum: 512,
-              shared: true
-            });
-            
-            // Import object for WASM
-            const importObject = {
-              env: {
-                memory: this.wasmMemory,
-                abort: () => console.error('WASM abort called'),
-                log: (value) => console.log('WASM log:', value),
-                sin: Math.sin,
-                cos: Math.cos,
-                tan: Math.tan,
-                exp: Math.exp,
-                log: Math.log,
-                pow: Math.pow,
-                sqrt: Math.sqrt,
-                floor: Math.floor,
-                ceil: Math.ceil,
-                round: Math.round,
-                abs: Math.abs,
-                min: Math.min,
-                max: Math.max
-              }
-            };
-            
-            const wasmInstance = await WebAssembly.instantiate(wasmModule, importObject);
-            this.wasmExports = wasmInstance.exports;
+            // Instances of the same plugin share one module and memory on this thread
+            this.pooled = await wasmInstancePool.acquire(data.moduleKey || this.pluginId, async () => {
+              const wasmModule = data.wasmModule || await WebAssembly.compile(data.wasmBuffer);
+              
+              // Sized by the main thread when it sent the module; threaded builds
+              // share their memory with the render threads
+              const memory = new WebAssembly.Memory(data.memoryDescriptor || {
+                initial: 256,
+                maximum: 512,
+                shared: isThreadedModule(wasmModule)
+              });
+              
+              // Import object for WASM
+              const importObject = {
+                env: {
+                  memory,
+                  abort: () => console.error('WASM abort called'),
+                  log: (value) => console.log('WASM log:', value),
+                  sin: Math.sin,
+                  cos: Math.cos,
+                  tan: Math.tan,
+                  exp: Math.exp,
+                  log: Math.log,
+                  pow: Math.pow,
+                  sqrt: Math.sqrt,
+                  floor: Math.floor,
+                  ceil: Math.ceil,
+                  round: Math.round,
+                  abs: Math.abs,
+                  min: Math.min,
+                  max: Math.max,
+                  // Clock for getProcessStats(); AudioWorkletGlobalScope may lack performance
+                  hostClock: typeof performance !== 'undefined' ? () => performance.now() : () => Date.now()
+                }
+              };
+              
+              const instance = await WebAssembly.instantiate(wasmModule, importObject);
+              const dispose = requestRenderThreads(this.port, wasmModule, instance, memory);
+              const exported = instance.exports.memory;
+              return { module: wasmModule, instance, memory: exported instanceof WebAssembly.Memory ? exported : memory, dispose };
+            }, sampleRate, this.bufferSize);
             
-            // Initialize the plugin
-            if (this.wasmExports.init) {
-              this.wasmExports.init(sampleRate, this.bufferSize);
-            }
+            // Functions bound to this processor's instance
+            this.wasmExports = this.pooled.exports;
+            this.wasmMemory = this.pooled.memory;
             
             // Allocate audio buffers in WASM memory
             const bytesPerSample = 4; // float32
@@ -297,7 +500,23 @@ export class PluginHost {
               this.outputPtr = this.wasmExports.malloc(bufferBytes);
             }
             
+            // Plugin-owned event buffer for sample-accurate MIDI
+            if (this.wasmExports.processWithEvents && this.wasmExports.getEventBuffer) {
+              this.eventPtr = this.wasmExports.getEventBuffer();
+              this.eventCapacity = this.wasmExports.getEventBufferCapacity
+                ? this.wasmExports.getEventBufferCapacity()
+                : 0;
+            }
+            
+            if (data.sharedBuffer && this.wasmExports.setParameter) {
+              this.shared = new SharedParameterReader(data.sharedBuffer, data.numParameters);
+            }
+            
             this.initialized = true;
+            if (this.pendingState) {
+              this.loadState(this.pendingState);
+              this.pendingState = null;
+            }
             this.port.postMessage({ type: 'initialized' });
           } catch (error) {
             this.port.postMessage({ type: 'error', error: error.message });
@@ -310,13 +529,54 @@ export class PluginHost {
               if (this.inputPtr) this.wasmExports.free(this.inputPtr);
               if (this.outputPtr) this.wasmExports.free(this.outputPtr);
             }
-            if (this.wasmExports.dispose) {
-              this.wasmExports.dispose();
-            }
           }
+          if (this.pooled) {
+            this.pooled.release();
+            this.pooled = null;
+          }
+          this.wasmExports = null;
           this.initialized = false;
         }
         
+        // time is in AudioContext seconds; events without one play at the next block start
+        queueEvent(type, data1, data2, channel, time) {
+          const frame = time !== undefined ? Math.round(time * sampleRate) : currentFrame;
+          this.pendingEvents.push({ frame, type, data1, data2, channel: channel || 0 });
+        }
+        
+        // Pack the events due in this block into the plugin's event buffer
+        writeEvents(numSamples) {
+          if (this.pendingEvents.length === 0) return 0;
+          
+          const blockEnd = currentFrame + numSamples;
+          this.pendingEvents.sort((a, b) => a.frame - b.frame);
+          
+          const view = new Int32Array(
+            this.wasmMemory.buffer,
+            this.eventPtr,
+            this.eventCapacity * ${TIMED_EVENT_INT32S}
+          );
+          
+          let count = 0;
+          while (
+            count < this.pendingEvents.length &&
+            count < this.eventCapacity &&
+            this.pendingEvents[count].frame < blockEnd
+          ) {
+            const event = this.pendingEvents[count];
+            const base = count * ${TIMED_EVENT_INT32S};
+            view[base] = Math.max(0, event.frame - currentFrame);
+            view[base + 1] = event.type;
+            view[base + 2] = event.data1;
+            view[base + 3] = event.data2;
+            view[base + 4] = event.channel;
+            count++;
+          }
+          
+          this.pendingEvents.splice(0, count);
+          return count;
+        }
+        
         process(inputs, outputs, parameters) {
           if (!this.initialized || !this.wasmExports) {
             // Pass through or silence
@@ -331,7 +591,15 @@ export class PluginHost {
           const output = outputs[0];
           const numSamples = output[0]?.length || 128;
           
+          // process() and processWithEvents() use interleaved buffers, processBlock() planar
+          const useEvents = this.eventCapacity > 0;
+          const interleaved = useEvents || !this.wasmExports.processBlock;
+          
           try {
+            if (this.shared) {
+              this.shared.apply(this.wasmExports);
+            }
+            
             // Copy input to WASM memory
             if (input && input.length > 0 && this.wasmMemory) {
               const inputView = new Float32Array(
@@ -342,13 +610,22 @@ export class PluginHost {
               
               for (let ch = 0; ch < Math.min(input.length, this.numChannels); ch++) {
                 for (let i = 0; i < numSamples; i++) {
-                  inputView[ch * numSamples + i] = input[ch][i];
+                  inputView[interleaved ? i * this.numChannels + ch : ch * numSamples + i] = input[ch][i];
                 }
               }
             }
             
             // Process audio
-            if (this.wasmExports.processBlock) {
+            if (useEvents) {
+              const numEvents = this.writeEvents(numSamples);
+              this.wasmExports.processWithEvents(
+                this.inputPtr,
+                this.outputPtr,
+                numSamples,
+                this.eventPtr,
+                numEvents
+              );
+            } else if (this.wasmExports.processBlock) {
               this.wasmExports.processBlock(
                 this.inputPtr,
                 this.outputPtr,
@@ -369,10 +646,20 @@ export class PluginHost {
               
               for (let ch = 0; ch < Math.min(output.length, this.numChannels); ch++) {
                 for (let i = 0; i < numSamples; i++) {
-                  output[ch][i] = outputView[ch * numSamples + i];
+                  output[ch][i] = outputView[interleaved ? i * this.numChannels + ch : ch * numSamples + i];
                 }
               }
             }
+            
+            if (this.shared) {
+              const exports = this.wasmExports;
+              this.shared.writePeak(${SharedMeterSlot.peakLeft}, output[0]);
+              this.shared.writePeak(${SharedMeterSlot.peakRight}, output[output.length > 1 ? 1 : 0]);
+              this.shared.writeMeter(${SharedMeterSlot.activeVoices}, exports.getActiveVoiceCount ? exports.getActiveVoiceCount() : 0);
+              this.shared.writeMeter(${SharedMeterSlot.idle}, exports.isQuiescent ? exports.isQuiescent() : 0);
+              this.shared.writeProcessStats(exports, this.wasmMemory, numSamples);
+              this.shared.publish();
+            }
           } catch (error) {
             // On error, output silence
             for (let channel = 0; channel < output.length; channel++) {
@@ -384,6 +671,12 @@ export class PluginHost {
         }
       }
       
+      ${sharedParameterReaderSource}
+      
+      ${wasmInstancePoolSource}
+      
+      ${renderThreadsSource}
+      
       registerProcessor('wasm-plugin-processor', WASMPluginProcessor);
     `;
     
@@ -433,44 +726,19 @@ export class PluginHost {
       throw new Error(`Plugin not found: ${pluginId}`);
     }
     
-    // Load WASM module
-    const wasmResponse = await fetch(manifest.wasmUrl);
-    if (!wasmResponse.ok) {
-      throw new Error(`Failed to load WASM module: ${wasmResponse.statusText}`);
-    }
-    
-    const wasmBuffer = await wasmResponse.arrayBuffer();
-    const wasmModule = await WebAssembly.compile(wasmBuffer);
-    
-    // Create shared memory for audio processing
-    const memory = new WebAssembly.Memory({
-      initial: 256,
-      maximum: 512
-    });
+    // Load WASM module; compiled once per session and streamed while downloading
+    const { module: compiledModule, hash } = await getPluginLoader().compileFromUrl(pluginWasmUrl(manifest));
+    const moduleKey = `${pluginId}@${hash}`;
     
-    // Import object for WASM instantiation
-    const importObject = {
-      env: {
-        memory,
-        abort: () => console.error('WASM abort called'),
-        consoleLog: (value: number) => console.log('WASM log:', value),
-        sin: Math.sin,
-        cos: Math.cos,
-        tan: Math.tan,
-        exp: Math.exp,
-        ln: Math.log,
-        pow: Math.pow,
-        sqrt: Math.sqrt,
-        floor: Math.floor,
-        ceil: Math.ceil,
-        round: Math.round,
-        abs: Math.abs,
-        min: Math.min,
-        max: Math.max
-      }
-    };
+    // Instances of a plugin share one module and memory when it exports create()
+    const pooledInstance = await WASMInstancePool.getInstance().acquire(
+      moduleKey,
+      () => this.instantiatePlugin(compiledModule),
+      this.audioContext.sampleRate,
+      128
+    );
     
-    const wasmInstance = await WebAssembly.instantiate(wasmModule, importObject);
+    const { module: wasmModule, instance: wasmInstance, memory } = pooledInstance;
     
     // Create AudioWorkletNode for real-time processing
     const workletNode = new AudioWorkletNode(
@@ -486,11 +754,30 @@ export class PluginHost {
       }
     );
     
-    // Send WASM buffer to worklet
+    const sharedParams = SharedParameterBlock.isSupported()
+      ? SharedParameterBlock.create(manifest.parameters.length)
+      : undefined;
+    
+    // Render threads are Web Workers, which the worklet asks this thread to start
+    workletNode.port.onmessage = (event) => {
+      if (event.data?.type === 'renderThreads') {
+        startRenderThreads(event.data.wasmModule, event.data.memory, event.data.count);
+      } else if (event.data?.type === 'state') {
+        const resolve = this.stateRequests.get(event.data.requestId);
+        this.stateRequests.delete(event.data.requestId);
+        resolve?.(event.data.data);
+      }
+    };
+    
+    // The compiled module is structured-cloneable, so the worklet skips compilation
     workletNode.port.postMessage({
       type: 'init',
-      wasmBuffer
-    }, [wasmBuffer.slice(0)]);
+      wasmModule,
+      moduleKey,
+      memoryDescriptor: pluginMemoryDescriptor(wasmModule, isThreadedModule(wasmModule)),
+      sharedBuffer: sharedParams?.sharedBuffer,
+      numParameters: manifest.parameters.length
+    });
     
     // Create instance object
     const id = instanceId || `${pluginId}-${Date.now()}`;
@@ -501,19 +788,97 @@ export class PluginHost {
       wasmInstance,
       workletNode,
       memory,
-      exports: wasmInstance.exports as WASMPluginInstance['exports']
+      pooledInstance,
+      moduleKey,
+      sharedParams,
+      exports: pooledInstance.exports as WASMPluginInstance['exports']
     };
     
-    // Initialize the plugin
-    if (instance.exports.init) {
-      instance.exports.init(this.audioContext.sampleRate, 128);
-    }
-    
     this.loadedPlugins.set(id, instance);
     
+    if (sharedParams) {
+      getPluginLoadMonitor().register(id, manifest.name, () => sharedParams.readProcessStats());
+    }
+    
     return instance;
   }
   
+  /**
+   * Instantiate a plugin module with the host's imports
+   */
+  private async instantiatePlugin(module: WebAssembly.Module): Promise<PooledModule> {
+    // Create memory at the module's declared minimum, shared for threaded builds;
+    // instances grow it by what they need when created
+    const memory = new WebAssembly.Memory(pluginMemoryDescriptor(module, isThreadedModule(module)));
+    
+    // Import object for WASM instantiation
+    const importObject = {
+      env: {
+        memory,
+        abort: () => console.error('WASM abort called'),
+        consoleLog: (value: number) => console.log('WASM log:', value),
+        sin: Math.sin,
+        cos: Math.cos,
+        tan: Math.tan,
+        exp: Math.exp,
+        ln: Math.log,
+        pow: Math.pow,
+        sqrt: Math.sqrt,
+        floor: Math.floor,
+        ceil: Math.ceil,
+        round: Math.round,
+        abs: Math.abs,
+        min: Math.min,
+        max: Math.max,
+        // Clock for getProcessStats(), in milliseconds
+        hostClock: () => performance.now()
+      }
+    };
+    
+    const instance = await WebAssembly.instantiate(module, importObject);
+    const exported = instance.exports.memory;
+    return { module, instance, memory: exported instanceof WebAssembly.Memory ? exported : memory };
+  }
+  
+  /**
+   * Render an instance offline for export, faster than realtime, by driving
+   * its processOffline() export directly in large blocks. Renders on a fresh
+   * handle with the instance's current parameters, so the live instance is
+   * not disturbed.
+   */
+  public async renderOffline(
+    instanceId: string,
+    sampleRate: number,
+    options: OfflineRenderOptions
+  ): Promise<Float32Array[]> {
+    const instance = this.loadedPlugins.get(instanceId);
+    if (!instance) {
+      throw new Error(`Plugin instance not found: ${instanceId}`);
+    }
+    
+    const offline = await WASMInstancePool.getInstance().acquire(
+      instance.moduleKey,
+      () => this.instantiatePlugin(instance.wasmModule),
+      sampleRate,
+      OFFLINE_BLOCK_SIZE
+    );
+    
+    try {
+      // Only the parameters carry over, on purpose: a snapshot would bring
+      // the live instance's playing voices, filter memory and delay history
+      // into a render that starts from silence (and the main-thread copy's
+      // voices were never even rendered)
+      const exports = offline.exports as PluginExports;
+      const count = instance.exports.getParameterCount();
+      for (let i = 0; i < count; i++) {
+        exports.setParameter(i, instance.exports.getParameter(i));
+      }
+      return await renderPluginOffline(offline, options);
+    } finally {
+      offline.release();
+    }
+  }
+  
   /**
    * Get a plugin instance by ID
    */
@@ -557,8 +922,10 @@ export class PluginHost {
       instance.exports.setParameter(paramIndex, value);
     }
     
-    // Also send to worklet
-    if (instance.workletNode) {
+    // Also send to worklet, through the shared block when there is one
+    if (instance.sharedParams) {
+      instance.sharedParams.setParameter(paramIndex, value);
+    } else if (instance.workletNode) {
       instance.workletNode.port.postMessage({
         type: 'setParameter',
         index: paramIndex,
@@ -591,10 +958,136 @@ export class PluginHost {
     return undefined;
   }
   
+  /**
+   * Upload a parameter's automation for an upcoming window, which the plugin
+   * then follows per control block without further calls.
+   * points: breakpoints in song seconds and in the parameter's range, from
+   * the last one at or before songTime (see AutomationRecorder.getSegments())
+   * songTime, contextTime: the song position and the AudioContext time it
+   * plays at
+   * Returns the song time up to which the upload covers the curve (plugins
+   * keep getAutomationCapacity() points), or undefined if the plugin does
+   * not take automation, in which case callers keep using setParameter().
+   */
+  public setAutomation(
+    instanceId: string,
+    paramId: string,
+    points: readonly AutomationPoint[],
+    songTime: number,
+    contextTime: number
+  ): number | undefined {
+    const instance = this.loadedPlugins.get(instanceId);
+    if (!instance?.workletNode || !this.audioContext) return undefined;
+    
+    const exports = instance.exports;
+    if (!exports.setAutomation || !exports.getAutomationCapacity) return undefined;
+    
+    const paramIndex = instance.manifest.parameters.findIndex(p => p.id === paramId);
+    if (paramIndex === -1) return undefined;
+    
+    const sampleRate = this.audioContext.sampleRate;
+    const count = Math.min(points.length, exports.getAutomationCapacity());
+    const packed = new ArrayBuffer(count * AUTOMATION_POINT_INT32S * 4);
+    const ints = new Int32Array(packed);
+    const floats = new Float32Array(packed);
+    
+    for (let i = 0; i < count; i++) {
+      const point = points[i];
+      const base = i * AUTOMATION_POINT_INT32S;
+      ints[base] = Math.round((point.time - songTime) * sampleRate);
+      floats[base + 1] = point.value;
+      ints[base + 2] = AutomationCurveCode[point.curve ?? 'linear'];
+      floats[base + 3] = point.tension ?? 0;
+    }
+    
+    instance.workletNode.port.postMessage({
+      type: 'setAutomation',
+      index: paramIndex,
+      points: packed,
+      startFrame: Math.round(contextTime * sampleRate)
+    }, [packed]);
+    
+    return count > 0 ? points[count - 1].time : songTime;
+  }
+  
+  /**
+   * Stop a parameter's automation; it holds its current value
+   */
+  public clearAutomation(instanceId: string, paramId: string): void {
+    const instance = this.loadedPlugins.get(instanceId);
+    const paramIndex = instance?.manifest.parameters.findIndex(p => p.id === paramId) ?? -1;
+    if (!instance?.workletNode || paramIndex === -1) return;
+    
+    instance.workletNode.port.postMessage({
+      type: 'setAutomation',
+      index: paramIndex,
+      points: new ArrayBuffer(0),
+      startFrame: 0
+    });
+  }
+  
+  /**
+   * Snapshot an instance in one call, for project saves and undo. The
+   * worklet's copy is captured, so playing voices, filter memory and delay
+   * history are included; before the worklet is ready only the parameters
+   * are. Resolves to undefined if the plugin does not export saveState(),
+   * in which case callers save getParameter() values instead.
+   */
+  public saveState(instanceId: string): Promise<Uint8Array | undefined> {
+    const instance = this.loadedPlugins.get(instanceId);
+    if (!instance) return Promise.resolve(undefined);
+    
+    const fallback = () => savePluginState(instance.exports, instance.memory);
+    if (!instance.workletNode || !instance.exports.saveState) {
+      return Promise.resolve(fallback());
+    }
+    
+    const requestId = this.nextStateRequest++;
+    const workletNode = instance.workletNode;
+    return new Promise((resolve) => {
+      this.stateRequests.set(requestId, (state) => {
+        // The instance may have been disposed while the worklet replied
+        resolve(state ?? (this.loadedPlugins.has(instanceId) ? fallback() : undefined));
+      });
+      workletNode.port.postMessage({ type: 'saveState', requestId });
+    });
+  }
+  
+  /**
+   * Restore a snapshot from saveState() in one call instead of a
+   * setParameter() per parameter. Returns false if the plugin does not
+   * export loadState() or the snapshot is not one of this plugin's.
+   */
+  public loadState(instanceId: string, state: Uint8Array): boolean {
+    const instance = this.loadedPlugins.get(instanceId);
+    if (!instance) return false;
+    
+    // The main-thread copy answers getParameter(); the worklet's renders
+    if (!loadPluginState(instance.exports, instance.memory, state)) return false;
+    instance.workletNode?.port.postMessage({ type: 'loadState', data: state });
+    
+    this.emitEvent({
+      type: 'stateChange',
+      pluginId: instance.manifest.name,
+      instanceId
+    });
+    return true;
+  }
+  
+  /**
+   * Meters written by an instance's worklet (peaks since the previous call),
+   * or undefined when the shared block is unavailable
+   */
+  public getMeters(instanceId: string): SharedMeters | undefined {
+    return this.loadedPlugins.get(instanceId)?.sharedParams?.readMeters();
+  }
+  
   /**
    * Send MIDI note on to a plugin instance
+   * time: optional AudioContext time for sample-accurate scheduling
+   * (plugins exporting processWithEvents)
    */
-  public noteOn(instanceId: string, note: number, velocity: number, channel: number = 0): void {
+  public noteOn(instanceId: string, note: number, velocity: number, channel: number = 0, time?: number): void {
     const instance = this.loadedPlugins.get(instanceId);
     if (!instance || instance.manifest.type !== 'instrument') return;
     
@@ -607,7 +1100,8 @@ export class PluginHost {
         type: 'noteOn',
         note,
         velocity,
-        channel
+        channel,
+        time
       });
     }
   }
@@ -615,7 +1109,7 @@ export class PluginHost {
   /**
    * Send MIDI note off to a plugin instance
    */
-  public noteOff(instanceId: string, note: number, channel: number = 0): void {
+  public noteOff(instanceId: string, note: number, channel: number = 0, time?: number): void {
     const instance = this.loadedPlugins.get(instanceId);
     if (!instance || instance.manifest.type !== 'instrument') return;
     
@@ -627,7 +1121,8 @@ export class PluginHost {
       instance.workletNode.port.postMessage({
         type: 'noteOff',
         note,
-        channel
+        channel,
+        time
       });
     }
   }
@@ -635,7 +1130,7 @@ export class PluginHost {
   /**
    * Send MIDI control change to a plugin instance
    */
-  public controlChange(instanceId: string, cc: number, value: number, channel: number = 0): void {
+  public controlChange(instanceId: string, cc: number, value: number, channel: number = 0, time?: number): void {
     const instance = this.loadedPlugins.get(instanceId);
     if (!instance) return;
     
@@ -648,7 +1143,29 @@ export class PluginHost {
         type: 'controlChange',
         cc,
         value,
-        channel
+        channel,
+        time
+      });
+    }
+  }
+  
+  /**
+   * Send MIDI pitch bend (0-16383, center 8192) to a plugin instance
+   */
+  public pitchBend(instanceId: string, value: number, channel: number = 0, time?: number): void {
+    const instance = this.loadedPlugins.get(instanceId);
+    if (!instance) return;
+    
+    if (instance.exports.pitchBend) {
+      instance.exports.pitchBend(value, channel);
+    }
+    
+    if (instance.workletNode) {
+      instance.workletNode.port.postMessage({
+        type: 'pitchBend',
+        value,
+        channel,
+        time
       });
     }
   }
@@ -660,10 +1177,8 @@ export class PluginHost {
     const instance = this.loadedPlugins.get(instanceId);
     if (!instance) return;
     
-    // Dispose WASM resources
-    if (instance.exports.dispose) {
-      instance.exports.dispose();
-    }
+    // Dispose WASM resources; the module goes with the plugin's last instance
+    instance.pooledInstance.release();
     
     // Disconnect and dispose worklet
     if (instance.workletNode) {
@@ -672,6 +1187,7 @@ export class PluginHost {
     }
     
     this.loadedPlugins.delete(instanceId);
+    getPluginLoadMonitor().unregister(instanceId);
     
     this.emitEvent({
       type: 'unloaded',
@@ -0,0 +1,184 @@
+// Copyright (c) 2025 Jema Technology.
+// Distributed under the license specified in the root directory of this project.
+/**
+ * PluginLoadMonitor - Per-plugin DSP load collected from the shared meter
+ * blocks
+ *
+ * Plugins built from the templates time every block and their worklets copy
+ * the results into the plugin's SharedParameterBlock (see
+ * SharedParameterBlock.readProcessStats()). The monitor polls every
+ * registered plugin while someone is subscribed, keeps a short history and
+ * can export it as a Chrome trace (chrome://tracing, Perfetto) with one
+ * counter track per plugin.
+ */
+
+import type { SharedProcessStats } from './SharedParameterBlock';
+
+/**
+ * One poll of one plugin
+ */
+export interface PluginLoadSample {
+  /** performance.now() at the poll, in milliseconds */
+  time: number;
+  load: number;
+  peakLoad: number;
+}
+
+/**
+ * Current state of one monitored plugin
+ */
+export interface PluginLoadEntry {
+  id: string;
+  name: string;
+  stats: SharedProcessStats;
+  /** Highest block load seen since registration */
+  maxLoad: number;
+  history: PluginLoadSample[];
+}
+
+export type PluginStatsReader = () => SharedProcessStats | null | undefined;
+export type PluginLoadCallback = (entries: PluginLoadEntry[]) => void;
+
+interface MonitoredPlugin {
+  entry: PluginLoadEntry;
+  read: PluginStatsReader;
+}
+
+// Poll interval while subscribed
+const POLL_INTERVAL_MS = 250;
+
+// Samples kept per plugin for the trace (two minutes at the poll interval)
+const HISTORY_LENGTH = 480;
+
+const EMPTY_STATS: SharedProcessStats = {
+  load: 0,
+  peakLoad: 0,
+  peakBlockMs: 0,
+  xrunRiskBlocks: 0,
+  parameterChanges: 0,
+  processedBlocks: 0
+};
+
+/**
+ * Per-plugin DSP load monitor
+ */
+export class PluginLoadMonitor {
+  private static instance: PluginLoadMonitor | null = null;
+  
+  private plugins: Map<string, MonitoredPlugin> = new Map();
+  private callbacks: PluginLoadCallback[] = [];
+  private timer: ReturnType<typeof setInterval> | null = null;
+  
+  private constructor() {}
+  
+  /**
+   * Get singleton instance
+   */
+  public static getInstance(): PluginLoadMonitor {
+    if (!PluginLoadMonitor.instance) {
+      PluginLoadMonitor.instance = new PluginLoadMonitor();
+    }
+    return PluginLoadMonitor.instance;
+  }
+  
+  /**
+   * Start monitoring a plugin. read is polled for the plugin's stats and may
+   * return nothing while they are unavailable.
+   */
+  public register(id: string, name: string, read: PluginStatsReader): void {
+    this.plugins.set(id, {
+      entry: { id, name, stats: { ...EMPTY_STATS }, maxLoad: 0, history: [] },
+      read
+    });
+  }
+  
+  public unregister(id: string): void {
+    this.plugins.delete(id);
+  }
+  
+  /**
+   * Current entries, in registration order
+   */
+  public getEntries(): PluginLoadEntry[] {
+    return Array.from(this.plugins.values(), plugin => plugin.entry);
+  }
+  
+  /**
+   * Receive the entries after every poll. Polling runs only while there are
+   * subscribers.
+   */
+  public subscribe(callback: PluginLoadCallback): () => void {
+    this.callbacks.push(callback);
+    if (!this.timer) {
+      this.timer = setInterval(() => this.poll(), POLL_INTERVAL_MS);
+    }
+    
+    return () => {
+      const index = this.callbacks.indexOf(callback);
+      if (index !== -1) {
+        this.callbacks.splice(index, 1);
+      }
+      if (this.callbacks.length === 0 && this.timer) {
+        clearInterval(this.timer);
+        this.timer = null;
+      }
+    };
+  }
+  
+  /**
+   * Read every plugin's stats once
+   */
+  public poll(): void {
+    const time = performance.now();
+    
+    for (const { entry, read } of this.plugins.values()) {
+      const stats = read();
+      if (!stats) continue;
+      
+      entry.stats = stats;
+      entry.maxLoad = Math.max(entry.maxLoad, stats.peakLoad);
+      entry.history.push({ time, load: stats.load, peakLoad: stats.peakLoad });
+      if (entry.history.length > HISTORY_LENGTH) {
+        entry.history.shift();
+      }
+    }
+    
+    const entries = this.getEntries();
+    for (const callback of this.callbacks) {
+      try {
+        callback(entries);
+      } catch (error) {
+        console.error('Error in plugin load callback:', error);
+      }
+    }
+  }
+  
+  /**
+   * The recorded history as Chrome trace-event JSON: a counter track per
+   * plugin with its average and peak load in percent
+   */
+  public exportTrace(): string {
+    const traceEvents: object[] = [
+      { name: 'process_name', ph: 'M', pid: 1, tid: 0, args: { name: 'Plugin DSP load' } }
+    ];
+    
+    for (const { entry } of this.plugins.values()) {
+      for (const sample of entry.history) {
+        traceEvents.push({
+          name: entry.name,
+          cat: 'dsp',
+          ph: 'C',
+          ts: Math.round(sample.time * 1000),
+          pid: 1,
+          tid: 0,
+          id: entry.id,
+          args: { load: sample.load * 100, peak: sample.peakLoad * 100 }
+        });
+      }
+    }
+    
+    return JSON.stringify({ traceEvents, displayTimeUnit: 'ms' });
+  }
+}
+
+export const getPluginLoadMonitor = (): PluginLoadMonitor => PluginLoadMonitor.getInstance();
@@ -6,6 +6,8 @@
  */
 
 import type { WAPManifest, WAPParameterDescriptor, WAPPreset } from './PluginHost';
+import { pluginWasmUrl } from './WASMRenderThreads';
+import { recordModuleMemory } from './WASMInstancePool';
 
 /**
  * Plugin source types
@@ -33,6 +35,28 @@ export interface PluginCacheEntry {
   source: PluginSource;
 }
 
+/**
+ * A compiled module and the bytes it was compiled from
+ */
+export interface CompiledWasm {
+  module: WebAssembly.Module;
+  buffer: ArrayBuffer;
+  /** Content hash the module is cached under */
+  hash: string;
+}
+
+/**
+ * A sound rendered ahead of time and cached by the content hash of what
+ * produced it (e.g. a DrumSynth patch and the renderer module)
+ */
+export interface RenderCacheEntry {
+  key: string;
+  sampleRate: number;
+  /** One array per channel */
+  channels: Float32Array[];
+  timestamp: number;
+}
+
 /**
  * Plugin validation result
  */
@@ -76,6 +100,25 @@ export interface ParameterMapping {
   curve?: 'linear' | 'logarithmic' | 'exponential';
 }
 
+/**
+ * Hex content hash of a module's (or any) bytes. SHA-256 where SubtleCrypto is
+ * available (secure contexts), otherwise 32-bit FNV-1a plus the length.
+ */
+export async function hashBytes(buffer: ArrayBuffer | Uint8Array): Promise<string> {
+  const toHex = (bytes: Uint8Array) => Array.from(bytes, b => b.toString(16).padStart(2, '0')).join('');
+  
+  if (typeof crypto !== 'undefined' && crypto.subtle) {
+    return toHex(new Uint8Array(await crypto.subtle.digest('SHA-256', buffer)));
+  }
+  
+  const bytes = buffer instanceof Uint8Array ? buffer : new Uint8Array(buffer);
+  let hash = 0x811c9dc5;
+  for (let i = 0; i < bytes.length; i++) {
+    hash = Math.imul(hash ^ bytes[i], 0x01000193);
+  }
+  return `${(hash >>> 0).toString(16).padStart(8, '0')}-${bytes.length}`;
+}
+
 /**
  * PluginLoader class - handles loading and caching of plugins
  */
@@ -83,6 +126,9 @@ export class PluginLoader {
   private static instance: PluginLoader | null = null;
   
   private cache: Map<string, PluginCacheEntry> = new Map();
+  
+  // Compiled modules for this session, keyed by content hash and shared by every instance
+  private moduleCache: Map<string, Promise<WebAssembly.Module>> = new Map();
   private sandboxConfig: PluginSandboxConfig = DEFAULT_SANDBOX_CONFIG;
   private trustedOrigins: Set<string> = new Set([
     'https://plugins.AnkhWaveStudio.io',
@@ -91,8 +137,9 @@ export class PluginLoader {
   
   // IndexedDB for persistent storage
   private dbName = 'AnkhWaveStudio-plugins';
-  private dbVersion = 1;
+  private dbVersion = 2;
   private db: IDBDatabase | null = null;
+  private dbOpening: Promise<void> | null = null;
   
   private constructor() {}
   
@@ -110,7 +157,7 @@ export class PluginLoader {
    * Initialize the plugin loader
    */
   public async initialize(): Promise<void> {
-    await this.openDatabase();
+    await this.ensureDatabase();
     await this.loadCachedManifests();
   }
   
@@ -147,6 +194,11 @@ export class PluginLoader {
           const presetStore = db.createObjectStore('presets', { keyPath: 'id' });
           presetStore.createIndex('pluginId', 'pluginId', { unique: false });
         }
+        
+        // Version 2: pre-rendered sounds
+        if (!db.objectStoreNames.contains('renders')) {
+          db.createObjectStore('renders', { keyPath: 'key' });
+        }
       };
     });
   }
@@ -219,8 +271,8 @@ export class PluginLoader {
         };
       }
       
-      // Resolve WASM URL relative to manifest
-      const wasmUrl = new URL(manifest.wasmUrl, manifestUrl).href;
+      // Resolve WASM URL (the threaded build where supported) relative to manifest
+      const wasmUrl = new URL(pluginWasmUrl(manifest), manifestUrl).href;
       
       // Fetch WASM module
       const wasmResponse = await fetch(wasmUrl);
@@ -233,10 +285,22 @@ export class PluginLoader {
         };
       }
       
-      const wasmBuffer = await wasmResponse.arrayBuffer();
+      // Compile while downloading; the module is cached for the instances created later
+      let compiled: CompiledWasm;
+      try {
+        compiled = await this.compileResponse(wasmResponse);
+      } catch (error) {
+        return {
+          success: false,
+          error: `Invalid WASM module: Failed to compile WASM module: ${error instanceof Error ? error.message : 'Unknown error'}`,
+          source: 'url',
+          loadTime: performance.now() - startTime
+        };
+      }
+      const wasmBuffer = compiled.buffer;
       
       // Validate WASM module
-      const wasmValidation = await this.validateWasmModule(wasmBuffer);
+      const wasmValidation = this.validateCompiledModule(compiled.module);
       if (!wasmValidation.valid) {
         return {
           success: false,
@@ -355,7 +419,7 @@ export class PluginLoader {
     
     // Try to load from URL
     try {
-      const response = await fetch(manifest.wasmUrl);
+      const response = await fetch(pluginWasmUrl(manifest));
       if (response.ok) {
         return await response.arrayBuffer();
       }
@@ -373,6 +437,74 @@ export class PluginLoader {
     return null;
   }
   
+  /**
+   * Compile a module, or return the module already compiled from the same
+   * bytes this session
+   */
+  public async compileModule(buffer: ArrayBuffer): Promise<WebAssembly.Module> {
+    const hash = await hashBytes(buffer);
+    
+    let module = this.moduleCache.get(hash);
+    if (!module) {
+      module = WebAssembly.compile(buffer);
+      this.cacheModule(hash, module, buffer);
+    }
+    return module;
+  }
+  
+  /**
+   * Fetch and compile a module from a URL, compiling while it downloads
+   */
+  public async compileFromUrl(url: string): Promise<CompiledWasm> {
+    const response = await fetch(url);
+    if (!response.ok) {
+      throw new Error(`Failed to fetch WASM module: ${response.statusText}`);
+    }
+    return this.compileResponse(response);
+  }
+  
+  /**
+   * Compile a fetch response with WebAssembly.compileStreaming. The bytes are
+   * read alongside for hashing and storage; if the same bytes were compiled
+   * before, that module is reused.
+   */
+  public async compileResponse(response: Response): Promise<CompiledWasm> {
+    // compileStreaming needs an application/wasm response
+    const streamable = typeof WebAssembly.compileStreaming === 'function' &&
+      (response.headers.get('Content-Type') || '').split(';')[0].trim() === 'application/wasm';
+    
+    const streaming = streamable ? WebAssembly.compileStreaming(response.clone()) : null;
+    const buffer = await response.arrayBuffer();
+    const hash = await hashBytes(buffer);
+    
+    let module = this.moduleCache.get(hash);
+    if (!module) {
+      // A rejected streaming compile (e.g. a strict MIME check) retries from the bytes
+      module = streaming
+        ? streaming.catch(() => WebAssembly.compile(buffer))
+        : WebAssembly.compile(buffer);
+      this.cacheModule(hash, module, buffer);
+    } else if (streaming) {
+      // Already compiled; drop the duplicate
+      streaming.catch(() => undefined);
+    }
+    
+    return { module: await module, buffer, hash };
+  }
+  
+  /**
+   * Remember a pending compilation, and the memory limits it declares;
+   * failed ones are not cached
+   */
+  private cacheModule(hash: string, module: Promise<WebAssembly.Module>, buffer: ArrayBuffer): void {
+    this.moduleCache.set(hash, module);
+    module.then(compiled => recordModuleMemory(compiled, buffer), () => {
+      if (this.moduleCache.get(hash) === module) {
+        this.moduleCache.delete(hash);
+      }
+    });
+  }
+  
   /**
    * Validate a plugin manifest
    */
@@ -457,42 +589,50 @@ export class PluginLoader {
    * Validate a WASM module
    */
   public async validateWasmModule(buffer: ArrayBuffer): Promise<PluginValidationResult> {
+    try {
+      // Compile through the cache so the module is reused when the plugin is instantiated
+      return this.validateCompiledModule(await this.compileModule(buffer));
+    } catch (error) {
+      return {
+        valid: false,
+        errors: [`Failed to compile WASM module: ${error instanceof Error ? error.message : 'Unknown error'}`],
+        warnings: []
+      };
+    }
+  }
+  
+  /**
+   * Check a compiled module's exports and imports
+   */
+  private validateCompiledModule(module: WebAssembly.Module): PluginValidationResult {
     const errors: string[] = [];
     const warnings: string[] = [];
     
-    try {
-      // Try to compile the module
-      const module = await WebAssembly.compile(buffer);
-      
-      // Check exports
-      const exports = WebAssembly.Module.exports(module);
-      const exportNames = exports.map(e => e.name);
-      
-      // Required exports
-      const requiredExports = ['init', 'process'];
-      for (const required of requiredExports) {
-        if (!exportNames.includes(required)) {
-          errors.push(`Missing required export: ${required}`);
-        }
-      }
-      
-      // Recommended exports
-      const recommendedExports = ['dispose', 'setParameter', 'getParameter'];
-      for (const recommended of recommendedExports) {
-        if (!exportNames.includes(recommended)) {
-          warnings.push(`Missing recommended export: ${recommended}`);
-        }
+    // Check exports
+    const exports = WebAssembly.Module.exports(module);
+    const exportNames = exports.map(e => e.name);
+    
+    // Required exports
+    const requiredExports = ['init', 'process'];
+    for (const required of requiredExports) {
+      if (!exportNames.includes(required)) {
+        errors.push(`Missing required export: ${required}`);
       }
-      
-      // Check memory requirements
-      const imports = WebAssembly.Module.imports(module);
-      const memoryImport = imports.find(i => i.kind === 'memory');
-      if (!memoryImport) {
-        warnings.push('Module does not import memory - will use default allocation');
+    }
+    
+    // Recommended exports
+    const recommendedExports = ['dispose', 'setParameter', 'getParameter'];
+    for (const recommended of recommendedExports) {
+      if (!exportNames.includes(recommended)) {
+        warnings.push(`Missing recommended export: ${recommended}`);
       }
-      
-    } catch (error) {
-      errors.push(`Failed to compile WASM module: ${error instanceof Error ? error.message : 'Unknown error'}`);
+    }
+    
+    // Check memory requirements
+    const imports = WebAssembly.Module.imports(module);
+    const memoryImport = imports.find(i => i.kind === 'memory');
+    if (!memoryImport) {
+      warnings.push('Module does not import memory - will use default allocation');
     }
     
     return {
@@ -696,6 +836,85 @@ export class PluginLoader {
     });
   }
   
+  /**
+   * Open the database on first use by callers that may run before
+   * initialize(). Without IndexedDB the render cache is simply empty.
+   */
+  private async ensureDatabase(): Promise<IDBDatabase | null> {
+    if (!this.db && typeof indexedDB !== 'undefined') {
+      if (!this.dbOpening) {
+        this.dbOpening = this.openDatabase().catch(() => {
+          this.dbOpening = null;
+        });
+      }
+      await this.dbOpening;
+    }
+    return this.db;
+  }
+  
+  /**
+   * Look up cached renders. Returns the entries found, by key; one
+   * transaction serves a whole library.
+   */
+  public async loadRenders(keys: string[]): Promise<Map<string, RenderCacheEntry>> {
+    const found = new Map<string, RenderCacheEntry>();
+    const db = await this.ensureDatabase();
+    if (!db || keys.length === 0) return found;
+    
+    return new Promise((resolve, reject) => {
+      const transaction = db.transaction(['renders'], 'readonly');
+      const store = transaction.objectStore('renders');
+      
+      for (const key of keys) {
+        const request = store.get(key);
+        request.onsuccess = () => {
+          if (request.result) found.set(key, request.result as RenderCacheEntry);
+        };
+      }
+      
+      transaction.oncomplete = () => resolve(found);
+      transaction.onerror = () => {
+        console.error('Failed to load cached renders:', transaction.error);
+        reject(transaction.error);
+      };
+    });
+  }
+  
+  /**
+   * Cache renders, replacing entries with the same keys
+   */
+  public async saveRenders(entries: RenderCacheEntry[]): Promise<void> {
+    const db = await this.ensureDatabase();
+    if (!db || entries.length === 0) return;
+    
+    return new Promise((resolve, reject) => {
+      const transaction = db.transaction(['renders'], 'readwrite');
+      const store = transaction.objectStore('renders');
+      for (const entry of entries) {
+        store.put(entry);
+      }
+      
+      transaction.oncomplete = () => resolve();
+      transaction.onerror = () => reject(transaction.error);
+    });
+  }
+  
+  /**
+   * Drop every cached render
+   */
+  public async clearRenders(): Promise<void> {
+    const db = await this.ensureDatabase();
+    if (!db) return;
+    
+    return new Promise((resolve, reject) => {
+      const transaction = db.transaction(['renders'], 'readwrite');
+      transaction.objectStore('renders').clear();
+      
+      transaction.oncomplete = () => resolve();
+      transaction.onerror = () => reject(transaction.error);
+    });
+  }
+  
   /**
    * Create parameter mappings for automation
    */
@@ -713,6 +932,7 @@ export class PluginLoader {
    */
   public dispose(): void {
     this.cache.clear();
+    this.moduleCache.clear();
     
     if (this.db) {
       this.db.close();
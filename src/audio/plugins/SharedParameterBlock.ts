@@ -0,0 +1,261 @@
+// Copyright (c) 2025 Jema Technology.
+// Distributed under the license specified in the root directory of this project.
+/**
+ * SharedParameterBlock - Lock-free parameter and meter exchange between the
+ * UI thread and a plugin worklet
+ *
+ * The UI writes parameter values into a SharedArrayBuffer and sets a dirty bit
+ * per parameter; the worklet swaps the dirty words out at the start of each
+ * block and applies only what changed. Meters flow the other way through the
+ * same buffer, so neither direction needs postMessage.
+ *
+ * Layout (32-bit words):
+ *   [0]                      meter sequence, bumped after every meter update
+ *   [1, 1 + D)               dirty bits, one per parameter (D = ceil(N / 32))
+ *   [1 + D, 1 + D + N)       parameter values (float32)
+ *   [1 + D + N, ... + M)     meters (float32)
+ */
+
+/**
+ * Meter slots written by the audio thread
+ */
+export const SharedMeterSlot = {
+  peakLeft: 0,
+  peakRight: 1,
+  activeVoices: 2,
+  idle: 3,
+  // Copied from the plugin's getProcessStats() when it has one
+  load: 4,
+  peakLoad: 5,
+  peakBlockMs: 6,
+  xrunRiskBlocks: 7,
+  parameterChanges: 8,
+  processedBlocks: 9
+} as const;
+
+export const SHARED_METER_SLOTS = 10;
+
+export interface SharedMeters {
+  peakLeft: number;
+  peakRight: number;
+  activeVoices: number;
+  idle: boolean;
+}
+
+/**
+ * DSP load of a plugin, as a share of the realtime budget (1 = a whole block)
+ */
+export interface SharedProcessStats {
+  /** Recent average load, 0 while the host skips the plugin */
+  load: number;
+  /** Highest single-block load since the previous read */
+  peakLoad: number;
+  /** Longest block so far, in milliseconds */
+  peakBlockMs: number;
+  /** Blocks that used more than half their budget */
+  xrunRiskBlocks: number;
+  parameterChanges: number;
+  processedBlocks: number;
+}
+
+/**
+ * Word offsets for a block with numParameters parameters
+ */
+function sharedLayout(numParameters: number) {
+  const dirtyWords = Math.max(1, Math.ceil(numParameters / 32));
+  const dirtyOffset = 1;
+  const valueOffset = dirtyOffset + dirtyWords;
+  const meterOffset = valueOffset + numParameters;
+  return { dirtyWords, dirtyOffset, valueOffset, meterOffset, words: meterOffset + SHARED_METER_SLOTS };
+}
+
+/**
+ * UI-side view of a shared parameter block
+ */
+export class SharedParameterBlock {
+  readonly sharedBuffer: SharedArrayBuffer;
+  readonly numParameters: number;
+  
+  private words: Int32Array;
+  private floats: Float32Array;
+  private dirtyOffset: number;
+  private valueOffset: number;
+  private meterOffset: number;
+  
+  constructor(sharedBuffer: SharedArrayBuffer, numParameters: number) {
+    const layout = sharedLayout(numParameters);
+    this.sharedBuffer = sharedBuffer;
+    this.numParameters = numParameters;
+    this.words = new Int32Array(sharedBuffer, 0, layout.words);
+    this.floats = new Float32Array(sharedBuffer, 0, layout.words);
+    this.dirtyOffset = layout.dirtyOffset;
+    this.valueOffset = layout.valueOffset;
+    this.meterOffset = layout.meterOffset;
+  }
+  
+  /**
+   * SharedArrayBuffer needs a cross-origin isolated page
+   */
+  static isSupported(): boolean {
+    return typeof SharedArrayBuffer !== 'undefined' &&
+      (typeof crossOriginIsolated === 'undefined' || crossOriginIsolated);
+  }
+  
+  /**
+   * Create a block with its own SharedArrayBuffer
+   */
+  static create(numParameters: number): SharedParameterBlock {
+    const sharedBuffer = new SharedArrayBuffer(sharedLayout(numParameters).words * 4);
+    return new SharedParameterBlock(sharedBuffer, numParameters);
+  }
+  
+  /**
+   * Publish a parameter value; the plugin picks it up at its next block
+   */
+  setParameter(index: number, value: number): void {
+    if (index < 0 || index >= this.numParameters) return;
+    
+    // The value store is ordered before the atomic dirty bit that publishes it
+    this.floats[this.valueOffset + index] = value;
+    Atomics.or(this.words, this.dirtyOffset + (index >> 5), 1 << (index & 31));
+  }
+  
+  /**
+   * Last value written for a parameter
+   */
+  getParameter(index: number): number {
+    return this.floats[this.valueOffset + index] ?? 0;
+  }
+  
+  /**
+   * Read the meters. Peaks hold the maximum since the previous call and are
+   * reset by it.
+   */
+  readMeters(): SharedMeters {
+    const base = this.meterOffset;
+    const meters = {
+      peakLeft: this.floats[base + SharedMeterSlot.peakLeft],
+      peakRight: this.floats[base + SharedMeterSlot.peakRight],
+      activeVoices: this.floats[base + SharedMeterSlot.activeVoices],
+      idle: this.floats[base + SharedMeterSlot.idle] !== 0
+    };
+    this.floats[base + SharedMeterSlot.peakLeft] = 0;
+    this.floats[base + SharedMeterSlot.peakRight] = 0;
+    return meters;
+  }
+  
+  /**
+   * Read the plugin's processing statistics, all 0 for plugins without
+   * getProcessStats(). peakLoad is reset by the call, independently of the
+   * peaks returned by readMeters().
+   */
+  readProcessStats(): SharedProcessStats {
+    const base = this.meterOffset;
+    const stats = {
+      load: this.floats[base + SharedMeterSlot.load],
+      peakLoad: this.floats[base + SharedMeterSlot.peakLoad],
+      peakBlockMs: this.floats[base + SharedMeterSlot.peakBlockMs],
+      xrunRiskBlocks: this.floats[base + SharedMeterSlot.xrunRiskBlocks],
+      parameterChanges: this.floats[base + SharedMeterSlot.parameterChanges],
+      processedBlocks: this.floats[base + SharedMeterSlot.processedBlocks]
+    };
+    this.floats[base + SharedMeterSlot.peakLoad] = 0;
+    return stats;
+  }
+  
+  /**
+   * Incremented by the audio thread each time it updates the meters
+   */
+  getMeterSequence(): number {
+    return Atomics.load(this.words, 0);
+  }
+}
+
+/**
+ * Audio-thread side of the block, inlined into worklet processor sources.
+ * Keep in sync with sharedLayout() above.
+ */
+export const sharedParameterReaderSource = `
+  class SharedParameterReader {
+    constructor(sharedBuffer, numParameters) {
+      this.dirtyWords = Math.max(1, Math.ceil(numParameters / 32));
+      this.dirtyOffset = 1;
+      this.valueOffset = this.dirtyOffset + this.dirtyWords;
+      this.meterOffset = this.valueOffset + numParameters;
+      
+      const words = this.meterOffset + ${SHARED_METER_SLOTS};
+      this.words = new Int32Array(sharedBuffer, 0, words);
+      this.floats = new Float32Array(sharedBuffer, 0, words);
+      
+      // Views over the plugin's ProcessStats, rebuilt if memory grows
+      this.statsBuffer = null;
+      this.statsPtr = 0;
+      this.statsBlocks = 0;
+    }
+    
+    // Apply the parameters changed since the last block
+    apply(exports) {
+      for (let w = 0; w < this.dirtyWords; w++) {
+        let bits = Atomics.exchange(this.words, this.dirtyOffset + w, 0);
+        while (bits !== 0) {
+          const bit = 31 - Math.clz32(bits & -bits);
+          bits &= bits - 1;
+          const index = w * 32 + bit;
+          exports.setParameter(index, this.floats[this.valueOffset + index]);
+        }
+      }
+    }
+    
+    // Raise a peak meter to the block peak of channel data
+    writePeak(slot, data) {
+      let peak = this.floats[this.meterOffset + slot];
+      for (let i = 0; i < data.length; i++) {
+        const a = data[i] < 0 ? -data[i] : data[i];
+        if (a > peak) peak = a;
+      }
+      this.floats[this.meterOffset + slot] = peak;
+    }
+    
+    writeMeter(slot, value) {
+      this.floats[this.meterOffset + slot] = value;
+    }
+    
+    // Copy the ProcessStats struct at exports.getProcessStats() (see
+    // wasm/templates/dsp/stats.h) after a block of numSamples frames
+    writeProcessStats(exports, memory, numSamples) {
+      if (!exports.getProcessStats || !memory) return;
+      const ptr = exports.getProcessStats();
+      if (!ptr) return;
+      
+      if (this.statsBuffer !== memory.buffer || this.statsPtr !== ptr) {
+        this.statsBuffer = memory.buffer;
+        this.statsPtr = ptr;
+        this.statsCounts = new Uint32Array(memory.buffer, ptr, 4);
+        this.statsTimes = new Float32Array(memory.buffer, ptr + 16, 4);
+      }
+      
+      const counts = this.statsCounts;
+      const times = this.statsTimes;
+      const base = this.meterOffset;
+      
+      // The host skipped process() if the block count did not move
+      const ran = counts[0] !== this.statsBlocks;
+      this.statsBlocks = counts[0];
+      
+      const budgetMs = numSamples * 1000 / sampleRate;
+      this.floats[base + ${SharedMeterSlot.load}] = ran ? times[2] / budgetMs : 0;
+      if (ran && times[3] > this.floats[base + ${SharedMeterSlot.peakLoad}]) {
+        this.floats[base + ${SharedMeterSlot.peakLoad}] = times[3];
+      }
+      this.floats[base + ${SharedMeterSlot.peakBlockMs}] = times[1];
+      this.floats[base + ${SharedMeterSlot.xrunRiskBlocks}] = counts[3];
+      this.floats[base + ${SharedMeterSlot.parameterChanges}] = counts[2];
+      this.floats[base + ${SharedMeterSlot.processedBlocks}] = counts[0];
+    }
+    
+    // Mark the meters as updated
+    publish() {
+      Atomics.add(this.words, 0, 1);
+    }
+  }
+`;
@@ -6,7 +6,125 @@
  */
 
 import { BaseEffect, type EffectParameterDescriptor, type EffectPreset } from '../effects/BaseEffect';
+import type { LatencySource } from '../LatencyCompensation';
 import type { WAPManifest, WAPParameterDescriptor } from './PluginHost';
+import { getPluginLoader } from './PluginLoader';
+import { getPluginLoadMonitor } from './PluginLoadMonitor';
+import {
+  SharedMeterSlot,
+  SharedParameterBlock,
+  sharedParameterReaderSource,
+  type SharedMeters
+} from './SharedParameterBlock';
+import {
+  WASMInstancePool,
+  pluginMemoryDescriptor,
+  wasmInstancePoolSource,
+  type PooledInstance,
+  type PooledModule
+} from './WASMInstancePool';
+import { OFFLINE_BLOCK_SIZE, renderPluginOffline, type OfflineRenderOptions } from './WASMOfflineRenderer';
+import { isThreadedModule, renderThreadsSource, startRenderThreads } from './WASMRenderThreads';
+
+// Smallest handle array of an EffectBatchGroup. Each member reserves memory
+// for an array this size, which covers the array doubling as the group grows.
+const BATCH_MIN_CAPACITY = 8;
+
+/**
+ * Audio-thread groups of processors whose instances share a module, inlined
+ * into the worklet processor source. Every member copies its input into its
+ * instance's I/O buffers and outputs what was processed there the quantum
+ * before; the last member to arrive processes all of them with one
+ * processBatch() call. A member that skips a quantum (idle bypass) only
+ * delays that batch to the next arrival.
+ */
+const effectBatchGroupSource = `
+  class EffectBatchGroup {
+    // Returns null if the handle array cannot grow for the processor
+    static join(key, exports, memory, processor) {
+      let group = EffectBatchGroup.groups.get(key);
+      if (!group) {
+        group = new EffectBatchGroup(key, exports, memory);
+      }
+      if (!group.add(processor)) return null;
+      EffectBatchGroup.groups.set(key, group);
+      return group;
+    }
+    
+    constructor(key, exports, memory) {
+      this.key = key;
+      this.exports = exports; // Module exports, not bound to an instance
+      this.memory = memory;
+      this.members = new Set();
+      this.pending = [];
+      this.frame = -1;
+      this.numSamples = 0;
+      this.numChannels = 0;
+      this.handlesPtr = 0;
+      this.handlesView = null;
+      this.capacity = 0;
+    }
+    
+    // Runs from message handlers, so the handle array never grows while processing
+    add(processor) {
+      if (this.members.size >= this.capacity) {
+        const capacity = Math.max(${BATCH_MIN_CAPACITY}, this.capacity * 2);
+        const handlesPtr = this.exports.malloc(capacity * 4);
+        if (!handlesPtr) return false;
+        
+        if (this.handlesPtr) this.exports.free(this.handlesPtr);
+        this.handlesPtr = handlesPtr;
+        this.capacity = capacity;
+        this.handlesView = null;
+      }
+      this.members.add(processor);
+      return true;
+    }
+    
+    leave(processor) {
+      this.members.delete(processor);
+      const index = this.pending.indexOf(processor);
+      if (index >= 0) this.pending.splice(index, 1);
+      
+      if (this.members.size === 0) {
+        this.exports.free(this.handlesPtr);
+        this.handlesPtr = 0;
+        EffectBatchGroup.groups.delete(this.key);
+      } else if (this.pending.length === this.members.size) {
+        this.flush();
+      }
+    }
+    
+    arrive(processor, frame, numSamples, numChannels) {
+      if (this.pending.length === 0) {
+        this.frame = frame;
+        this.numSamples = numSamples;
+        this.numChannels = numChannels;
+      }
+      this.numChannels = Math.min(this.numChannels, numChannels);
+      this.pending.push(processor);
+      if (this.pending.length === this.members.size) this.flush();
+    }
+    
+    // Process blocks queued for an earlier quantum that not every member joined
+    flushStale(frame) {
+      if (this.pending.length > 0 && this.frame !== frame) this.flush();
+    }
+    
+    flush() {
+      if (!this.handlesView || this.handlesView.buffer !== this.memory.buffer) {
+        this.handlesView = new Int32Array(this.memory.buffer, this.handlesPtr, this.capacity);
+      }
+      for (let i = 0; i < this.pending.length; i++) {
+        this.handlesView[i] = this.pending[i].pooled.handle;
+      }
+      this.exports.processBatch(this.handlesPtr, this.pending.length, this.numSamples, this.numChannels);
+      this.pending.length = 0;
+    }
+  }
+  
+  EffectBatchGroup.groups = new Map();
+`;
 
 /**
  * WASM Effect configuration
@@ -15,6 +133,12 @@ export interface WASMEffectConfig {
   manifest: WAPManifest;
   wasmBuffer?: ArrayBuffer;
   workletUrl?: string;
+  /**
+   * Process this instance together with the other instances of the same
+   * module on the audio thread, in one processBatch() call per render
+   * quantum, if the module exports it. Adds one render quantum of latency.
+   */
+  batchProcessing?: boolean;
 }
 
 /**
@@ -24,9 +148,385 @@ export interface WASMEffectState {
   initialized: boolean;
   processing: boolean;
   latency: number;
+  /** Plugin reported quiescence and is bypassed while its input stays silent */
+  idle: boolean;
   error?: string;
 }
 
+/**
+ * Matches SILENCE_THRESHOLD in wasm/templates/dsp/silence.h
+ */
+const SILENCE_THRESHOLD = 1e-5;
+
+/**
+ * Check whether every channel of an AudioBuffer is below the silence threshold
+ */
+function isBufferSilent(buffer: AudioBuffer): boolean {
+  for (let ch = 0; ch < buffer.numberOfChannels; ch++) {
+    const data = buffer.getChannelData(ch);
+    for (let i = 0; i < data.length; i++) {
+      if (data[i] > SILENCE_THRESHOLD || data[i] < -SILENCE_THRESHOLD) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * Worklet processor source, registered as 'wasm-effect-processor'
+ */
+export const wasmEffectProcessorSource = `
+      class WASMEffectProcessor extends AudioWorkletProcessor {
+        constructor() {
+          super();
+          this.wasmExports = null;
+          this.pooled = null;
+          this.memory = null;
+          this.inputPtr = 0;
+          this.outputPtr = 0;
+          this.bufferSize = 128;
+          this.numChannels = 2;
+          this.idle = false;
+          
+          // Persistent views over WASM memory, rebuilt if memory grows
+          this.viewsBuffer = null;
+          this.inputViews = [];
+          this.outputViews = [];
+          this.inputView = null;
+          this.outputView = null;
+          
+          // Shared parameter/meter block, if the page is cross-origin isolated
+          this.shared = null;
+          
+          // EffectBatchGroup this processor is processed in, if batched, and
+          // whether the block it queued last quantum is still to be output
+          this.batch = null;
+          this.owed = false;
+          
+          this.port.onmessage = (event) => {
+            this.handleMessage(event.data);
+          };
+        }
+        
+        handleMessage(data) {
+          if (data.type === 'init') {
+            this.initializeWASM(data);
+          } else if (data.type === 'setParameter' && this.wasmExports?.setParameter) {
+            this.wasmExports.setParameter(data.index, data.value);
+          } else if (data.type === 'setParameterRamp' && this.wasmExports?.setParameterRamp) {
+            this.wasmExports.setParameterRamp(data.index, data.value, data.durationSamples);
+          } else if (data.type === 'dispose') {
+            this.dispose();
+          }
+        }
+        
+        async initializeWASM(data) {
+          try {
+            const pooled = await wasmInstancePool.acquire(data.moduleKey, async () => {
+              // Sized by the main thread; threaded builds share it with the render threads
+              const memory = new WebAssembly.Memory(data.memoryDescriptor);
+              const importObject = {
+                env: {
+                  memory,
+                  abort: () => console.error('WASM abort'),
+                  consoleLog: (value) => console.log('WASM:', value),
+                  sin: Math.sin,
+                  cos: Math.cos,
+                  tan: Math.tan,
+                  exp: Math.exp,
+                  ln: Math.log,
+                  log10: Math.log10,
+                  pow: Math.pow,
+                  sqrt: Math.sqrt,
+                  floor: Math.floor,
+                  ceil: Math.ceil,
+                  round: Math.round,
+                  abs: Math.abs,
+                  min: Math.min,
+                  max: Math.max,
+                  tanh: Math.tanh,
+                  sinh: Math.sinh,
+                  cosh: Math.cosh,
+                  atan: Math.atan,
+                  atan2: Math.atan2,
+                  asin: Math.asin,
+                  acos: Math.acos,
+                  // Clock for getProcessStats(); AudioWorkletGlobalScope may lack performance
+                  hostClock: typeof performance !== 'undefined' ? () => performance.now() : () => Date.now()
+                }
+              };
+              
+              const instance = await WebAssembly.instantiate(data.wasmModule, importObject);
+              const dispose = requestRenderThreads(this.port, data.wasmModule, instance, memory);
+              
+              // Modules that define their own memory export it instead of importing ours
+              const exported = instance.exports.memory;
+              return { module: data.wasmModule, instance, memory: exported instanceof WebAssembly.Memory ? exported : memory, dispose };
+            }, sampleRate, this.bufferSize);
+            
+            // Functions bound to this processor's instance of the shared module
+            const exports = pooled.exports;
+            this.pooled = pooled;
+            this.memory = pooled.memory;
+            
+            // Restore the parameter values set before the worklet was ready
+            if (exports.setParameter && data.params) {
+              data.params.forEach((value, index) => exports.setParameter(index, value));
+            }
+            
+            // Without plugin-owned planar buffers, allocate host buffers
+            const planar = exports.getInputBuffer && exports.getOutputBuffer && exports.processBuffers;
+            if (!planar && exports.malloc) {
+              const bufferBytes = this.bufferSize * this.numChannels * 4;
+              pooled.reserve(bufferBytes);
+              pooled.reserve(bufferBytes);
+              this.inputPtr = exports.malloc(bufferBytes);
+              this.outputPtr = exports.malloc(bufferBytes);
+              if (!this.inputPtr || !this.outputPtr) throw new Error('Plugin buffer allocation failed');
+            }
+            
+            if (data.sharedBuffer && exports.setParameter) {
+              this.shared = new SharedParameterReader(data.sharedBuffer, data.params.length);
+            }
+            
+            this.wasmExports = exports;
+            this.createViews();
+            
+            // Batched instances output each block one render quantum later. A
+            // processor the group cannot make room for stays unbatched.
+            const moduleExports = pooled.instance.exports;
+            if (data.batch && pooled.handle && moduleExports.processBatch && exports.processBuffers && moduleExports.malloc) {
+              try {
+                pooled.reserve(${BATCH_MIN_CAPACITY * Int32Array.BYTES_PER_ELEMENT});
+                this.batch = EffectBatchGroup.join(data.moduleKey, moduleExports, pooled.memory, this);
+              } catch (error) {
+                this.batch = null;
+              }
+            }
+            
+            this.port.postMessage({
+              type: 'initialized',
+              latency: (exports.getLatency ? exports.getLatency() : 0) + (this.batch ? this.bufferSize : 0)
+            });
+          } catch (error) {
+            this.port.postMessage({ type: 'error', error: error.message });
+          }
+        }
+        
+        createViews() {
+          const exports = this.wasmExports;
+          const buffer = this.memory.buffer;
+          const frames = this.bufferSize;
+          
+          if (exports.processBuffers) {
+            this.inputViews = [];
+            this.outputViews = [];
+            for (let ch = 0; ch < this.numChannels; ch++) {
+              this.inputViews.push(new Float32Array(buffer, exports.getInputBuffer(ch), frames));
+              this.outputViews.push(new Float32Array(buffer, exports.getOutputBuffer(ch), frames));
+            }
+          } else if (this.inputPtr && this.outputPtr) {
+            this.inputView = new Float32Array(buffer, this.inputPtr, frames * this.numChannels);
+            this.outputView = new Float32Array(buffer, this.outputPtr, frames * this.numChannels);
+          }
+          
+          this.viewsBuffer = buffer;
+        }
+        
+        dispose() {
+          if (this.batch) {
+            this.batch.leave(this);
+            this.batch = null;
+            this.owed = false;
+          }
+          const exports = this.wasmExports;
+          if (exports) {
+            if (exports.free) {
+              if (this.inputPtr) exports.free(this.inputPtr);
+              if (this.outputPtr) exports.free(this.outputPtr);
+            }
+          }
+          if (this.pooled) {
+            this.pooled.release();
+          }
+          this.wasmExports = null;
+          this.pooled = null;
+          this.inputPtr = 0;
+          this.outputPtr = 0;
+          this.inputViews = [];
+          this.outputViews = [];
+          this.inputView = null;
+          this.outputView = null;
+        }
+        
+        isSilent(channels) {
+          for (let ch = 0; ch < channels.length; ch++) {
+            const data = channels[ch];
+            for (let i = 0; i < data.length; i++) {
+              if (data[i] > ${SILENCE_THRESHOLD} || data[i] < -${SILENCE_THRESHOLD}) return false;
+            }
+          }
+          return true;
+        }
+        
+        setIdle(idle) {
+          if (idle !== this.idle) {
+            this.idle = idle;
+            this.port.postMessage({ type: 'idle', idle });
+          }
+        }
+        
+        process(inputs, outputs, parameters) {
+          const input = inputs[0];
+          const output = outputs[0];
+          
+          if (!output || output.length === 0) {
+            return true;
+          }
+          
+          // If WASM not loaded, pass through
+          const exports = this.wasmExports;
+          if (!exports) {
+            for (let ch = 0; ch < output.length; ch++) {
+              if (input && input[ch]) {
+                output[ch].set(input[ch]);
+              }
+            }
+            return true;
+          }
+          
+          const numSamples = output[0].length;
+          const numChannels = Math.min(this.numChannels, output.length);
+          
+          // Blocks the group queued in an earlier quantum are due before anything is
+          // output. Only then does quiescence cover the block this member queued.
+          if (this.batch) {
+            this.batch.flushStale(currentFrame);
+            this.setIdle(exports.isQuiescent ? exports.isQuiescent() !== 0 : false);
+          }
+          
+          // Bypass a quiescent plugin for as long as its input stays silent, once
+          // a batched one has output the block it still owes
+          const bypass = this.idle && (!input || input.length === 0 || this.isSilent(input));
+          if (bypass && !this.owed) {
+            for (let ch = 0; ch < output.length; ch++) {
+              output[ch].fill(0);
+            }
+            if (this.shared) {
+              // Report the skipped block as no load
+              this.shared.writeProcessStats(exports, this.memory, numSamples);
+              this.shared.publish();
+            }
+            return true;
+          }
+          
+          if (this.shared) {
+            this.shared.apply(exports);
+          }
+          
+          if (this.viewsBuffer !== this.memory.buffer) {
+            this.createViews();
+          }
+          
+          if (this.batch) {
+            // Output the block the group processed last quantum, then queue this
+            // one unless the plugin is bypassed
+            for (let ch = 0; ch < numChannels; ch++) {
+              if (this.owed) {
+                output[ch].set(this.outputViews[ch].subarray(0, numSamples));
+              } else {
+                output[ch].fill(0);
+              }
+            }
+            this.owed = !bypass;
+            if (!bypass) {
+              for (let ch = 0; ch < numChannels; ch++) {
+                if (input && input[ch]) {
+                  this.inputViews[ch].set(input[ch]);
+                } else {
+                  this.inputViews[ch].fill(0);
+                }
+              }
+              this.batch.arrive(this, currentFrame, numSamples, numChannels);
+            }
+          } else if (exports.processBuffers) {
+            // Plugin-owned planar buffers, processed in place
+            for (let ch = 0; ch < numChannels; ch++) {
+              if (input && input[ch]) {
+                this.inputViews[ch].set(input[ch]);
+              } else {
+                this.inputViews[ch].fill(0);
+              }
+            }
+            
+            exports.processBuffers(numSamples, numChannels);
+            
+            for (let ch = 0; ch < numChannels; ch++) {
+              output[ch].set(this.outputViews[ch].subarray(0, numSamples));
+            }
+          } else if (this.inputView) {
+            // processBlock() is planar, process() interleaved
+            const planar = !!exports.processBlock;
+            
+            for (let ch = 0; ch < numChannels; ch++) {
+              const channel = input && input[ch];
+              if (planar) {
+                if (channel) {
+                  this.inputView.set(channel, ch * numSamples);
+                } else {
+                  this.inputView.fill(0, ch * numSamples, (ch + 1) * numSamples);
+                }
+              } else {
+                for (let i = 0; i < numSamples; i++) {
+                  this.inputView[i * numChannels + ch] = channel ? channel[i] : 0;
+                }
+              }
+            }
+            
+            if (planar) {
+              exports.processBlock(this.inputPtr, this.outputPtr, numSamples, numChannels);
+            } else if (exports.process) {
+              exports.process(this.inputPtr, this.outputPtr, numSamples);
+            }
+            
+            for (let ch = 0; ch < numChannels; ch++) {
+              if (planar) {
+                output[ch].set(this.outputView.subarray(ch * numSamples, (ch + 1) * numSamples));
+              } else {
+                for (let i = 0; i < numSamples; i++) {
+                  output[ch][i] = this.outputView[i * numChannels + ch];
+                }
+              }
+            }
+          }
+          
+          if (!this.batch) {
+            this.setIdle(exports.isQuiescent ? exports.isQuiescent() !== 0 : false);
+          }
+          
+          if (this.shared) {
+            this.shared.writePeak(${SharedMeterSlot.peakLeft}, output[0]);
+            this.shared.writePeak(${SharedMeterSlot.peakRight}, output[output.length > 1 ? 1 : 0]);
+            this.shared.writeMeter(${SharedMeterSlot.idle}, this.idle ? 1 : 0);
+            this.shared.writeProcessStats(exports, this.memory, numSamples);
+            this.shared.publish();
+          }
+          return true;
+        }
+      }
+      
+      ${effectBatchGroupSource}
+      
+      ${sharedParameterReaderSource}
+      
+      ${wasmInstancePoolSource}
+      
+      ${renderThreadsSource}
+      
+      registerProcessor('wasm-effect-processor', WASMEffectProcessor);
+    `;
+
 /**
  * WASMEffectPlugin - Base class for WASM-based effects
  * Compatible with existing effect chain, hot-swappable
@@ -36,18 +536,34 @@ export class WASMEffectPlugin extends BaseEffect {
   protected wasmModule: WebAssembly.Module | null = null;
   protected wasmInstance: WebAssembly.Instance | null = null;
   protected wasmMemory: WebAssembly.Memory | null = null;
+  protected wasmExports: WebAssembly.Exports | null = null;
   protected workletNode: AudioWorkletNode | null = null;
+  protected scriptNode: ScriptProcessorNode | null = null;
+  
+  // This plugin's instance in the module shared with other instances of the same plugin
+  private pooledInstance: PooledInstance | null = null;
+  private moduleKey: string = '';
+  private batchProcessing: boolean;
+  
+  // Lock-free parameter/meter exchange with the worklet (cross-origin isolated pages only)
+  protected sharedParams: SharedParameterBlock | null = null;
   
   // Buffer pointers in WASM memory
   protected inputPtr: number = 0;
   protected outputPtr: number = 0;
   protected bufferSize: number = 128;
   
+  // Views onto plugin-owned planar buffers (getInputBuffer/getOutputBuffer ABI)
+  protected inputViews: Float32Array[] = [];
+  protected outputViews: Float32Array[] = [];
+  private viewsBuffer: ArrayBuffer | null = null;
+  
   // State
   protected wasmState: WASMEffectState = {
     initialized: false,
     processing: false,
-    latency: 0
+    latency: 0,
+    idle: false
   };
   
   // Worklet processor URL
@@ -61,6 +577,7 @@ export class WASMEffectPlugin extends BaseEffect {
   ) {
     super(audioContext, id, config.manifest.name, 'wasm-effect');
     this.manifest = config.manifest;
+    this.batchProcessing = config.batchProcessing ?? false;
     
     // Initialize parameters from manifest
     this.initializeFromManifest();
@@ -95,64 +612,43 @@ export class WASMEffectPlugin extends BaseEffect {
    */
   public async loadWasm(buffer: ArrayBuffer): Promise<void> {
     try {
-      // Compile WASM module
-      this.wasmModule = await WebAssembly.compile(buffer);
+      // Compile WASM module, reusing the session's compilation of the same bytes
+      this.wasmModule = await getPluginLoader().compileModule(buffer);
+      this.moduleKey = WASMInstancePool.moduleKey(this.wasmModule);
       
-      // Create memory
-      this.wasmMemory = new WebAssembly.Memory({
-        initial: 256,
-        maximum: 512
-      });
-      
-      // Import object
-      const importObject = {
-        env: {
-          memory: this.wasmMemory,
-          abort: () => console.error('WASM abort'),
-          consoleLog: (value: number) => console.log('WASM:', value),
-          sin: Math.sin,
-          cos: Math.cos,
-          tan: Math.tan,
-          exp: Math.exp,
-          ln: Math.log,
-          log10: Math.log10,
-          pow: Math.pow,
-          sqrt: Math.sqrt,
-          floor: Math.floor,
-          ceil: Math.ceil,
-          round: Math.round,
-          abs: Math.abs,
-          min: Math.min,
-          max: Math.max,
-          tanh: Math.tanh,
-          sinh: Math.sinh,
-          cosh: Math.cosh,
-          atan: Math.atan,
-          atan2: Math.atan2,
-          asin: Math.asin,
-          acos: Math.acos
-        }
-      };
+      // A threaded build cannot get its shared memory here; the manifest's wasmUrl
+      // build is the single-threaded fallback (see pluginWasmUrl())
+      if (isThreadedModule(this.wasmModule) && !SharedParameterBlock.isSupported()) {
+        throw new Error('Threaded plugin build requires a cross-origin isolated page');
+      }
       
-      // Instantiate
-      this.wasmInstance = await WebAssembly.instantiate(this.wasmModule, importObject);
+      // Instantiate, or add an instance to a module another plugin already instantiated
+      const module = this.wasmModule;
+      this.pooledInstance = await WASMInstancePool.getInstance().acquire(
+        this.moduleKey,
+        () => this.instantiateModule(module),
+        this.audioContext.sampleRate,
+        this.bufferSize
+      );
+      this.wasmInstance = this.pooledInstance.instance;
+      this.wasmMemory = this.pooledInstance.memory;
+      this.wasmExports = this.pooledInstance.exports;
       
-      // Initialize
-      const exports = this.wasmInstance.exports as {
-        init?: (sampleRate: number, bufferSize: number) => void;
+      const exports = this.wasmExports as {
         malloc?: (size: number) => number;
         getLatency?: () => number;
       };
       
-      if (exports.init) {
-        exports.init(this.audioContext.sampleRate, this.bufferSize);
-      }
-      
-      // Allocate buffers
-      if (exports.malloc) {
+      // Prefer plugin-owned planar buffers; otherwise allocate host buffers
+      if (!this.createPlanarViews() && exports.malloc) {
         const bufferBytes = this.bufferSize * 2 * 4; // stereo, float32
+        this.pooledInstance.reserve(bufferBytes);
+        this.pooledInstance.reserve(bufferBytes);
         this.inputPtr = exports.malloc(bufferBytes);
         this.outputPtr = exports.malloc(bufferBytes);
+        if (!this.inputPtr || !this.outputPtr) {
+          throw new Error('Plugin buffer allocation failed');
+        }
       }
       
       // Get latency
@@ -172,33 +668,104 @@ export class WASMEffectPlugin extends BaseEffect {
     }
   }
   
+  /**
+   * Instantiate a compiled module with the host imports
+   */
+  private async instantiateModule(module: WebAssembly.Module): Promise<PooledModule> {
+    // Threaded builds need shared memory, so only load on cross-origin isolated pages
+    const memory = new WebAssembly.Memory(pluginMemoryDescriptor(module, isThreadedModule(module)));
+    
+    // Import object
+    const importObject = {
+      env: {
+        memory,
+        abort: () => console.error('WASM abort'),
+        consoleLog: (value: number) => console.log('WASM:', value),
+        sin: Math.sin,
+        cos: Math.cos,
+        tan: Math.tan,
+        exp: Math.exp,
+        ln: Math.log,
+        log10: Math.log10,
+        pow: Math.pow,
+        sqrt: Math.sqrt,
+        floor: Math.floor,
+        ceil: Math.ceil,
+        round: Math.round,
+        abs: Math.abs,
+        min: Math.min,
+        max: Math.max,
+        tanh: Math.tanh,
+        sinh: Math.sinh,
+        cosh: Math.cosh,
+        atan: Math.atan,
+        atan2: Math.atan2,
+        asin: Math.asin,
+        acos: Math.acos,
+        // Clock for getProcessStats(), in milliseconds
+        hostClock: () => performance.now()
+      }
+    };
+    
+    const instance = await WebAssembly.instantiate(module, importObject);
+    
+    // Modules that define their own memory export it instead of importing ours
+    const exported = instance.exports.memory;
+    return { module, instance, memory: exported instanceof WebAssembly.Memory ? exported : memory };
+  }
+  
   /**
    * Set up audio processing using AudioWorklet
    */
   private async setupAudioProcessing(): Promise<void> {
-    // Register worklet if not already done
-    if (!WASMEffectPlugin.workletRegistered) {
-      await this.registerWorklet();
-    }
+    if (!this.wasmModule) return;
     
-    // Create worklet node
-    this.workletNode = new AudioWorkletNode(
-      this.audioContext,
-      'wasm-effect-processor',
-      {
-        numberOfInputs: 1,
-        numberOfOutputs: 1,
-        outputChannelCount: [2]
+    try {
+      // Register worklet if not already done
+      if (!WASMEffectPlugin.workletRegistered) {
+        await this.registerWorklet();
       }
-    );
-    
-    // Send WASM module to worklet
-    if (this.wasmModule) {
-      // We need to send the compiled module or buffer
-      // For now, we'll use ScriptProcessorNode as fallback
+      
+      // Create worklet node
+      this.workletNode = new AudioWorkletNode(
+        this.audioContext,
+        'wasm-effect-processor',
+        {
+          numberOfInputs: 1,
+          numberOfOutputs: 1,
+          outputChannelCount: [2]
+        }
+      );
+    } catch (error) {
+      // No AudioWorklet support: run on the main thread instead
+      console.warn('AudioWorklet unavailable, using ScriptProcessorNode:', error);
+      this.workletNode = null;
       this.setupScriptProcessor();
+      this.wasmState.processing = true;
+      return;
+    }
+    
+    this.workletNode.port.onmessage = (event) => {
+      this.handleWorkletMessage(event.data);
+    };
+    
+    if (SharedParameterBlock.isSupported()) {
+      this.sharedParams = SharedParameterBlock.create(this.manifest.parameters.length);
+      getPluginLoadMonitor().register(this.id, this.name, () => this.sharedParams?.readProcessStats());
     }
     
+    // The compiled module is structured-cloneable; the worklet instantiates its own
+    // copy, shared by all worklet instances of the same module
+    this.workletNode.port.postMessage({
+      type: 'init',
+      wasmModule: this.wasmModule,
+      moduleKey: this.moduleKey,
+      memoryDescriptor: pluginMemoryDescriptor(this.wasmModule, isThreadedModule(this.wasmModule)),
+      params: this.manifest.parameters.map(p => this.params[p.id] ?? p.default),
+      sharedBuffer: this.sharedParams?.sharedBuffer,
+      batch: this.batchProcessing
+    });
+    
     // Connect to effect chain
     this.inputNode.connect(this.workletNode);
     this.workletNode.connect(this.wetGain);
@@ -207,74 +774,77 @@ export class WASMEffectPlugin extends BaseEffect {
     this.wasmState.processing = true;
   }
   
+  /**
+   * Handle status messages from the worklet processor
+   */
+  private handleWorkletMessage(data: { type: string; [key: string]: unknown }): void {
+    switch (data.type) {
+      case 'initialized':
+        this.wasmState.latency = (data.latency as number) ?? this.wasmState.latency;
+        break;
+      case 'idle':
+        this.wasmState.idle = data.idle as boolean;
+        break;
+      case 'renderThreads':
+        // Web Workers can only be started here, not in the worklet
+        startRenderThreads(data.wasmModule as WebAssembly.Module, data.memory as WebAssembly.Memory, data.count as number);
+        break;
+      case 'error':
+        this.wasmState.error = data.error as string;
+        console.error('WASM effect worklet error:', data.error);
+        break;
+    }
+  }
+  
   /**
    * Register the AudioWorklet processor
    */
   private async registerWorklet(): Promise<void> {
-    const processorCode = `
-      class WASMEffectProcessor extends AudioWorkletProcessor {
-        constructor() {
-          super();
-          this.wasmExports = null;
-          this.inputPtr = 0;
-          this.outputPtr = 0;
-          this.memory = null;
-          
-          this.port.onmessage = (event) => {
-            this.handleMessage(event.data);
-          };
-        }
-        
-        handleMessage(data) {
-          if (data.type === 'setParameter' && this.wasmExports?.setParameter) {
-            this.wasmExports.setParameter(data.index, data.value);
-          }
-        }
-        
-        process(inputs, outputs, parameters) {
-          const input = inputs[0];
-          const output = outputs[0];
-          
-          if (!input || !output || input.length === 0) {
-            return true;
-          }
-          
-          // If WASM not loaded, pass through
-          if (!this.wasmExports) {
-            for (let ch = 0; ch < output.length; ch++) {
-              if (input[ch]) {
-                output[ch].set(input[ch]);
-              }
-            }
-            return true;
-          }
-          
-          // Process with WASM
-          // ... WASM processing code ...
-          
-          return true;
-        }
-      }
-      
-      registerProcessor('wasm-effect-processor', WASMEffectProcessor);
-    `;
-    
-    const blob = new Blob([processorCode], { type: 'application/javascript' });
+    const blob = new Blob([wasmEffectProcessorSource], { type: 'application/javascript' });
     WASMEffectPlugin.workletUrl = URL.createObjectURL(blob);
     
     await this.audioContext.audioWorklet.addModule(WASMEffectPlugin.workletUrl);
     WASMEffectPlugin.workletRegistered = true;
   }
   
+  /**
+   * Map the plugin's planar I/O buffers, if it exports them. Views are
+   * recreated whenever WASM memory grows and detaches the old buffer.
+   */
+  private createPlanarViews(): boolean {
+    if (!this.wasmExports || !this.wasmMemory) return false;
+    
+    const exports = this.wasmExports as {
+      getInputBuffer?: (channel: number) => number;
+      getOutputBuffer?: (channel: number) => number;
+      processBuffers?: (numSamples: number, numChannels: number) => void;
+    };
+    
+    if (!exports.getInputBuffer || !exports.getOutputBuffer || !exports.processBuffers) {
+      return false;
+    }
+    
+    const buffer = this.wasmMemory.buffer;
+    this.inputViews = [];
+    this.outputViews = [];
+    for (let ch = 0; ch < 2; ch++) {
+      this.inputViews.push(new Float32Array(buffer, exports.getInputBuffer(ch), this.bufferSize));
+      this.outputViews.push(new Float32Array(buffer, exports.getOutputBuffer(ch), this.bufferSize));
+    }
+    this.viewsBuffer = buffer;
+    return true;
+  }
+  
   /**
    * Fallback to ScriptProcessorNode for browsers without AudioWorklet
    */
   private setupScriptProcessor(): void {
     // ScriptProcessorNode is deprecated but provides fallback
     const scriptNode = this.audioContext.createScriptProcessor(this.bufferSize, 2, 2);
+    this.scriptNode = scriptNode;
     
     scriptNode.onaudioprocess = (event) => {
-      if (!this.wasmInstance || !this.wasmMemory) {
+      if (!this.wasmExports || !this.wasmMemory) {
         // Pass through
         for (let ch = 0; ch < event.outputBuffer.numberOfChannels; ch++) {
           const input = event.inputBuffer.getChannelData(ch);
@@ -284,14 +854,43 @@ export class WASMEffectPlugin extends BaseEffect {
         return;
       }
       
-      const exports = this.wasmInstance.exports as {
+      const exports = this.wasmExports as {
         process?: (inputPtr: number, outputPtr: number, numSamples: number) => void;
         processBlock?: (inputPtr: number, outputPtr: number, numSamples: number, numChannels: number) => void;
+        processBuffers?: (numSamples: number, numChannels: number) => void;
+        isQuiescent?: () => number;
       };
       
+      // Bypass a quiescent plugin for as long as its input stays silent
+      if (this.wasmState.idle && isBufferSilent(event.inputBuffer)) {
+        for (let ch = 0; ch < event.outputBuffer.numberOfChannels; ch++) {
+          event.outputBuffer.getChannelData(ch).fill(0);
+        }
+        return;
+      }
+      
       const numSamples = event.inputBuffer.length;
       const numChannels = Math.min(event.inputBuffer.numberOfChannels, 2);
       
+      // Plugin-owned planar buffers: one copy in and out per channel, processed in place
+      if (exports.processBuffers && this.inputViews.length > 0 && numSamples <= this.bufferSize) {
+        if (this.viewsBuffer !== this.wasmMemory.buffer) {
+          this.createPlanarViews();
+        }
+        
+        for (let ch = 0; ch < numChannels; ch++) {
+          this.inputViews[ch].set(event.inputBuffer.getChannelData(ch));
+        }
+        
+        exports.processBuffers(numSamples, numChannels);
+        this.wasmState.idle = exports.isQuiescent ? exports.isQuiescent() !== 0 : false;
+        
+        for (let ch = 0; ch < numChannels; ch++) {
+          event.outputBuffer.getChannelData(ch).set(this.outputViews[ch].subarray(0, numSamples));
+        }
+        return;
+      }
+      
       // Copy input to WASM memory
       const inputView = new Float32Array(
         this.wasmMemory.buffer,
@@ -300,10 +899,7 @@ export class WASMEffectPlugin extends BaseEffect {
       );
       
       for (let ch = 0; ch < numChannels; ch++) {
-        const channelData = event.inputBuffer.getChannelData(ch);
-        for (let i = 0; i < numSamples; i++) {
-          inputView[ch * numSamples + i] = channelData[i];
-        }
+        inputView.set(event.inputBuffer.getChannelData(ch), ch * numSamples);
       }
       
       // Process
@@ -313,6 +909,8 @@ export class WASMEffectPlugin extends BaseEffect {
         exports.process(this.inputPtr, this.outputPtr, numSamples);
       }
       
+      this.wasmState.idle = exports.isQuiescent ? exports.isQuiescent() !== 0 : false;
+      
       // Copy output from WASM memory
       const outputView = new Float32Array(
         this.wasmMemory.buffer,
@@ -321,10 +919,9 @@ export class WASMEffectPlugin extends BaseEffect {
       );
       
       for (let ch = 0; ch < numChannels; ch++) {
-        const channelData = event.outputBuffer.getChannelData(ch);
-        for (let i = 0; i < numSamples; i++) {
-          channelData[i] = outputView[ch * numSamples + i];
-        }
+        event.outputBuffer.getChannelData(ch).set(
+          outputView.subarray(ch * numSamples, (ch + 1) * numSamples)
+        );
       }
     };
     
@@ -354,12 +951,12 @@ export class WASMEffectPlugin extends BaseEffect {
    * Handle parameter change
    */
   protected onParameterChange(key: string, value: number): void {
-    if (!this.wasmInstance) return;
+    if (!this.wasmExports) return;
     
     const paramIndex = this.manifest.parameters.findIndex(p => p.id === key);
     if (paramIndex === -1) return;
     
-    const exports = this.wasmInstance.exports as {
+    const exports = this.wasmExports as {
       setParameter?: (index: number, value: number) => void;
     };
     
@@ -367,8 +964,10 @@ export class WASMEffectPlugin extends BaseEffect {
       exports.setParameter(paramIndex, value);
     }
     
-    // Also send to worklet
-    if (this.workletNode) {
+    // Also send to worklet, through the shared block when there is one
+    if (this.sharedParams) {
+      this.sharedParams.setParameter(paramIndex, value);
+    } else if (this.workletNode) {
       this.workletNode.port.postMessage({
         type: 'setParameter',
         index: paramIndex,
@@ -377,6 +976,81 @@ export class WASMEffectPlugin extends BaseEffect {
     }
   }
   
+  /**
+   * Meters written by the worklet (peaks since the previous call), or null
+   * when the shared block is unavailable
+   */
+  public getMeters(): SharedMeters | null {
+    return this.sharedParams ? this.sharedParams.readMeters() : null;
+  }
+  
+  /**
+   * Ramp a parameter to a value over a duration, interpolated inside the
+   * plugin. Falls back to an immediate set if the plugin has no ramp export.
+   */
+  public rampParameter(key: string, value: number, durationSeconds: number): void {
+    if (!this.wasmExports) return;
+    
+    const paramIndex = this.manifest.parameters.findIndex(p => p.id === key);
+    if (paramIndex === -1) return;
+    
+    const exports = this.wasmExports as {
+      setParameterRamp?: (index: number, target: number, durationSamples: number) => void;
+    };
+    
+    if (!exports.setParameterRamp) {
+      this.setParameter(key, value);
+      return;
+    }
+    
+    const durationSamples = Math.round(durationSeconds * this.audioContext.sampleRate);
+    exports.setParameterRamp(paramIndex, value, durationSamples);
+    this.params[key] = value;
+    
+    if (this.workletNode) {
+      this.workletNode.port.postMessage({
+        type: 'setParameterRamp',
+        index: paramIndex,
+        value,
+        durationSamples
+      });
+    }
+  }
+  
+  /**
+   * Process a rendered track through this effect for export, faster than
+   * realtime, via the plugin's processOffline() export. Runs on a fresh
+   * instance with the current parameters, so live processing is not disturbed.
+   */
+  public async renderOffline(
+    input: Float32Array[],
+    sampleRate: number,
+    options: Omit<OfflineRenderOptions, 'input' | 'events'> = { length: input[0]?.length ?? 0 }
+  ): Promise<Float32Array[]> {
+    if (!this.wasmModule || !this.wasmExports) {
+      throw new Error('WASM effect not loaded');
+    }
+    
+    const module = this.wasmModule;
+    const offline = await WASMInstancePool.getInstance().acquire(
+      this.moduleKey,
+      () => this.instantiateModule(module),
+      sampleRate,
+      OFFLINE_BLOCK_SIZE
+    );
+    
+    try {
+      const live = this.wasmExports as { getParameter: (index: number) => number };
+      const exports = offline.exports as { setParameter: (index: number, value: number) => void };
+      this.manifest.parameters.forEach((_, index) => {
+        exports.setParameter(index, live.getParameter(index));
+      });
+      return await renderPluginOffline(offline, { ...options, input });
+    } finally {
+      offline.release();
+    }
+  }
+  
   /**
    * Initialize effect
    */
@@ -391,6 +1065,22 @@ export class WASMEffectPlugin extends BaseEffect {
     return { ...this.wasmState };
   }
   
+  /**
+   * Latency reported by the plugin's getLatency(), for registering with
+   * LatencyCompensation
+   */
+  public getLatencySource(): LatencySource {
+    const latencySamples = this.wasmState.latency;
+    return {
+      id: this.id,
+      name: this.name,
+      type: 'plugin',
+      latencySamples,
+      latencyMs: (latencySamples / this.audioContext.sampleRate) * 1000,
+      compensated: false
+    };
+  }
+  
   /**
    * Get manifest
    */
@@ -421,9 +1111,8 @@ export class WASMEffectPlugin extends BaseEffect {
    * Dispose WASM resources
    */
   private disposeWasm(): void {
-    if (this.wasmInstance) {
-      const exports = this.wasmInstance.exports as {
-        dispose?: () => void;
+    if (this.wasmExports) {
+      const exports = this.wasmExports as {
         free?: (ptr: number) => void;
       };
       
@@ -431,19 +1120,44 @@ export class WASMEffectPlugin extends BaseEffect {
         if (this.inputPtr) exports.free(this.inputPtr);
         if (this.outputPtr) exports.free(this.outputPtr);
       }
-      
-      if (exports.dispose) {
-        exports.dispose();
-      }
+    }
+    
+    // Destroys this plugin's instance; the module goes with its last instance
+    if (this.pooledInstance) {
+      this.pooledInstance.release();
+      this.pooledInstance = null;
+    }
+    
+    // Tear down the audio-thread instance and its node
+    getPluginLoadMonitor().unregister(this.id);
+    if (this.workletNode) {
+      this.workletNode.port.postMessage({ type: 'dispose' });
+      this.workletNode.port.onmessage = null;
+      this.inputNode.disconnect(this.workletNode);
+      this.workletNode.disconnect();
+      this.workletNode = null;
+    }
+    if (this.scriptNode) {
+      this.scriptNode.onaudioprocess = null;
+      this.inputNode.disconnect(this.scriptNode);
+      this.scriptNode.disconnect();
+      this.scriptNode = null;
     }
     
     this.wasmInstance = null;
+    this.wasmExports = null;
     this.wasmModule = null;
     this.wasmMemory = null;
+    this.moduleKey = '';
     this.inputPtr = 0;
     this.outputPtr = 0;
+    this.inputViews = [];
+    this.outputViews = [];
+    this.viewsBuffer = null;
+    this.sharedParams = null;
     this.wasmState.initialized = false;
     this.wasmState.processing = false;
+    this.wasmState.idle = false;
   }
   
   /**
@@ -451,12 +1165,6 @@ export class WASMEffectPlugin extends BaseEffect {
    */
   dispose(): void {
     this.disposeWasm();
-    
-    if (this.workletNode) {
-      this.workletNode.disconnect();
-      this.workletNode = null;
-    }
-    
     super.dispose();
   }
 }
@@ -0,0 +1,502 @@
+// Copyright (c) 2025 Jema Technology.
+// Distributed under the license specified in the root directory of this project.
+/**
+ * WASMInstancePool - One instantiated WASM module per plugin type, shared by
+ * every instance of that plugin
+ *
+ * Plugins built from the templates export create()/destroy() and an
+ * instance*() variant of each per-instance function taking the handle from
+ * create() as its first argument. For those, the pool instantiates the module
+ * and its memory once per key and gives each plugin instance its own handle,
+ * wrapped so callers keep using the handle-less names (process,
+ * setParameter, ...). Modules without create() get a private instantiation
+ * each, as before.
+ *
+ * Memory starts at the module's own declared minimum (see
+ * recordModuleMemory). Each module keeps a budget of the bytes its live
+ * instances take by getRequiredMemory(); memory grows right before a
+ * create() only when that budget exceeds what it has already grown by, so
+ * instances never grow it while audio runs and freed instances leave room
+ * for the next ones.
+ */
+
+/**
+ * An instantiated module
+ */
+export interface PooledModule {
+  module: WebAssembly.Module;
+  instance: WebAssembly.Instance;
+  memory: WebAssembly.Memory;
+  /** Called when the module's last instance is released */
+  dispose?: () => void;
+}
+
+/**
+ * One plugin instance acquired from the pool
+ */
+export interface PooledInstance extends PooledModule {
+  /** Plugin functions, bound to this instance */
+  exports: WebAssembly.Exports;
+  /** Handle returned by create(), or 0 for a single-instance module */
+  handle: number;
+  /**
+   * Add one malloc(bytes) the caller makes for this instance to the module's
+   * memory budget, growing memory first if needed. No-op for modules without
+   * getRequiredMemory(). Returned to the budget on release().
+   */
+  reserve(bytes: number): void;
+  /** Destroy the instance; the module is dropped with its last instance */
+  release(): void;
+}
+
+/**
+ * Bytes a module's live instances need, and how far memory was grown for them
+ */
+export interface MemoryBudget {
+  reserved: number;
+  grown: number;
+}
+
+interface PoolEntry {
+  ready: Promise<PooledModule>;
+  users: number;
+  claimed: boolean;
+  budget: MemoryBudget;
+}
+
+type ExportedFunction = (...args: number[]) => number;
+
+export const WASM_PAGE_SIZE = 65536;
+
+// SIMD_ALIGN in wasm/templates/dsp/simd.h
+const HEAP_ALIGN = 16;
+
+// Memory for modules whose declared limits are unknown
+const DEFAULT_MEMORY_PAGES = 256;
+const DEFAULT_MAXIMUM_PAGES = 512;
+
+/**
+ * Limits of a module's imported memory, in pages
+ */
+export interface MemoryLimits {
+  initial: number;
+  maximum?: number;
+}
+
+const moduleMemoryLimits = new WeakMap<WebAssembly.Module, MemoryLimits>();
+
+/**
+ * Read the limits of the memory a module imports from its bytes. Returns
+ * undefined if it imports none (or is not a module this can read).
+ */
+export function readMemoryImportLimits(bytes: ArrayBuffer): MemoryLimits | undefined {
+  const data = new Uint8Array(bytes);
+  if (data.length < 8 || data[0] !== 0x00 || data[1] !== 0x61 || data[2] !== 0x73 || data[3] !== 0x6d) {
+    return undefined;
+  }
+  
+  let pos = 8;
+  const readU32 = (): number => {
+    let result = 0;
+    let shift = 0;
+    let byte: number;
+    do {
+      byte = data[pos++];
+      result += (byte & 0x7f) * 2 ** shift;
+      shift += 7;
+    } while (byte & 0x80 && pos < data.length);
+    return result;
+  };
+  const skipName = (): void => {
+    const length = readU32();
+    pos += length;
+  };
+  const readLimits = (): MemoryLimits | undefined => {
+    const flags = data[pos++];
+    const initial = readU32();
+    const maximum = flags & 0x01 ? readU32() : undefined;
+    // 64-bit memories are not something the host creates
+    return flags & 0x04 ? undefined : { initial, maximum };
+  };
+  
+  while (pos < data.length) {
+    const id = data[pos++];
+    const size = readU32();
+    const end = pos + size;
+    
+    if (id === 2) {
+      const count = readU32();
+      for (let i = 0; i < count && pos < end; i++) {
+        skipName();
+        skipName();
+        const kind = data[pos++];
+        if (kind === 0) {
+          readU32(); // Function type index
+        } else if (kind === 1) {
+          pos++; // Table element type
+          readLimits();
+        } else if (kind === 2) {
+          return readLimits();
+        } else if (kind === 3) {
+          pos += 2; // Global type and mutability
+        } else if (kind === 4) {
+          pos++; // Tag attribute
+          readU32();
+        } else {
+          return undefined;
+        }
+      }
+      return undefined;
+    }
+    
+    // Only custom sections and the type section come before the imports
+    if (id > 2) return undefined;
+    pos = end;
+  }
+  return undefined;
+}
+
+/**
+ * Remember the memory limits a module was compiled with, read from its bytes
+ */
+export function recordModuleMemory(module: WebAssembly.Module, bytes: ArrayBuffer): void {
+  const limits = readMemoryImportLimits(bytes);
+  if (limits) moduleMemoryLimits.set(module, limits);
+}
+
+/**
+ * Descriptor for the memory a module is instantiated with: its declared
+ * minimum, which instances then grow by exactly what they need
+ */
+export function pluginMemoryDescriptor(module: WebAssembly.Module, shared: boolean): WebAssembly.MemoryDescriptor {
+  const limits = moduleMemoryLimits.get(module);
+  const initial = limits?.initial ?? DEFAULT_MEMORY_PAGES;
+  const maximum = limits?.maximum ?? Math.max(DEFAULT_MAXIMUM_PAGES, initial);
+  return { initial, maximum, shared };
+}
+
+/**
+ * Add the heap an instance created at sampleRate and bufferSize takes to the
+ * module's budget, for modules exporting getRequiredMemory(), and grow memory
+ * by the part the budget has not been grown for yet. Called before create()
+ * or init(), so the instance's allocations never grow memory later. Returns
+ * the bytes reserved, handed back to the budget when the instance goes.
+ */
+export function reserveInstanceMemory(
+  exports: Record<string, ExportedFunction>,
+  memory: WebAssembly.Memory,
+  budget: MemoryBudget,
+  sampleRate: number,
+  bufferSize: number
+): number {
+  if (!exports.getRequiredMemory) return 0;
+  return growBudget(memory, budget, Math.max(0, exports.getRequiredMemory(sampleRate, bufferSize)));
+}
+
+/**
+ * Add bytes to a budget, growing memory by the part it has not been grown for
+ */
+function growBudget(memory: WebAssembly.Memory, budget: MemoryBudget, required: number): number {
+  const pages = Math.ceil((budget.reserved + required - budget.grown) / WASM_PAGE_SIZE);
+  if (pages > 0) {
+    try {
+      memory.grow(pages);
+    } catch {
+      throw new Error('Plugin memory limit reached');
+    }
+    budget.grown += pages * WASM_PAGE_SIZE;
+  }
+  budget.reserved += required;
+  return required;
+}
+
+/**
+ * Heap bytes malloc(bytes) can take, header and alignment included; matches
+ * heapBlockBytes() in wasm/templates/dsp/arena.h
+ */
+function heapBlockBytes(bytes: number): number {
+  return ((bytes + HEAP_ALIGN - 1) & ~(HEAP_ALIGN - 1)) + 2 * HEAP_ALIGN;
+}
+
+// Handle-less functions that only make sense for the module's default instance
+const UNBOUND_EXPORTS = ['init', 'dispose', 'create', 'destroy'];
+
+/**
+ * Expose a module's instance*() functions under their handle-less names,
+ * with the handle filled in
+ */
+function bindInstanceExports(exports: WebAssembly.Exports, handle: number): WebAssembly.Exports {
+  const bound: WebAssembly.Exports = {};
+  
+  for (const [name, value] of Object.entries(exports)) {
+    if (!UNBOUND_EXPORTS.includes(name)) {
+      bound[name] = value;
+    }
+  }
+  
+  for (const [name, value] of Object.entries(exports)) {
+    if (!name.startsWith('instance') || name.length <= 8 || typeof value !== 'function') continue;
+    
+    // Fixed arity so audio-thread calls do not allocate a rest array
+    const fn = value as ExportedFunction;
+    const plain = name.charAt(8).toLowerCase() + name.slice(9);
+    bound[plain] = (a: number, b: number, c: number, d: number, e: number) => fn(handle, a, b, c, d, e);
+  }
+  
+  return bound;
+}
+
+/**
+ * Main-thread instance pool
+ */
+export class WASMInstancePool {
+  private static instance: WASMInstancePool | null = null;
+  private static moduleKeys = new WeakMap<WebAssembly.Module, string>();
+  private static nextModuleKey = 0;
+  
+  private entries: Map<string, PoolEntry> = new Map();
+  
+  /**
+   * Get singleton instance
+   */
+  public static getInstance(): WASMInstancePool {
+    if (!WASMInstancePool.instance) {
+      WASMInstancePool.instance = new WASMInstancePool();
+    }
+    return WASMInstancePool.instance;
+  }
+  
+  /**
+   * Stable pool key for a compiled module. Worklets receive their own copy
+   * of the module, so this key is what identifies it there.
+   */
+  public static moduleKey(module: WebAssembly.Module): string {
+    let key = WASMInstancePool.moduleKeys.get(module);
+    if (!key) {
+      key = `module-${++WASMInstancePool.nextModuleKey}`;
+      WASMInstancePool.moduleKeys.set(module, key);
+    }
+    return key;
+  }
+  
+  /**
+   * Create a plugin instance, instantiating the module for key only if no
+   * live instance of it exists yet
+   */
+  public async acquire(
+    key: string,
+    instantiate: () => Promise<PooledModule>,
+    sampleRate: number,
+    bufferSize: number
+  ): Promise<PooledInstance> {
+    let entry = this.entries.get(key);
+    if (!entry) {
+      entry = { ready: instantiate(), users: 0, claimed: false, budget: { reserved: 0, grown: 0 } };
+      this.entries.set(key, entry);
+    }
+    
+    let pooled: PooledModule;
+    try {
+      pooled = await entry.ready;
+    } catch (error) {
+      if (this.entries.get(key) === entry) this.entries.delete(key);
+      throw error;
+    }
+    
+    const exports = pooled.instance.exports as Record<string, ExportedFunction>;
+    
+    if (!exports.create || !exports.destroy) {
+      // Single-instance module: the first caller keeps it, later ones get their own
+      if (this.entries.get(key) === entry) this.entries.delete(key);
+      if (entry.claimed) {
+        return this.acquire(`${key}#${WASMInstancePool.nextModuleKey++}`, instantiate, sampleRate, bufferSize);
+      }
+      entry.claimed = true;
+      
+      const budget = entry.budget;
+      if (exports.init) {
+        reserveInstanceMemory(exports, pooled.memory, budget, sampleRate, bufferSize);
+        exports.init(sampleRate, bufferSize);
+      }
+      return {
+        ...pooled,
+        exports: pooled.instance.exports,
+        handle: 0,
+        reserve: (bytes: number) => {
+          if (exports.getRequiredMemory) growBudget(pooled.memory, budget, heapBlockBytes(bytes));
+        },
+        release: () => {
+          if (exports.dispose) exports.dispose();
+          pooled.dispose?.();
+        }
+      };
+    }
+    
+    const owner = entry;
+    let reserved = reserveInstanceMemory(exports, pooled.memory, owner.budget, sampleRate, bufferSize);
+    const handle = exports.create(sampleRate, bufferSize);
+    if (!handle) {
+      owner.budget.reserved -= reserved;
+      throw new Error('Plugin instance allocation failed');
+    }
+    owner.users++;
+    
+    let released = false;
+    return {
+      ...pooled,
+      exports: bindInstanceExports(pooled.instance.exports, handle),
+      handle,
+      reserve: (bytes: number) => {
+        if (!released && exports.getRequiredMemory) {
+          reserved += growBudget(pooled.memory, owner.budget, heapBlockBytes(bytes));
+        }
+      },
+      release: () => {
+        if (released) return;
+        released = true;
+        exports.destroy(handle);
+        owner.budget.reserved -= reserved;
+        if (--owner.users === 0 && this.entries.get(key) === owner) {
+          this.entries.delete(key);
+          pooled.dispose?.();
+        }
+      }
+    };
+  }
+  
+  /**
+   * Number of live instances sharing the module for key
+   */
+  public getInstanceCount(key: string): number {
+    return this.entries.get(key)?.users ?? 0;
+  }
+}
+
+/**
+ * Audio-thread pool, inlined into worklet processor sources. One pool per
+ * AudioWorkletGlobalScope, so all processors of a context share it.
+ * Keep in sync with WASMInstancePool above.
+ */
+export const wasmInstancePoolSource = `
+  const UNBOUND_EXPORTS = ${JSON.stringify(UNBOUND_EXPORTS)};
+  
+  function bindInstanceExports(exports, handle) {
+    const bound = {};
+    for (const name of Object.keys(exports)) {
+      if (!UNBOUND_EXPORTS.includes(name)) bound[name] = exports[name];
+    }
+    for (const name of Object.keys(exports)) {
+      const fn = exports[name];
+      if (!name.startsWith('instance') || name.length <= 8 || typeof fn !== 'function') continue;
+      const plain = name.charAt(8).toLowerCase() + name.slice(9);
+      bound[plain] = (a, b, c, d, e) => fn(handle, a, b, c, d, e);
+    }
+    return bound;
+  }
+  
+  function reserveInstanceMemory(exports, memory, budget, sampleRate, bufferSize) {
+    if (!exports.getRequiredMemory) return 0;
+    return growBudget(memory, budget, Math.max(0, exports.getRequiredMemory(sampleRate, bufferSize)));
+  }
+  
+  function growBudget(memory, budget, required) {
+    const pages = Math.ceil((budget.reserved + required - budget.grown) / ${WASM_PAGE_SIZE});
+    if (pages > 0) {
+      try {
+        memory.grow(pages);
+      } catch (error) {
+        throw new Error('Plugin memory limit reached');
+      }
+      budget.grown += pages * ${WASM_PAGE_SIZE};
+    }
+    budget.reserved += required;
+    return required;
+  }
+  
+  function heapBlockBytes(bytes) {
+    return ((bytes + ${HEAP_ALIGN - 1}) & ~${HEAP_ALIGN - 1}) + ${2 * HEAP_ALIGN};
+  }
+  
+  class WASMInstancePool {
+    constructor() {
+      this.entries = new Map();
+      this.nextKey = 0;
+    }
+    
+    // instantiate() resolves to { module, instance, memory, dispose? }
+    async acquire(key, instantiate, sampleRate, bufferSize) {
+      let entry = this.entries.get(key);
+      if (!entry) {
+        entry = { ready: instantiate(), users: 0, claimed: false, budget: { reserved: 0, grown: 0 } };
+        this.entries.set(key, entry);
+      }
+      
+      let pooled;
+      try {
+        pooled = await entry.ready;
+      } catch (error) {
+        if (this.entries.get(key) === entry) this.entries.delete(key);
+        throw error;
+      }
+      
+      const exports = pooled.instance.exports;
+      
+      if (!exports.create || !exports.destroy) {
+        if (this.entries.get(key) === entry) this.entries.delete(key);
+        if (entry.claimed) {
+          return this.acquire(key + '#' + this.nextKey++, instantiate, sampleRate, bufferSize);
+        }
+        entry.claimed = true;
+        
+        if (exports.init) {
+          reserveInstanceMemory(exports, pooled.memory, entry.budget, sampleRate, bufferSize);
+          exports.init(sampleRate, bufferSize);
+        }
+        return {
+          ...pooled,
+          exports,
+          handle: 0,
+          reserve: (bytes) => {
+            if (exports.getRequiredMemory) growBudget(pooled.memory, entry.budget, heapBlockBytes(bytes));
+          },
+          release: () => {
+            if (exports.dispose) exports.dispose();
+            if (pooled.dispose) pooled.dispose();
+          }
+        };
+      }
+      
+      let reserved = reserveInstanceMemory(exports, pooled.memory, entry.budget, sampleRate, bufferSize);
+      const handle = exports.create(sampleRate, bufferSize);
+      if (!handle) {
+        entry.budget.reserved -= reserved;
+        throw new Error('Plugin instance allocation failed');
+      }
+      entry.users++;
+      
+      let released = false;
+      return {
+        ...pooled,
+        exports: bindInstanceExports(exports, handle),
+        handle,
+        reserve: (bytes) => {
+          if (!released && exports.getRequiredMemory) {
+            reserved += growBudget(pooled.memory, entry.budget, heapBlockBytes(bytes));
+          }
+        },
+        release: () => {
+          if (released) return;
+          released = true;
+          exports.destroy(handle);
+          entry.budget.reserved -= reserved;
+          if (--entry.users === 0 && this.entries.get(key) === entry) {
+            this.entries.delete(key);
+            if (pooled.dispose) pooled.dispose();
+          }
+        }
+      };
+    }
+  }
+  
+  const wasmInstancePool = new WASMInstancePool();
+`;
@@ -0,0 +1,153 @@
+// Copyright (c) 2025 Jema Technology.
+// Distributed under the license specified in the root directory of this project.
+/**
+ * WASMOfflineRenderer - Faster-than-realtime rendering of WASM plugins for export
+ *
+ * Drives a plugin's processOffline() export directly in large planar blocks,
+ * bypassing the audio graph: no 128-frame render quanta, no worklet
+ * messaging, one call per block. The plugin works through each block
+ * internally in cache-sized chunks.
+ */
+
+import { TIMED_EVENT_INT32S } from './PluginHost';
+import type { PooledInstance } from './WASMInstancePool';
+
+/**
+ * Frames handed to processOffline() per call
+ */
+export const OFFLINE_BLOCK_SIZE = 65536;
+
+/**
+ * A timestamped event for an offline instrument render
+ */
+export interface OfflineEvent {
+  /** Frame from the start of the render */
+  frame: number;
+  /** TimedEventType */
+  type: number;
+  data1: number;
+  data2?: number;
+  channel?: number;
+}
+
+export interface OfflineRenderOptions {
+  /** Frames to render */
+  length: number;
+  /** Instrument events, sorted by frame */
+  events?: OfflineEvent[];
+  /** Effect input, one array per channel (mono input feeds both channels) */
+  input?: Float32Array[];
+  blockSize?: number;
+  onProgress?: (progress: number) => void;
+  isCancelled?: () => boolean;
+}
+
+interface OfflineExports {
+  processOffline?: (inputPtr: number, outputPtr: number, numSamples: number, a: number, b?: number) => void;
+  malloc: (size: number) => number;
+  free: (ptr: number) => void;
+}
+
+const OFFLINE_CHANNELS = 2;
+
+/**
+ * Whether a plugin can be rendered with renderPluginOffline()
+ */
+export function supportsOfflineRender(exports: WebAssembly.Exports): boolean {
+  return typeof exports.processOffline === 'function';
+}
+
+/**
+ * Render a plugin instance offline. With options.input the plugin is treated
+ * as an effect, otherwise as an instrument played by options.events.
+ * Returns one array per channel.
+ */
+export async function renderPluginOffline(
+  pooled: PooledInstance,
+  options: OfflineRenderOptions
+): Promise<Float32Array[]> {
+  const exports = pooled.exports as unknown as OfflineExports;
+  const processOffline = exports.processOffline;
+  if (!processOffline) {
+    throw new Error('Plugin does not export processOffline()');
+  }
+  
+  const { length, input } = options;
+  const events = options.events ?? [];
+  const blockSize = Math.max(1, Math.min(options.blockSize ?? OFFLINE_BLOCK_SIZE, length));
+  const output = Array.from({ length: OFFLINE_CHANNELS }, () => new Float32Array(length));
+  
+  const audioPtr = exports.malloc(blockSize * OFFLINE_CHANNELS * Float32Array.BYTES_PER_ELEMENT);
+  if (!audioPtr) {
+    throw new Error('Offline render buffer allocation failed');
+  }
+  let eventPtr = 0;
+  let eventCapacity = 0;
+  
+  try {
+    let next = 0;
+    
+    for (let pos = 0; pos < length; pos += blockSize) {
+      if (options.isCancelled?.()) {
+        throw new Error('Export cancelled');
+      }
+      
+      const frames = Math.min(blockSize, length - pos);
+      
+      if (input) {
+        // Views are recreated after every call in case memory grew
+        const planar = new Float32Array(pooled.memory.buffer, audioPtr, frames * OFFLINE_CHANNELS);
+        planar.fill(0);
+        for (let ch = 0; ch < OFFLINE_CHANNELS && input.length > 0; ch++) {
+          const source = input[Math.min(ch, input.length - 1)];
+          planar.set(source.subarray(pos, pos + frames), ch * frames);
+        }
+        processOffline(audioPtr, audioPtr, frames, OFFLINE_CHANNELS);
+      } else {
+        let count = 0;
+        while (next + count < events.length && events[next + count].frame < pos + frames) {
+          count++;
+        }
+        
+        if (count > eventCapacity) {
+          if (eventPtr) exports.free(eventPtr);
+          eventCapacity = Math.max(count, eventCapacity * 2);
+          eventPtr = exports.malloc(eventCapacity * TIMED_EVENT_INT32S * Int32Array.BYTES_PER_ELEMENT);
+          if (!eventPtr) {
+            throw new Error('Offline event buffer allocation failed');
+          }
+        }
+        
+        // Event offsets are relative to the block
+        const packed = new Int32Array(pooled.memory.buffer, eventPtr, count * TIMED_EVENT_INT32S);
+        for (let i = 0; i < count; i++) {
+          const event = events[next + i];
+          const base = i * TIMED_EVENT_INT32S;
+          packed[base] = Math.max(0, event.frame - pos);
+          packed[base + 1] = event.type;
+          packed[base + 2] = event.data1;
+          packed[base + 3] = event.data2 ?? 0;
+          packed[base + 4] = event.channel ?? 0;
+        }
+        next += count;
+        
+        processOffline(0, audioPtr, frames, eventPtr, count);
+      }
+      
+      const planar = new Float32Array(pooled.memory.buffer, audioPtr, frames * OFFLINE_CHANNELS);
+      for (let ch = 0; ch < OFFLINE_CHANNELS; ch++) {
+        output[ch].set(planar.subarray(ch * frames, (ch + 1) * frames), pos);
+      }
+      
+      options.onProgress?.((pos + frames) / length);
+      
+      // Let progress updates and cancel() through between blocks
+      await new Promise((resolve) => setTimeout(resolve, 0));
+    }
+  } finally {
+    exports.free(audioPtr);
+    if (eventPtr) exports.free(eventPtr);
+  }
+  
+  return output;
+}
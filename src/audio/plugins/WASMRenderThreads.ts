@@ -0,0 +1,128 @@
+// Copyright (c) 2025 Jema Technology.
+// Distributed under the license specified in the root directory of this project.
+/**
+ * WASMRenderThreads - Helper threads for plugins built with render threads
+ *
+ * An instrument built from the template with -DRENDER_THREADS=N (see
+ * wasm/README.md) can render its voices on up to N helper threads besides
+ * the audio thread. An AudioWorklet cannot start workers, so the worklet
+ * that instantiates such a module sends the module and its shared memory to
+ * the main thread, which starts the helpers here: Web Workers that
+ * instantiate the same module on the same memory and stay in
+ * renderThreadRun() until the worklet calls stopRenderThreads() with the
+ * module's last instance.
+ *
+ * A threaded build needs shared memory, so a cross-origin isolated page.
+ * Elsewhere the host loads the manifest's single-threaded wasmUrl instead of
+ * wasmThreadsUrl, and a threaded module whose helpers never start renders
+ * every voice on the audio thread.
+ */
+
+import type { WAPManifest } from './PluginHost';
+import { SharedParameterBlock } from './SharedParameterBlock';
+
+/**
+ * Cores left to the main thread and the audio thread
+ */
+const RESERVED_CORES = 2;
+
+/**
+ * Whether a compiled module is a threaded build: it serves render threads
+ * and imports the memory they share
+ */
+export function isThreadedModule(module: WebAssembly.Module): boolean {
+  return WebAssembly.Module.exports(module).some(entry => entry.name === 'renderThreadRun') &&
+    WebAssembly.Module.imports(module).some(entry => entry.kind === 'memory');
+}
+
+/**
+ * Module URL to load for a manifest: the threaded build where the page can
+ * share memory with workers, otherwise the single-threaded one
+ */
+export function pluginWasmUrl(manifest: WAPManifest): string {
+  return manifest.wasmThreadsUrl && SharedParameterBlock.isSupported()
+    ? manifest.wasmThreadsUrl
+    : manifest.wasmUrl;
+}
+
+/**
+ * Render thread worker. Helpers only run the voice kernels, so imports
+ * other than the memory are satisfied with Math or no-ops.
+ */
+const renderThreadWorkerSource = `
+  self.onmessage = async (event) => {
+    const { wasmModule, memory, index } = event.data;
+    const imports = { env: { memory, hostClock: () => performance.now(), ln: Math.log } };
+    
+    for (const entry of WebAssembly.Module.imports(wasmModule)) {
+      if (entry.kind !== 'function') continue;
+      const scope = imports[entry.module] || (imports[entry.module] = {});
+      if (!(entry.name in scope)) {
+        scope[entry.name] = typeof Math[entry.name] === 'function' ? Math[entry.name] : () => 0;
+      }
+    }
+    
+    try {
+      const { exports } = await WebAssembly.instantiate(wasmModule, imports);
+      
+      // Move off the audio thread's stack before running anything that uses one
+      exports.__stack_pointer.value = exports.renderThreadStack(index);
+      exports.renderThreadRun(index);
+    } catch (error) {
+      console.error('WASM render thread failed:', error);
+    }
+    self.close();
+  };
+`;
+
+let workerUrl: string | null = null;
+
+/**
+ * Start up to count render threads for a module instantiated on memory.
+ * Returns the number started.
+ */
+export function startRenderThreads(module: WebAssembly.Module, memory: WebAssembly.Memory, count: number): number {
+  if (typeof Worker === 'undefined' || !(memory.buffer instanceof SharedArrayBuffer)) {
+    return 0;
+  }
+  
+  const cores = typeof navigator !== 'undefined' ? navigator.hardwareConcurrency || 1 : 1;
+  const threads = Math.max(0, Math.min(count, cores - RESERVED_CORES));
+  if (threads === 0) return 0;
+  
+  if (!workerUrl) {
+    workerUrl = URL.createObjectURL(new Blob([renderThreadWorkerSource], { type: 'application/javascript' }));
+  }
+  for (let index = 0; index < threads; index++) {
+    new Worker(workerUrl).postMessage({ wasmModule: module, memory, index });
+  }
+  return threads;
+}
+
+/**
+ * Worklet side, inlined into worklet processor sources. Keep
+ * isThreadedModule in sync with the one above.
+ */
+export const renderThreadsSource = `
+  function isThreadedModule(wasmModule) {
+    return WebAssembly.Module.exports(wasmModule).some(entry => entry.name === 'renderThreadRun') &&
+      WebAssembly.Module.imports(wasmModule).some(entry => entry.kind === 'memory');
+  }
+  
+  // Ask the main thread for render threads on a threaded module just
+  // instantiated on memory. Returns the function that stops them, for the
+  // pool entry's dispose().
+  function requestRenderThreads(port, wasmModule, instance, memory) {
+    const exports = instance.exports;
+    if (!isThreadedModule(wasmModule) || !(exports.__stack_pointer instanceof WebAssembly.Global)) {
+      return undefined;
+    }
+    port.postMessage({
+      type: 'renderThreads',
+      wasmModule,
+      memory,
+      count: exports.getRenderThreadCount()
+    });
+    return () => exports.stopRenderThreads();
+  }
+`;
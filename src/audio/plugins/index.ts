@@ -7,4 +7,10 @@
 
 export * from './PluginHost';
 export * from './PluginLoader';
-export * from './PluginBridge';
\ No newline at end of file
+export * from './PluginLoadMonitor';
+export * from './PluginBridge';
+export * from './SharedParameterBlock';
+export * from './WASMInstancePool';
+export * from './WASMOfflineRenderer';
+export * from './WASMRenderThreads';
+export * from './DrumSynthRenderer';
\ No newline at end of file
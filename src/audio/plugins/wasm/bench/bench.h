@@ -0,0 +1,74 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Shared timing and reporting for the template benchmarks
+ *
+ * Each benchmark links exactly one template (both define init(), process(),
+ * ...) and runs a list of scenarios, printing one line per scenario:
+ *
+ *   scenario                        block   ns/sample   voice-samples/s
+ *
+ * ns/sample is wall time per output frame. voice-samples/s counts one sample
+ * per sounding voice, so it compares instrument scenarios of different
+ * polyphony; effects and silent instruments report frames/s there. Built
+ * natively or, with emcmake, as WASM run under Node.
+ */
+
+#ifndef ANKH_BENCH_H
+#define ANKH_BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Block sizes every scenario is measured at
+static const int benchBlockSizes[] = { 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+#define NUM_BENCH_BLOCK_SIZES ((int)(sizeof(benchBlockSizes) / sizeof(benchBlockSizes[0])))
+
+// Frames rendered per measurement, and with --quick (used by ctest)
+#define BENCH_FRAMES (44100 * 10)
+#define BENCH_FRAMES_QUICK 4096
+
+static inline double benchNow() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Frames to render per measurement, from the command line
+ */
+static inline int benchFrames(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) return BENCH_FRAMES_QUICK;
+    }
+    return BENCH_FRAMES;
+}
+
+static inline void benchPrintHeader(const char* title) {
+    printf("%s\n", title);
+    printf("%-32s %6s %11s %17s\n", "scenario", "block", "ns/sample", "voice-samples/s");
+}
+
+/**
+ * Print one measurement. voices is the number of sounding voices
+ * (for effects, the number of instances processed).
+ */
+static inline void benchReport(const char* scenario, int blockSize, double seconds, int frames, int voices) {
+    double nsPerSample = seconds * 1e9 / frames;
+    double voiceSamples = seconds > 0.0 ? (double)frames * (voices > 0 ? voices : 1) / seconds : 0.0;
+    printf("%-32s %6d %11.2f %17.3e\n", scenario, blockSize, nsPerSample, voiceSamples);
+}
+
+// Keeps the optimizer from discarding rendered output
+static volatile float benchSink;
+
+static inline void benchConsume(const float* buffer, int length) {
+    float sum = 0.0f;
+    for (int i = 0; i < length; i++) sum += buffer[i];
+    benchSink = sum;
+}
+
+#endif // ANKH_BENCH_H
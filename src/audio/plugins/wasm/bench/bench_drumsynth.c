@@ -0,0 +1,127 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Throughput benchmark for drumsynth/drumsynth.c
+ *
+ * Renders every kit in samples/drumsynth at 44.1 and 96 kHz, as the sample
+ * browser does when it fills its cache, and prints one line per kit:
+ *
+ *   kit                rate   patches   ms/patch   ns/sample
+ *
+ * Usage: bench_drumsynth [--quick]   (--quick renders the tr808 kit only)
+ */
+
+#include <dirent.h>
+
+#include "bench.h"
+
+// ============================================================================
+// Renderer ABI
+// ============================================================================
+
+int renderPatch(const char* text, int length, float sampleRate);
+float* getRenderOutput();
+void releaseRender();
+
+#ifndef DRUMSYNTH_PATCH_DIR
+#define DRUMSYNTH_PATCH_DIR "../../../../samples/drumsynth"
+#endif
+
+#define MAX_PATCH_BYTES 16384
+#define MAX_KIT_PATCHES 256
+
+static const float sampleRates[] = { 44100.0f, 96000.0f };
+
+typedef struct {
+    char* texts[MAX_KIT_PATCHES];
+    int lengths[MAX_KIT_PATCHES];
+    int count;
+} Kit;
+
+static int hasExtension(const char* name, const char* extension) {
+    size_t length = strlen(name);
+    size_t extensionLength = strlen(extension);
+    return length > extensionLength && strcmp(name + length - extensionLength, extension) == 0;
+}
+
+/**
+ * Read a kit's patches up front, so only rendering is timed
+ */
+static int loadKit(Kit* kit, const char* name) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", DRUMSYNTH_PATCH_DIR, name);
+    kit->count = 0;
+
+    DIR* dir = opendir(path);
+    if (!dir) return 0;
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) && kit->count < MAX_KIT_PATCHES) {
+        if (!hasExtension(entry->d_name, ".ds")) continue;
+
+        char file[2048];
+        snprintf(file, sizeof(file), "%s/%s", path, entry->d_name);
+        FILE* in = fopen(file, "rb");
+        if (!in) continue;
+
+        char* text = (char*)malloc(MAX_PATCH_BYTES);
+        kit->lengths[kit->count] = (int)fread(text, 1, MAX_PATCH_BYTES, in);
+        kit->texts[kit->count++] = text;
+        fclose(in);
+    }
+    closedir(dir);
+    return kit->count;
+}
+
+static void freeKit(Kit* kit) {
+    for (int i = 0; i < kit->count; i++) free(kit->texts[i]);
+    kit->count = 0;
+}
+
+static void measure(const char* name, const Kit* kit, float sampleRate) {
+    long frames = 0;
+    double start = benchNow();
+    for (int i = 0; i < kit->count; i++) {
+        int rendered = renderPatch(kit->texts[i], kit->lengths[i], sampleRate);
+        benchConsume(getRenderOutput(), rendered);
+        frames += rendered;
+    }
+    double seconds = benchNow() - start;
+
+    printf("%-24s %7.0f %9d %10.3f %11.2f\n", name, sampleRate, kit->count,
+           seconds * 1e3 / kit->count, frames ? seconds * 1e9 / frames : 0.0);
+}
+
+static void measureKit(const char* name) {
+    Kit kit;
+    if (!loadKit(&kit, name)) return;
+
+    for (int r = 0; r < (int)(sizeof(sampleRates) / sizeof(sampleRates[0])); r++) {
+        measure(name, &kit, sampleRates[r]);
+    }
+    freeKit(&kit);
+}
+
+int main(int argc, char** argv) {
+    printf("drumsynth.c\n");
+    printf("%-24s %7s %9s %10s %11s\n", "kit", "rate", "patches", "ms/patch", "ns/sample");
+
+    if (benchFrames(argc, argv) == BENCH_FRAMES_QUICK) {
+        measureKit("tr808");
+    } else {
+        DIR* root = opendir(DRUMSYNTH_PATCH_DIR);
+        if (!root) {
+            fprintf(stderr, "cannot open %s\n", DRUMSYNTH_PATCH_DIR);
+            return 1;
+        }
+        struct dirent* entry;
+        while ((entry = readdir(root))) {
+            if (entry->d_name[0] != '.') measureKit(entry->d_name);
+        }
+        closedir(root);
+    }
+
+    releaseRender();
+    return 0;
+}
@@ -0,0 +1,162 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Throughput benchmark for effect_template.c
+ *
+ * Measures interleaved process(), planar processBlock() and the
+ * plugin-owned processBuffers() path on a test signal, silent input (the
+ * quiescent fast path) and a parameter sweep that ramps gain and cutoff
+ * every block, at each block size in benchBlockSizes. The batch scenarios
+ * run BATCH_INSTANCES instances through processBuffers() one by one and
+ * through one processBatch() call.
+ *
+ * Usage: bench_effect [--quick]
+ */
+
+#include <math.h>
+
+#include "bench.h"
+
+// ============================================================================
+// Template ABI
+// ============================================================================
+
+void* create(float sr, int bs);
+void destroy(void* fx);
+void instanceProcess(void* fx, float* input, float* output, int numSamples);
+void instanceProcessBlock(void* fx, float* input, float* output, int numSamples, int numChannels);
+float* instanceGetInputBuffer(void* fx, int ch);
+void instanceProcessBuffers(void* fx, int numSamples, int numChannels);
+void instanceSetParameterRamp(void* fx, int index, float target, int durationSamples);
+void processBatch(void** instances, int count, int numSamples, int numChannels);
+
+#define PARAM_GAIN 0
+#define PARAM_CUTOFF 2
+
+#define NUM_CHANNELS 2
+#define SAMPLE_RATE 44100.0f
+#define MAX_BLOCK 4096
+#define BATCH_INSTANCES 8
+
+typedef enum {
+    PATH_INTERLEAVED = 0,
+    PATH_PLANAR,
+    PATH_BUFFERS
+} ProcessPath;
+
+static float signal[MAX_BLOCK * NUM_CHANNELS];
+static float silence[MAX_BLOCK * NUM_CHANNELS];
+static float output[MAX_BLOCK * NUM_CHANNELS];
+
+// ============================================================================
+// Scenarios
+// ============================================================================
+
+static void measure(const char* name, ProcessPath path, const float* input, int sweep, int blockSize, int frames) {
+    void* fx = create(SAMPLE_RATE, blockSize);
+    if (!fx) {
+        fprintf(stderr, "create() failed\n");
+        exit(1);
+    }
+
+    float* io[NUM_CHANNELS] = { instanceGetInputBuffer(fx, 0), instanceGetInputBuffer(fx, 1) };
+
+    double start = benchNow();
+    int block = 0;
+    for (int pos = 0; pos < frames; pos += blockSize, block++) {
+        if (sweep) {
+            float t = (float)(block % 256) / 256.0f;
+            instanceSetParameterRamp(fx, PARAM_GAIN, 0.5f + t, blockSize);
+            instanceSetParameterRamp(fx, PARAM_CUTOFF, 200.0f + t * 12000.0f, blockSize);
+        }
+
+        switch (path) {
+            case PATH_INTERLEAVED:
+                instanceProcess(fx, (float*)input, output, blockSize);
+                break;
+            case PATH_PLANAR:
+                instanceProcessBlock(fx, (float*)input, output, blockSize, NUM_CHANNELS);
+                break;
+            case PATH_BUFFERS:
+                // Copy in as a host would
+                for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+                    memcpy(io[ch], input + ch * blockSize, blockSize * sizeof(float));
+                }
+                instanceProcessBuffers(fx, blockSize, NUM_CHANNELS);
+                memcpy(output, io[0], blockSize * sizeof(float));
+                break;
+        }
+    }
+    double seconds = benchNow() - start;
+
+    benchConsume(output, blockSize * NUM_CHANNELS);
+    benchReport(name, blockSize, seconds, block * blockSize, 1);
+    destroy(fx);
+}
+
+static void measureBatch(const char* name, int batched, int blockSize, int frames) {
+    void* fx[BATCH_INSTANCES];
+    for (int n = 0; n < BATCH_INSTANCES; n++) {
+        fx[n] = create(SAMPLE_RATE, blockSize);
+        if (!fx[n]) {
+            fprintf(stderr, "create() failed\n");
+            exit(1);
+        }
+    }
+
+    double start = benchNow();
+    int block = 0;
+    for (int pos = 0; pos < frames; pos += blockSize, block++) {
+        for (int n = 0; n < BATCH_INSTANCES; n++) {
+            for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+                memcpy(instanceGetInputBuffer(fx[n], ch), signal + ch * blockSize, blockSize * sizeof(float));
+            }
+            if (!batched) instanceProcessBuffers(fx[n], blockSize, NUM_CHANNELS);
+        }
+        if (batched) processBatch(fx, BATCH_INSTANCES, blockSize, NUM_CHANNELS);
+    }
+    double seconds = benchNow() - start;
+
+    benchConsume(instanceGetInputBuffer(fx[BATCH_INSTANCES - 1], 0), blockSize);
+    benchReport(name, blockSize, seconds, block * blockSize, BATCH_INSTANCES);
+    for (int n = 0; n < BATCH_INSTANCES; n++) destroy(fx[n]);
+}
+
+int main(int argc, char** argv) {
+    int frames = benchFrames(argc, argv);
+
+    // Two detuned sines with a little noise, so the filter has work to do
+    unsigned int seed = 1;
+    for (int i = 0; i < MAX_BLOCK * NUM_CHANNELS; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        float noise = ((seed >> 9) / 8388608.0f - 0.5f) * 0.05f;
+        signal[i] = 0.4f * sinf(i * 0.031f) + 0.3f * sinf(i * 0.173f) + noise;
+    }
+
+    benchPrintHeader("effect_template.c");
+
+    for (int b = 0; b < NUM_BENCH_BLOCK_SIZES; b++) {
+        measure("signal interleaved", PATH_INTERLEAVED, signal, 0, benchBlockSizes[b], frames);
+    }
+    for (int b = 0; b < NUM_BENCH_BLOCK_SIZES; b++) {
+        measure("signal planar", PATH_PLANAR, signal, 0, benchBlockSizes[b], frames);
+    }
+    for (int b = 0; b < NUM_BENCH_BLOCK_SIZES; b++) {
+        measure("signal processBuffers", PATH_BUFFERS, signal, 0, benchBlockSizes[b], frames);
+    }
+    for (int b = 0; b < NUM_BENCH_BLOCK_SIZES; b++) {
+        measure("silence planar", PATH_PLANAR, silence, 0, benchBlockSizes[b], frames);
+    }
+    for (int b = 0; b < NUM_BENCH_BLOCK_SIZES; b++) {
+        measure("signal planar sweep", PATH_PLANAR, signal, 1, benchBlockSizes[b], frames);
+    }
+    for (int b = 0; b < NUM_BENCH_BLOCK_SIZES; b++) {
+        measureBatch("8x signal processBuffers", 0, benchBlockSizes[b], frames);
+    }
+    for (int b = 0; b < NUM_BENCH_BLOCK_SIZES; b++) {
+        measureBatch("8x signal processBatch", 1, benchBlockSizes[b], frames);
+    }
+
+    return 0;
+}
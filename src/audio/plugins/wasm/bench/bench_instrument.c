@@ -0,0 +1,128 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Throughput benchmark for instrument_template.c
+ *
+ * Measures process() for 0, 1 and 16 held voices with every waveform and
+ * oscillator mode, plus a parameter sweep that moves cutoff and detune
+ * every block and eight-lane spread unison on two voices (the same 16 lanes
+ * through the stereo kernels), at each block size in benchBlockSizes.
+ * Built with a larger -DMAX_VOICES, full polyphony is measured too; with
+ * -DRENDER_THREADS=N the voices render on N helper threads (see
+ * render_threads.h).
+ *
+ * Usage: bench_instrument [--quick]
+ */
+
+#include "bench.h"
+#include "render_threads.h"
+
+// ============================================================================
+// Template ABI
+// ============================================================================
+
+void* create(float sr, int bs);
+void destroy(void* synth);
+void instanceProcess(void* synth, float* input, float* output, int numSamples);
+void instanceNoteOn(void* synth, int note, int velocity, int channel);
+void instanceSetParameter(void* synth, int index, float value);
+int instanceGetActiveVoiceCount(void* synth);
+
+#define PARAM_WAVEFORM 0
+#define PARAM_CUTOFF 5
+#define PARAM_DETUNE 7
+#define PARAM_OSC_MODE 8
+#define PARAM_UNISON 10
+#define PARAM_STEREO_SPREAD 12
+
+#define NUM_WAVEFORMS 5
+
+static const char* waveformNames[NUM_WAVEFORMS] = { "sine", "square", "saw", "triangle", "noise" };
+static const char* modeNames[2] = { "analytic", "wavetable" };
+#if defined(MAX_VOICES) && MAX_VOICES > 16
+static const int voiceCounts[] = { 0, 1, 16, MAX_VOICES };
+#else
+static const int voiceCounts[] = { 0, 1, 16 };
+#endif
+
+#define SAMPLE_RATE 44100.0f
+#define MAX_BLOCK 4096
+
+static float output[MAX_BLOCK * 2];
+
+// ============================================================================
+// Scenarios
+// ============================================================================
+
+/**
+ * Render frames in blockSize blocks and report. Each voice plays unison
+ * spread lanes, counted as voices in the report; sweep moves cutoff and
+ * detune before every block.
+ */
+static void measure(const char* name, int waveform, int mode, int voices, int unison, int sweep, int blockSize,
+                    int frames) {
+    void* synth = create(SAMPLE_RATE, blockSize);
+    if (!synth) {
+        fprintf(stderr, "create() failed\n");
+        exit(1);
+    }
+
+    instanceSetParameter(synth, PARAM_WAVEFORM, (float)waveform);
+    instanceSetParameter(synth, PARAM_OSC_MODE, (float)mode);
+    instanceSetParameter(synth, PARAM_UNISON, (float)unison);
+    instanceSetParameter(synth, PARAM_STEREO_SPREAD, 1.0f);
+    for (int v = 0; v < voices; v++) {
+        instanceNoteOn(synth, 36 + v * 3, 100, 0);
+    }
+    int sounding = instanceGetActiveVoiceCount(synth) * unison;
+
+    double start = benchNow();
+    int block = 0;
+    for (int pos = 0; pos < frames; pos += blockSize, block++) {
+        if (sweep) {
+            float t = (float)(block % 256) / 256.0f;
+            instanceSetParameter(synth, PARAM_CUTOFF, 200.0f + t * 12000.0f);
+            instanceSetParameter(synth, PARAM_DETUNE, t - 0.5f);
+        }
+        instanceProcess(synth, NULL, output, blockSize);
+    }
+    double seconds = benchNow() - start;
+
+    benchConsume(output, blockSize * 2);
+    benchReport(name, blockSize, seconds, block * blockSize, sounding);
+    destroy(synth);
+}
+
+int main(int argc, char** argv) {
+    int frames = benchFrames(argc, argv);
+    char name[64];
+
+    benchPrintHeader("instrument_template.c");
+    startHostRenderThreads();
+
+    for (int vc = 0; vc < (int)(sizeof(voiceCounts) / sizeof(voiceCounts[0])); vc++) {
+        int voices = voiceCounts[vc];
+        for (int waveform = 0; waveform < NUM_WAVEFORMS; waveform++) {
+            // Noise has no wavetable form
+            int modes = waveform == NUM_WAVEFORMS - 1 ? 1 : 2;
+            for (int mode = 0; mode < modes; mode++) {
+                snprintf(name, sizeof(name), "%s/%s %dv", waveformNames[waveform], modeNames[mode], voices);
+                for (int b = 0; b < NUM_BENCH_BLOCK_SIZES; b++) {
+                    measure(name, waveform, mode, voices, 1, 0, benchBlockSizes[b], frames);
+                }
+            }
+        }
+    }
+
+    for (int b = 0; b < NUM_BENCH_BLOCK_SIZES; b++) {
+        measure("saw/wavetable 16v sweep", 2, 1, 16, 1, 1, benchBlockSizes[b], frames);
+    }
+
+    for (int b = 0; b < NUM_BENCH_BLOCK_SIZES; b++) {
+        measure("saw/wavetable 2v unison 8", 2, 1, 2, 8, 0, benchBlockSizes[b], frames);
+    }
+
+    stopHostRenderThreads();
+    return 0;
+}
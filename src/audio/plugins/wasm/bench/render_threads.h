@@ -0,0 +1,60 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Native stand-in for the host's render threads
+ *
+ * In the browser the host runs renderThreadRun() in Web Workers. Benchmarks
+ * and tests built with -DRENDER_THREADS=N run it on pthreads instead, so the
+ * threaded path is measured and checked natively. Without RENDER_THREADS
+ * both functions do nothing.
+ */
+
+#ifndef ANKH_RENDER_THREADS_H
+#define ANKH_RENDER_THREADS_H
+
+#if RENDER_THREADS
+
+#include <pthread.h>
+#include <stdint.h>
+
+// Template ABI
+int getRenderThreadCount();
+void renderThreadRun(int index);
+void stopRenderThreads();
+
+static pthread_t renderThreads[RENDER_THREADS];
+
+static void* renderThreadMain(void* index) {
+    renderThreadRun((int)(intptr_t)index);
+    return NULL;
+}
+
+/**
+ * Start the template's render threads (on their own stacks, so
+ * renderThreadStack() is not needed)
+ */
+static inline void startHostRenderThreads() {
+    for (int i = 0; i < getRenderThreadCount(); i++) {
+        pthread_create(&renderThreads[i], NULL, renderThreadMain, (void*)(intptr_t)i);
+    }
+}
+
+static inline void stopHostRenderThreads() {
+    stopRenderThreads();
+    for (int i = 0; i < getRenderThreadCount(); i++) {
+        pthread_join(renderThreads[i], NULL);
+    }
+}
+
+#else
+
+static inline void startHostRenderThreads() {
+}
+
+static inline void stopHostRenderThreads() {
+}
+
+#endif // RENDER_THREADS
+
+#endif // ANKH_RENDER_THREADS_H
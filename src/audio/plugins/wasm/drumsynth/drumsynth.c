@@ -0,0 +1,821 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * DrumSynth Patch Renderer
+ *
+ * Renders DrumSynth 1.x/2.x patches (the .ds files in samples/drumsynth) to
+ * mono PCM in one call, for the sample browser and drum kits. Compile with
+ * Emscripten:
+ *
+ * emcc drumsynth.c -o drumsynth.wasm \
+ *   -s WASM=1 \
+ *   -s EXPORTED_FUNCTIONS='["_renderPatch","_getRenderOutput","_releaseRender","_malloc","_free"]' \
+ *   -s ALLOW_MEMORY_GROWTH=1 \
+ *   -O3
+ *
+ * A patch is an INI file describing up to six sources (tone, noise, two
+ * overtones, two noise bands), each with its own envelope, followed by a
+ * resonant filter and a bit-crushing distortion stage. The host copies the
+ * patch text into module memory and calls renderPatch() with its sample
+ * rate; the whole sound is rendered into a module-owned buffer that the
+ * host copies out.
+ *
+ * Envelope times in a patch are frames at 44.1 kHz and are stretched to the
+ * render rate, so a patch has the same length and pitch whatever the sample
+ * rate. Noise is seeded the same way on every render: a patch always renders
+ * to the same PCM, which is what lets the host cache renders by content hash.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+// Frames per render pass. Renders are a whole number of passes, and every
+// downsampling factor of the distortion stage divides it.
+#define RENDER_CHUNK 1200
+
+// Longest sound rendered, however long a patch's envelopes are
+#define MAX_RENDER_SECONDS 30.0f
+
+#define MAX_PATCH_ENTRIES 128
+#define MAX_ENVELOPE_POINTS 32
+
+// Patch times and levels are defined at this rate and in 16-bit units
+#define PATCH_SAMPLE_RATE 44100.0f
+#define PATCH_FULL_SCALE 32768.0f
+#define PATCH_CLIP_LEVEL 32700.0f
+
+#define TWO_PI 6.28318530717958647692
+
+// ============================================================================
+// Patch parsing
+// ============================================================================
+
+typedef struct {
+    const char* section;
+    int sectionLength;
+    const char* key;
+    int keyLength;
+    const char* value;
+    int valueLength;
+} PatchEntry;
+
+typedef struct {
+    PatchEntry entries[MAX_PATCH_ENTRIES];
+    int count;
+} Patch;
+
+static int isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static int namesEqual(const char* a, int length, const char* name) {
+    for (int i = 0; i < length; i++) {
+        char c = a[i];
+        char n = name[i];
+        if (n == '\0') return 0;
+        if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+        if (n >= 'A' && n <= 'Z') n += 'a' - 'A';
+        if (c != n) return 0;
+    }
+    return name[length] == '\0';
+}
+
+/**
+ * Index the [section] key=value lines of a patch. Entries point into text.
+ */
+static void patchParse(Patch* patch, const char* text, int length) {
+    const char* section = "";
+    int sectionLength = 0;
+    patch->count = 0;
+
+    for (int pos = 0; pos < length && patch->count < MAX_PATCH_ENTRIES;) {
+        int end = pos;
+        while (end < length && text[end] != '\n') end++;
+
+        int start = pos;
+        int stop = end;
+        while (start < stop && isBlank(text[start])) start++;
+        while (stop > start && isBlank(text[stop - 1])) stop--;
+        pos = end + 1;
+
+        if (start == stop || text[start] == ';') continue;
+
+        if (text[start] == '[') {
+            int close = start + 1;
+            while (close < stop && text[close] != ']') close++;
+            section = text + start + 1;
+            sectionLength = close - start - 1;
+            continue;
+        }
+
+        int equals = start;
+        while (equals < stop && text[equals] != '=') equals++;
+        if (equals == stop) continue;
+
+        int keyStop = equals;
+        while (keyStop > start && isBlank(text[keyStop - 1])) keyStop--;
+        int valueStart = equals + 1;
+        while (valueStart < stop && isBlank(text[valueStart])) valueStart++;
+
+        PatchEntry* entry = &patch->entries[patch->count++];
+        entry->section = section;
+        entry->sectionLength = sectionLength;
+        entry->key = text + start;
+        entry->keyLength = keyStop - start;
+        entry->value = text + valueStart;
+        entry->valueLength = stop - valueStart;
+    }
+}
+
+/**
+ * Value of a key (section and key names are case-insensitive), or NULL
+ */
+static const PatchEntry* patchFind(const Patch* patch, const char* section, const char* key) {
+    for (int i = 0; i < patch->count; i++) {
+        const PatchEntry* entry = &patch->entries[i];
+        if (namesEqual(entry->section, entry->sectionLength, section) &&
+            namesEqual(entry->key, entry->keyLength, key)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Copy an entry's value into a NUL-terminated buffer
+ */
+static void entryValue(const PatchEntry* entry, char* buffer, int size) {
+    int length = entry->valueLength < size - 1 ? entry->valueLength : size - 1;
+    memcpy(buffer, entry->value, length);
+    buffer[length] = '\0';
+}
+
+static float patchFloat(const Patch* patch, const char* section, const char* key, float fallback) {
+    const PatchEntry* entry = patchFind(patch, section, key);
+    if (!entry) return fallback;
+
+    char buffer[32];
+    entryValue(entry, buffer, sizeof(buffer));
+    char* end;
+    float value = strtof(buffer, &end);
+    return end == buffer ? fallback : value;
+}
+
+static int patchInt(const Patch* patch, const char* section, const char* key, int fallback) {
+    return (int)patchFloat(patch, section, key, (float)fallback);
+}
+
+/**
+ * Whether the text is a DrumSynth 1.x or 2.x patch
+ */
+static int patchIsDrumSynth(const Patch* patch) {
+    const PatchEntry* entry = patchFind(patch, "General", "Version");
+    if (!entry) return 0;
+
+    char version[32];
+    entryValue(entry, version, sizeof(version));
+    return strncmp(version, "DrumSynth v", 11) == 0 && (version[11] == '1' || version[11] == '2');
+}
+
+// ============================================================================
+// Envelopes
+// ============================================================================
+
+/**
+ * Piecewise-linear envelope through "time,level time,level ..." points,
+ * levels 0-100. Times are in frames once stretched to the render rate.
+ */
+typedef struct {
+    float time[MAX_ENVELOPE_POINTS];
+    float level[MAX_ENVELOPE_POINTS];
+    int count;
+    int point;   // Index of the segment's start point
+    float next;  // Frame where the next segment starts
+    float value;
+    float delta; // Per-frame change along the current segment
+} Envelope;
+
+static void envelopeParse(Envelope* env, const Patch* patch, const char* section, const char* key, float stretch) {
+    char buffer[512];
+    const PatchEntry* entry = patchFind(patch, section, key);
+    if (entry) {
+        entryValue(entry, buffer, sizeof(buffer));
+    } else {
+        strcpy(buffer, "0,0 100,0");
+    }
+
+    env->count = 0;
+    char* cursor = buffer;
+    while (*cursor && env->count < MAX_ENVELOPE_POINTS) {
+        char* end;
+        float time = strtof(cursor, &end);
+        if (end == cursor || *end != ',') break;
+        cursor = end + 1;
+        float level = strtof(cursor, &end);
+        if (end == cursor) level = 0.0f;
+
+        env->time[env->count] = time * stretch;
+        env->level[env->count] = level * 0.01f;
+        env->count++;
+
+        cursor = end;
+        while (*cursor == ' ') cursor++;
+    }
+    if (env->count == 0) {
+        env->time[0] = 0.0f;
+        env->level[0] = 0.0f;
+        env->count = 1;
+    }
+
+    env->point = 0;
+    env->next = 0.0f;
+    env->value = 0.0f;
+    env->delta = 0.0f;
+}
+
+/**
+ * Frame of the envelope's last point
+ */
+static float envelopeEnd(const Envelope* env) {
+    return env->time[env->count - 1];
+}
+
+/**
+ * Start the next segment at frame t. After the last point the level holds.
+ */
+static void envelopeNextSegment(Envelope* env, float t) {
+    int last = env->count - 1;
+    int from = env->point < last ? env->point : last;
+    int to = from < last ? from + 1 : last;
+
+    env->value = env->level[from];
+    if (from == last) {
+        env->next = INFINITY;
+        env->delta = 0.0f;
+        return;
+    }
+
+    env->next = env->time[to];
+    float span = env->next - t;
+    env->delta = (env->level[to] - env->value) / (span < 1.0f ? 1.0f : span);
+    env->point++;
+}
+
+static inline float envelopeTick(Envelope* env, float t) {
+    if (t < env->next) {
+        env->value += env->delta;
+    } else {
+        envelopeNextSegment(env, t);
+    }
+    return env->value;
+}
+
+// ============================================================================
+// Sources
+// ============================================================================
+
+typedef enum {
+    ENV_TONE = 0,
+    ENV_NOISE,
+    ENV_OVERTONE1,
+    ENV_OVERTONE2,
+    ENV_BAND1,
+    ENV_BAND2,
+    ENV_FILTER,
+    NUM_ENVELOPES
+} EnvelopeIndex;
+
+typedef enum {
+    OVERTONE_ADD = 0,
+    OVERTONE_FM,
+    OVERTONE_RING,
+    OVERTONE_CYMBAL
+} OvertoneMethod;
+
+typedef enum {
+    FILTER_OFF = 0,
+    FILTER_OVERTONES,
+    FILTER_ALL
+} FilterMode;
+
+// TR-808 cymbal oscillator frequencies relative to the lowest (205.3 Hz)
+static const float cymbalRatios[6] = { 1.0f, 1.4827f, 1.8003f, 2.5460f, 2.6303f, 3.8968f };
+
+// Frames averaged together by the distortion stage, by its Rate setting
+static const int downsampleSteps[7] = { 1, 2, 3, 4, 8, 10, 20 };
+
+/**
+ * Band-limited noise: a sine whose frequency takes a random step every
+ * `hold` frames
+ */
+typedef struct {
+    int on;
+    float level;
+    double phase;
+    float increment;
+    float spread;
+    float offset;
+    int hold;
+} NoiseBand;
+
+typedef struct {
+    // Tone
+    int toneOn;
+    float toneLevel;
+    double tonePhase;
+    float toneStart;    // Phase increment at frame 0
+    float toneEnd;      // Phase increment the tone falls towards
+    float toneSweep;
+    float droopRate;    // Exponential pitch droop per frame, 0 for a linear sweep
+
+    // Noise, through a slope filter
+    int noiseOn;
+    float noiseLevel;
+    float slopeA, slopeB, slopeC, slopeD;
+    float noiseHistory[2];
+    float noiseOut;
+    unsigned int seed;
+
+    // Overtones
+    int overtoneOn;
+    float overtoneLevel;
+    OvertoneMethod method;
+    int wave1, wave2;
+    int track1, track2;   // Follow the tone's phase (increments are then ratios)
+    float increment1, increment2;
+    double phase1, phase2;
+    double trackPhase;
+    float balance1, balance2;
+    float drive;
+    float cymbalPhase[6];
+    float cymbalLow, cymbalBand; // Band-pass state
+
+    NoiseBand bands[2];
+
+    // Filter
+    FilterMode filter;
+    int highPass;
+    float resonance;
+    float filterIn, filterOut;
+
+    // Distortion
+    int distortionOn;
+    float gain;
+    float quantum;
+    float clip;
+    int downsample;
+
+    Envelope env[NUM_ENVELOPES];
+} DrumSynth;
+
+/**
+ * Uniform random number in [0, 1)
+ */
+static inline float randomUnit(unsigned int* seed) {
+    *seed = *seed * 1664525u + 1013904223u;
+    return (float)(*seed >> 8) * (1.0f / 16777216.0f);
+}
+
+static inline float waveform(double phase, int wave) {
+    float p = (float)(phase - TWO_PI * floor(phase / TWO_PI));
+    switch (wave) {
+        case 0: // Sine
+            return sinf(p);
+        case 1: // Rectified sine
+            return fabsf(2.0f * sinf(0.5f * p)) - 1.0f;
+        case 2: { // Triangle
+            float w = 0.63661977f * p - 1.0f;
+            return w > 1.0f ? 2.0f - w : w;
+        }
+        case 3: // Saw
+            return 0.31830989f * p - 1.0f;
+        default: // Square
+            return p > 0.0f && p < (float)(TWO_PI / 2.0) ? 1.0f : -1.0f;
+    }
+}
+
+/**
+ * Keep a phase in [0, 2 pi) as it advances by less than a cycle per frame
+ */
+static inline double wrapPhase(double phase) {
+    if (phase >= TWO_PI) return phase - TWO_PI;
+    if (phase < 0.0) return phase + TWO_PI;
+    return phase;
+}
+
+/**
+ * Level slider (0-200) to amplitude in 16-bit units
+ */
+static float sliderLevel(const Patch* patch, const char* section) {
+    float level = (float)patchInt(patch, section, "Level", 128);
+    return level * level;
+}
+
+static void setupNoiseBand(NoiseBand* band, const Patch* patch, const char* section, float tune, float rateRatio) {
+    band->on = patchInt(patch, section, "On", 0);
+    band->level = sliderLevel(patch, section);
+    band->phase = TWO_PI / 8.0;
+
+    // Width and random step rate are defined per frame at the patch rate
+    float frequency = tune * (float)TWO_PI * patchFloat(patch, section, "F", 1000.0f) / PATCH_SAMPLE_RATE;
+    float width = (float)patchInt(patch, section, "dF", 50);
+    float spread = width * width / (10000.0f - 6600.0f * (sqrtf(frequency) - 0.19f));
+    int hold = 1 + (int)((40.0f - width / 2.5f) / (spread + 1.0f + frequency));
+
+    band->increment = frequency / rateRatio;
+    band->spread = spread / rateRatio;
+    band->offset = 0.0f;
+    band->hold = (int)(hold * rateRatio + 0.5f);
+    if (band->hold < 1) band->hold = 1;
+}
+
+/**
+ * Read a parsed patch
+ */
+static void drumSynthSetup(DrumSynth* ds, const Patch* patch, float sampleRate) {
+    memset(ds, 0, sizeof(DrumSynth));
+    float rateRatio = sampleRate / PATCH_SAMPLE_RATE;
+
+    // General
+    float tune = powf(1.0594631f, patchFloat(patch, "General", "Tuning", 0.0f));
+    float stretch = 0.01f * patchFloat(patch, "General", "Stretch", 100.0f);
+    if (stretch < 0.2f) stretch = 0.2f;
+    if (stretch > 10.0f) stretch = 10.0f;
+    stretch *= rateRatio;
+
+    ds->gain = powf(10.0f, 0.05f * patchFloat(patch, "General", "Level", 0.0f));
+    ds->filter = patchInt(patch, "General", "Filter", 0) ? FILTER_ALL : FILTER_OFF;
+    ds->highPass = patchInt(patch, "General", "HighPass", 0) != 0;
+    ds->resonance = 0.0101f * patchFloat(patch, "General", "Resonance", 0.0f);
+    envelopeParse(&ds->env[ENV_FILTER], patch, "General", "FilterEnv", stretch);
+
+    // Tone
+    ds->toneOn = patchInt(patch, "Tone", "On", 0);
+    ds->toneLevel = sliderLevel(patch, "Tone");
+    envelopeParse(&ds->env[ENV_TONE], patch, "Tone", "Envelope", stretch);
+    float toneLength = envelopeEnd(&ds->env[ENV_TONE]);
+    if (toneLength < 1.0f) toneLength = 1.0f;
+
+    float f1 = tune * (float)TWO_PI * patchFloat(patch, "Tone", "F1", 200.0f) / sampleRate;
+    if (fabsf(f1) < 0.001f) f1 = 0.001f; // Overtones tracking the tone divide by it
+    float f2 = tune * (float)TWO_PI * patchFloat(patch, "Tone", "F2", 120.0f) / sampleRate;
+    float droop = patchFloat(patch, "Tone", "Droop", 0.0f);
+    ds->toneStart = f1;
+    if (droop > 0.0f) {
+        // Falls exponentially from f1 and reaches f2 at the end of the envelope
+        ds->droopRate = powf(10.0f, (droop - 20.0f) / 30.0f) * -4.0f / toneLength;
+        ds->toneEnd = f1 + (f2 - f1) / (1.0f - expf(ds->droopRate * toneLength));
+        ds->toneSweep = f1 - ds->toneEnd;
+    } else {
+        ds->toneEnd = f2;
+        ds->toneSweep = (f2 - f1) / toneLength;
+    }
+    ds->tonePhase = patchFloat(patch, "Tone", "Phase", 90.0f) / 57.29578f;
+
+    // Noise
+    ds->noiseOn = patchInt(patch, "Noise", "On", 0);
+    ds->noiseLevel = sliderLevel(patch, "Noise");
+    envelopeParse(&ds->env[ENV_NOISE], patch, "Noise", "Envelope", stretch);
+    int slope = patchInt(patch, "Noise", "Slope", 0);
+    if (slope < 0) {
+        // One-pole lowpass
+        ds->slopeA = 1.0f + slope / 105.0f;
+        ds->slopeD = -slope / 105.0f;
+        ds->noiseLevel *= 1.0f + 0.0005f * slope * slope;
+    } else {
+        // Second-order difference, brighter as the slope grows
+        ds->slopeA = 1.0f;
+        ds->slopeB = -slope / 50.0f;
+        ds->slopeC = slope / 100.0f;
+    }
+    ds->seed = 1;
+
+    // Overtones
+    ds->overtoneOn = patchInt(patch, "Overtones", "On", 0);
+    ds->overtoneLevel = sliderLevel(patch, "Overtones");
+    envelopeParse(&ds->env[ENV_OVERTONE1], patch, "Overtones", "Envelope1", stretch);
+    envelopeParse(&ds->env[ENV_OVERTONE2], patch, "Overtones", "Envelope2", stretch);
+    ds->method = (OvertoneMethod)patchInt(patch, "Overtones", "Method", OVERTONE_RING);
+    if (ds->method < OVERTONE_ADD || ds->method > OVERTONE_CYMBAL) ds->method = OVERTONE_ADD;
+    ds->wave1 = patchInt(patch, "Overtones", "Wave1", 0);
+    ds->wave2 = patchInt(patch, "Overtones", "Wave2", 0);
+    ds->increment1 = tune * (float)TWO_PI * patchFloat(patch, "Overtones", "F1", 200.0f) / sampleRate;
+    ds->increment2 = tune * (float)TWO_PI * patchFloat(patch, "Overtones", "F2", 120.0f) / sampleRate;
+    ds->track1 = patchInt(patch, "Overtones", "Track1", 0) == 1;
+    ds->track2 = patchInt(patch, "Overtones", "Track2", 0) == 1;
+    if (ds->track1) ds->increment1 /= f1;
+    if (ds->track2) ds->increment2 /= f1;
+    float param = (float)patchInt(patch, "Overtones", "Param", 50);
+    ds->drive = param * param * param / (50.0f * 50.0f * 50.0f);
+    ds->balance2 = param * 0.01f;
+    ds->balance1 = 1.0f - ds->balance2;
+    ds->phase1 = ds->tonePhase;
+    ds->phase2 = ds->tonePhase;
+    ds->trackPhase = ds->tonePhase;
+    if (ds->filter == FILTER_OFF && patchInt(patch, "Overtones", "Filter", 0)) {
+        ds->filter = FILTER_OVERTONES;
+    }
+
+    // Noise bands
+    setupNoiseBand(&ds->bands[0], patch, "NoiseBand", tune, rateRatio);
+    setupNoiseBand(&ds->bands[1], patch, "NoiseBand2", tune, rateRatio);
+    envelopeParse(&ds->env[ENV_BAND1], patch, "NoiseBand", "Envelope", stretch);
+    envelopeParse(&ds->env[ENV_BAND2], patch, "NoiseBand2", "Envelope", stretch);
+
+    // Distortion: clip at the loudest source, quantize to 16 - 2 * Bits bits
+    ds->distortionOn = patchInt(patch, "Distortion", "On", 0);
+    int rate = patchInt(patch, "Distortion", "Rate", 0);
+    ds->downsample = downsampleSteps[rate < 0 ? 0 : rate > 6 ? 6 : rate];
+    ds->clip = PATCH_CLIP_LEVEL;
+    ds->quantum = 1.0f;
+    if (ds->distortionOn) {
+        float loudest = 0.0f;
+        if (ds->toneOn && ds->toneLevel > loudest) loudest = ds->toneLevel;
+        if (ds->noiseOn && ds->noiseLevel > loudest) loudest = ds->noiseLevel;
+        if (ds->overtoneOn && ds->overtoneLevel > loudest) loudest = ds->overtoneLevel;
+        if (ds->bands[0].on && ds->bands[0].level > loudest) loudest = ds->bands[0].level;
+        loudest *= ds->gain;
+        if (loudest < ds->clip) ds->clip = loudest;
+
+        ds->quantum = powf(2.0f, 2.0f * patchInt(patch, "Distortion", "Bits", 0));
+        ds->gain *= powf(10.0f, 0.05f * patchInt(patch, "Distortion", "Clipping", 0));
+    }
+}
+
+/**
+ * Frames to render: the longest envelope of a source that is on, plus a
+ * tail, in whole render chunks
+ */
+static int drumSynthLength(const DrumSynth* ds, float sampleRate) {
+    float longest = 0.0f;
+    if (ds->toneOn) longest = fmaxf(longest, envelopeEnd(&ds->env[ENV_TONE]));
+    if (ds->noiseOn) longest = fmaxf(longest, envelopeEnd(&ds->env[ENV_NOISE]));
+    if (ds->overtoneOn) {
+        longest = fmaxf(longest, envelopeEnd(&ds->env[ENV_OVERTONE1]));
+        longest = fmaxf(longest, envelopeEnd(&ds->env[ENV_OVERTONE2]));
+    }
+    if (ds->bands[0].on) longest = fmaxf(longest, envelopeEnd(&ds->env[ENV_BAND1]));
+    if (ds->bands[1].on) longest = fmaxf(longest, envelopeEnd(&ds->env[ENV_BAND2]));
+
+    float limit = MAX_RENDER_SECONDS * sampleRate;
+    if (longest > limit) longest = limit;
+    return 2 * RENDER_CHUNK + RENDER_CHUNK * (int)(longest / RENDER_CHUNK);
+}
+
+static void renderNoise(DrumSynth* ds, float* out, int start, int frames) {
+    Envelope* env = &ds->env[ENV_NOISE];
+    float x1 = ds->noiseHistory[0];
+    float x2 = ds->noiseHistory[1];
+    float y = ds->noiseOut;
+
+    for (int i = 0; i < frames; i++) {
+        float level = envelopeTick(env, (float)(start + i));
+        float x0 = 2.0f * randomUnit(&ds->seed) - 1.0f;
+        y = ds->slopeA * x0 + ds->slopeB * x1 + ds->slopeC * x2 + ds->slopeD * y;
+        x2 = x1;
+        x1 = x0;
+        out[i] += y * ds->noiseLevel * level;
+    }
+
+    ds->noiseHistory[0] = x1;
+    ds->noiseHistory[1] = x2;
+    ds->noiseOut = y;
+}
+
+/**
+ * Tone phase increments for a chunk, which the overtones also follow
+ */
+static void toneIncrements(const DrumSynth* ds, float* increments, int start, int frames) {
+    if (ds->droopRate != 0.0f) {
+        double droop = exp((double)start * ds->droopRate);
+        double step = exp((double)ds->droopRate);
+        for (int i = 0; i < frames; i++) {
+            increments[i] = ds->toneEnd + ds->toneSweep * (float)droop;
+            droop *= step;
+        }
+    } else {
+        for (int i = 0; i < frames; i++) {
+            increments[i] = ds->toneStart + ds->toneSweep * (float)(start + i);
+        }
+    }
+}
+
+static void renderTone(DrumSynth* ds, float* out, const float* increments, int start, int frames) {
+    Envelope* env = &ds->env[ENV_TONE];
+    double phase = ds->tonePhase;
+
+    for (int i = 0; i < frames; i++) {
+        float level = envelopeTick(env, (float)(start + i));
+        phase = wrapPhase(phase + increments[i]);
+        out[i] += ds->toneLevel * level * sinf((float)phase);
+    }
+
+    ds->tonePhase = phase;
+}
+
+static void renderNoiseBand(NoiseBand* band, Envelope* env, unsigned int* seed, float* out, int start, int frames) {
+    for (int i = 0; i < frames; i++) {
+        int t = start + i;
+        float level = envelopeTick(env, (float)t);
+        if (t % band->hold == 0) band->offset = randomUnit(seed) - 0.5f;
+        band->phase = wrapPhase(band->phase + band->increment + band->spread * band->offset);
+        out[i] += cosf((float)band->phase) * level * band->level;
+    }
+}
+
+/**
+ * One overtone sample. Envelopes stop at their last point.
+ */
+static inline float overtoneSample(DrumSynth* ds, float increment, float t) {
+    Envelope* env1 = &ds->env[ENV_OVERTONE1];
+    Envelope* env2 = &ds->env[ENV_OVERTONE2];
+    float level1 = t < envelopeEnd(env1) ? envelopeTick(env1, t) : 0.0f;
+    float level2 = t < envelopeEnd(env2) ? envelopeTick(env2, t) : 0.0f;
+
+    ds->trackPhase += increment;
+    ds->phase1 = ds->track1 ? ds->trackPhase * ds->increment1 : ds->phase1 + ds->increment1;
+    ds->phase2 = ds->track2 ? ds->trackPhase * ds->increment2 : ds->phase2 + ds->increment2;
+
+    switch (ds->method) {
+        case OVERTONE_ADD:
+            return ds->overtoneLevel * (ds->balance1 * level1 * waveform(ds->phase1, ds->wave1) +
+                                        ds->balance2 * level2 * waveform(ds->phase2, ds->wave2));
+        case OVERTONE_FM: {
+            float modulator = ds->drive * level2 * waveform(ds->phase2, ds->wave2);
+            return ds->overtoneLevel * level1 * waveform(ds->phase1 + modulator, ds->wave1);
+        }
+        case OVERTONE_RING: {
+            float depth = ds->drive / 8.0f;
+            float modulator = (1.0f - depth) + depth * level2 * waveform(ds->phase2, ds->wave2);
+            return ds->overtoneLevel * level1 * waveform(ds->phase1, ds->wave1) * modulator;
+        }
+        default: {
+            // Six square oscillators at the 808's cymbal ratios from F1, through
+            // a band-pass at F2 swept by envelope 2
+            float sum = 0.0f;
+            for (int j = 0; j < 6; j++) {
+                float phase = ds->cymbalPhase[j] + ds->increment1 * cymbalRatios[j] * (float)(1.0 / TWO_PI);
+                phase -= (float)(int)phase;
+                ds->cymbalPhase[j] = phase;
+                sum += phase < 0.5f ? 1.0f : -1.0f;
+            }
+            // Trapezoidal state-variable filter, stable at any cutoff
+            float g = tanf(0.5f * fminf(ds->increment2 * (0.25f + level2), 3.0f));
+            float damping = 2.0f - 1.9f * (ds->balance2 < 1.0f ? ds->balance2 : 1.0f);
+            float high = (sum - (damping + g) * ds->cymbalBand - ds->cymbalLow) / (1.0f + g * (damping + g));
+            float band = g * high + ds->cymbalBand;
+            ds->cymbalBand = g * high + band;
+            float low = g * band + ds->cymbalLow;
+            ds->cymbalLow = g * band + low;
+            return ds->overtoneLevel * level1 * band * (1.0f / 6.0f);
+        }
+    }
+}
+
+/**
+ * Resonant lowpass with a cutoff following the filter envelope. Returns the
+ * filtered sample, or the difference from the input with HighPass set.
+ */
+static inline float filterSample(DrumSynth* ds, float input, float t) {
+    float cutoff = envelopeTick(&ds->env[ENV_FILTER], t);
+    float feedback = cutoff > 0.2f ? 1.001f - exp2f(3.3219281f * (cutoff - 1.0f)) : 0.999f - 0.7824f * cutoff;
+    float x = input + ds->resonance * (1.0f + 1.0f / feedback) * (ds->filterIn - ds->filterOut);
+    ds->filterIn = feedback * (ds->filterIn - x) + x;
+    ds->filterOut = feedback * (ds->filterOut - ds->filterIn) + ds->filterIn;
+    return ds->filterOut - (ds->highPass ? input : 0.0f);
+}
+
+/**
+ * Filter, distort and clip a chunk into the output, normalized to +-1
+ */
+static void finishChunk(DrumSynth* ds, float* mix, const float* overtones, float* out, int start, int frames) {
+    for (int i = 0; i < frames; i++) {
+        float t = (float)(start + i);
+        if (ds->filter == FILTER_OVERTONES) {
+            mix[i] += filterSample(ds, overtones[i], t);
+        } else if (ds->filter == FILTER_ALL) {
+            mix[i] = filterSample(ds, mix[i] + overtones[i], t);
+        } else {
+            mix[i] += overtones[i];
+        }
+    }
+
+    if (ds->distortionOn) {
+        for (int i = 0; i < frames; i++) {
+            mix[i] = ds->gain * ds->quantum * (float)(int)(mix[i] / ds->quantum);
+        }
+        for (int i = 0; i < frames; i += ds->downsample) {
+            float sum = 0.0f;
+            for (int j = i; j < i + ds->downsample; j++) sum += mix[j];
+            for (int j = i; j < i + ds->downsample; j++) mix[j] = sum / ds->downsample;
+        }
+    } else {
+        for (int i = 0; i < frames; i++) mix[i] *= ds->gain;
+    }
+
+    for (int i = 0; i < frames; i++) {
+        float s = mix[i];
+        if (s > ds->clip) s = ds->clip;
+        if (s < -ds->clip) s = -ds->clip;
+        out[i] = s * (1.0f / PATCH_FULL_SCALE);
+    }
+}
+
+static void drumSynthRender(DrumSynth* ds, float* out, int length) {
+    float mix[RENDER_CHUNK];
+    float overtones[RENDER_CHUNK];
+    float increments[RENDER_CHUNK];
+
+    for (int start = 0; start < length; start += RENDER_CHUNK) {
+        memset(mix, 0, sizeof(mix));
+        memset(overtones, 0, sizeof(overtones));
+
+        // A source stops after the chunk its envelope ends in
+        if (ds->noiseOn) {
+            renderNoise(ds, mix, start, RENDER_CHUNK);
+            if (start + RENDER_CHUNK >= envelopeEnd(&ds->env[ENV_NOISE])) ds->noiseOn = 0;
+        }
+
+        if (ds->toneOn) {
+            toneIncrements(ds, increments, start, RENDER_CHUNK);
+            renderTone(ds, mix, increments, start, RENDER_CHUNK);
+            if (start + RENDER_CHUNK >= envelopeEnd(&ds->env[ENV_TONE])) ds->toneOn = 0;
+        } else {
+            for (int i = 0; i < RENDER_CHUNK; i++) increments[i] = ds->toneEnd;
+        }
+
+        for (int b = 0; b < 2; b++) {
+            NoiseBand* band = &ds->bands[b];
+            if (!band->on) continue;
+            Envelope* env = &ds->env[ENV_BAND1 + b];
+            renderNoiseBand(band, env, &ds->seed, mix, start, RENDER_CHUNK);
+            if (start + RENDER_CHUNK >= envelopeEnd(env)) band->on = 0;
+        }
+
+        if (ds->overtoneOn) {
+            for (int i = 0; i < RENDER_CHUNK; i++) {
+                overtones[i] = overtoneSample(ds, increments[i], (float)(start + i));
+            }
+        }
+
+        finishChunk(ds, mix, overtones, out + start, start, RENDER_CHUNK);
+    }
+}
+
+// ============================================================================
+// Exported functions
+// ============================================================================
+
+static float* renderOutput = NULL;
+static int renderCapacity = 0;
+
+/**
+ * Render a patch (length bytes of .ds text, not necessarily NUL-terminated)
+ * at sampleRate. Returns the number of mono frames rendered into
+ * getRenderOutput(), or 0 if the text is not a DrumSynth patch or the
+ * output could not be allocated.
+ */
+int renderPatch(const char* text, int length, float sampleRate) {
+    static Patch patch;
+    static DrumSynth ds;
+
+    if (!text || length <= 0 || !(sampleRate > 0.0f)) return 0;
+
+    patchParse(&patch, text, length);
+    if (!patchIsDrumSynth(&patch)) return 0;
+
+    drumSynthSetup(&ds, &patch, sampleRate);
+    int frames = drumSynthLength(&ds, sampleRate);
+
+    if (frames > renderCapacity) {
+        float* grown = (float*)realloc(renderOutput, (size_t)frames * sizeof(float));
+        if (!grown) return 0;
+        renderOutput = grown;
+        renderCapacity = frames;
+    }
+
+    drumSynthRender(&ds, renderOutput, frames);
+    return frames;
+}
+
+/**
+ * Output of the last renderPatch(), valid until the next call
+ */
+float* getRenderOutput() {
+    return renderOutput;
+}
+
+/**
+ * Free the output buffer, e.g. after rendering a whole library
+ */
+void releaseRender() {
+    free(renderOutput);
+    renderOutput = NULL;
+    renderCapacity = 0;
+}
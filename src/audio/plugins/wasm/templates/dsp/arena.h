@@ -0,0 +1,73 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Init-time bump allocator
+ *
+ * A plugin sizes and allocates one block of memory in init() and carves all
+ * of its buffers out of it, so nothing is allocated or freed while audio is
+ * running and the buffers end up close together in WASM memory.
+ *
+ * heapBlockBytes() bounds what each such block takes from the heap, so a
+ * plugin can report its whole footprint up front (getRequiredMemory()) and
+ * the host can size WASM memory before the instance is created.
+ */
+
+#ifndef ANKH_DSP_ARENA_H
+#define ANKH_DSP_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "simd.h"
+
+typedef struct {
+    uint8_t* base;
+    size_t size;
+    size_t used;
+} Arena;
+
+/**
+ * Bytes an allocation occupies once rounded up to SIMD_ALIGN
+ */
+static inline size_t arenaAlignedSize(size_t bytes) {
+    return (bytes + SIMD_ALIGN - 1) & ~(size_t)(SIMD_ALIGN - 1);
+}
+
+/**
+ * Heap bytes aligned_alloc(SIMD_ALIGN, bytes) can take, the allocator's
+ * header and alignment padding included (an upper bound)
+ */
+static inline size_t heapBlockBytes(size_t bytes) {
+    return arenaAlignedSize(bytes) + 2 * SIMD_ALIGN;
+}
+
+/**
+ * Use memory (SIMD_ALIGN-aligned, e.g. from malloc) as the arena
+ */
+static inline void arenaInit(Arena* arena, void* memory, size_t size) {
+    arena->base = (uint8_t*)memory;
+    arena->size = memory ? size : 0;
+    arena->used = 0;
+}
+
+/**
+ * Take bytes from the arena, SIMD_ALIGN aligned. Returns NULL when exhausted.
+ */
+static inline void* arenaAlloc(Arena* arena, size_t bytes) {
+    size_t aligned = arenaAlignedSize(bytes);
+    if (!arena->base || aligned > arena->size - arena->used) return NULL;
+
+    void* p = arena->base + arena->used;
+    arena->used += aligned;
+    return p;
+}
+
+/**
+ * Release everything at once (the memory itself stays owned by the caller)
+ */
+static inline void arenaReset(Arena* arena) {
+    arena->used = 0;
+}
+
+#endif // ANKH_DSP_ARENA_H
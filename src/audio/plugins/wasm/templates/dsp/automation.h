@@ -0,0 +1,117 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Automation curves evaluated inside the plugin
+ *
+ * Instead of streaming setParameter() calls, the host writes the breakpoints
+ * of a parameter's automation for an upcoming window into the plugin once.
+ * The plugin evaluates the curve at every control block (see control.h) and
+ * ramps the parameter to the curve's value at the end of the block, so dense
+ * automation costs the host one upload per window and follows the curve at
+ * CONTROL_BLOCK_SIZE resolution rather than the host's block size.
+ *
+ * Curve shapes mirror AutomationPoint.curve in AutomationRecorder.ts: a
+ * point's curve and tension shape the segment arriving at it.
+ */
+
+#ifndef ANKH_DSP_AUTOMATION_H
+#define ANKH_DSP_AUTOMATION_H
+
+#include <stdint.h>
+#include <math.h>
+
+// Breakpoints per parameter and upload
+#define AUTOMATION_MAX_POINTS 64
+
+typedef enum {
+    CURVE_LINEAR = 0,
+    CURVE_SMOOTH,      // Smoothstep
+    CURVE_STEP,        // Holds the previous value until the point
+    CURVE_EXPONENTIAL, // t^(10^tension)
+    CURVE_BEZIER       // t^(1 / (tension + 1))
+} AutomationCurve;
+
+/**
+ * Breakpoint written by the host (32-bit fields, in this order)
+ */
+typedef struct {
+    int32_t frame;  // Frames after the first frame processed after the upload
+    float value;    // Parameter value, in the parameter's own range
+    int32_t curve;  // AutomationCurve of the segment ending here
+    float tension;  // -1 to 1, for exponential and bezier curves
+} AutomationPoint;
+
+typedef struct {
+    AutomationPoint points[AUTOMATION_MAX_POINTS]; // Sorted by frame
+    int count;    // 0 while the parameter is not automated
+    int next;     // First point at or after position
+    int position; // Frame of the window the curve has been evaluated up to
+} AutomationLane;
+
+/**
+ * Start evaluating the first count points of a lane. position is the frame
+ * of the window at the next control block boundary.
+ */
+static inline void automationLaneStart(AutomationLane* lane, int count, int position) {
+    if (count > AUTOMATION_MAX_POINTS) count = AUTOMATION_MAX_POINTS;
+    lane->count = count > 0 ? count : 0;
+    lane->next = 0;
+    lane->position = position;
+}
+
+static inline void automationLaneStop(AutomationLane* lane) {
+    lane->count = 0;
+}
+
+static inline int automationLaneActive(const AutomationLane* lane) {
+    return lane->count > 0;
+}
+
+/**
+ * Shape of a segment: how far (0-1) it has moved towards its end point at
+ * t (0-1) through it
+ */
+static inline float automationCurveShape(AutomationCurve curve, float tension, float t) {
+    switch (curve) {
+        case CURVE_SMOOTH:
+            return t * t * (3.0f - 2.0f * t);
+        case CURVE_STEP:
+            return t < 1.0f ? 0.0f : 1.0f;
+        case CURVE_EXPONENTIAL:
+            return fabsf(tension) > 0.001f ? powf(t, powf(10.0f, tension)) : t;
+        case CURVE_BEZIER: {
+            float pull = tension + 1.0f;
+            return powf(t, 1.0f / (pull > 0.01f ? pull : 0.01f));
+        }
+        case CURVE_LINEAR:
+        default:
+            return t;
+    }
+}
+
+/**
+ * Move a lane frames forward and return the curve's value there. Holds the
+ * first value before the first point and the last after the last point;
+ * once past the last point the lane stops itself, after returning its value.
+ */
+static inline float automationLaneAdvance(AutomationLane* lane, int frames) {
+    const AutomationPoint* points = lane->points;
+    int last = lane->count - 1;
+
+    lane->position += frames;
+    while (lane->next <= last && points[lane->next].frame < lane->position) lane->next++;
+
+    if (lane->next > last) {
+        lane->count = 0;
+        return points[last].value;
+    }
+    if (lane->next == 0) return points[0].value;
+
+    const AutomationPoint* from = &points[lane->next - 1];
+    const AutomationPoint* to = &points[lane->next];
+    float t = (float)(lane->position - from->frame) / (float)(to->frame - from->frame);
+    return from->value + (to->value - from->value) * automationCurveShape((AutomationCurve)to->curve, to->tension, t);
+}
+
+#endif // ANKH_DSP_AUTOMATION_H
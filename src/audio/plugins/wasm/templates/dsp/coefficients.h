@@ -0,0 +1,113 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Control-rate filter coefficients
+ *
+ * Filter coefficients are recomputed at most once every COEFF_UPDATE_INTERVAL
+ * samples, and only when their control input (usually a cutoff frequency)
+ * changed. Between updates the coefficient ramps linearly to the new target
+ * so modulation stays free of zipper noise. The interval is the control
+ * block (see control.h), so a ramp started at a boundary ends on the next.
+ */
+
+#ifndef ANKH_DSP_COEFFICIENTS_H
+#define ANKH_DSP_COEFFICIENTS_H
+
+#include <math.h>
+
+#include "simd.h"
+#include "control.h"
+
+#define COEFF_UPDATE_INTERVAL CONTROL_BLOCK_SIZE
+
+// ============================================================================
+// Coefficient Formulas
+// ============================================================================
+
+/**
+ * One-pole lowpass smoothing factor: dt / (RC + dt)
+ */
+static inline float onePoleLowpassCoeff(float cutoff, float sampleRate) {
+    float w = 2.0f * 3.14159265f * cutoff / sampleRate;
+    return w / (1.0f + w);
+}
+
+/**
+ * Chamberlin state variable filter frequency coefficient: 2 * sin(pi * fc / fs)
+ */
+static inline float svfCoeff(float cutoff, float sampleRate) {
+    return 2.0f * sinf(3.14159265f * cutoff / sampleRate);
+}
+
+/**
+ * svfCoeff() for four cutoffs at once; angleScale is pi / sampleRate
+ */
+static inline f32x4 svfCoeff4(f32x4 cutoff, f32x4 angleScale) {
+    return f32x4Mul(f32x4Splat(2.0f), f32x4SinPoly(f32x4Mul(cutoff, angleScale)));
+}
+
+// ============================================================================
+// Smoothed Coefficient
+// ============================================================================
+
+typedef struct {
+    float value;   // Coefficient for the next sample
+    float step;    // Per-sample increment while ramping
+    float target;  // Coefficient the ramp ends on
+    float source;  // Control input the target was computed from
+    int countdown; // Samples left in the current ramp
+} SmoothedCoeff;
+
+/**
+ * Jump straight to a coefficient without ramping
+ */
+static inline void smoothedCoeffReset(SmoothedCoeff* c, float source, float value) {
+    c->value = value;
+    c->step = 0.0f;
+    c->target = value;
+    c->source = source;
+    c->countdown = 0;
+}
+
+/**
+ * True if the coefficient has to be recomputed for this control input
+ */
+static inline int smoothedCoeffChanged(const SmoothedCoeff* c, float source) {
+    return c->source != source;
+}
+
+/**
+ * Ramp from the current value to a new target over COEFF_UPDATE_INTERVAL samples
+ */
+static inline void smoothedCoeffRampTo(SmoothedCoeff* c, float source, float target) {
+    c->source = source;
+    c->target = target;
+    c->step = (target - c->value) * (1.0f / COEFF_UPDATE_INTERVAL);
+    c->countdown = COEFF_UPDATE_INTERVAL;
+}
+
+/**
+ * Coefficient for the current sample; advances the ramp by one sample
+ */
+static inline float smoothedCoeffNext(SmoothedCoeff* c) {
+    float value = c->value;
+    if (c->countdown > 0) {
+        c->value += c->step;
+        if (--c->countdown == 0) c->value = c->target;
+    }
+    return value;
+}
+
+// ============================================================================
+// Vector Ramps
+// ============================================================================
+
+/**
+ * Per-sample step that takes `current` to `target` over `span` samples
+ */
+static inline f32x4 coeffRampStep4(f32x4 current, f32x4 target, int span) {
+    return f32x4Mul(f32x4Sub(target, current), f32x4Splat(1.0f / (float)span));
+}
+
+#endif // ANKH_DSP_COEFFICIENTS_H
@@ -0,0 +1,50 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Fixed control rate, independent of the host block size
+ *
+ * Control-rate work (parameter ramps, filter coefficients, envelope
+ * modulation) runs once every CONTROL_BLOCK_SIZE frames of the stream, and
+ * the DSP kernels run over the spans in between. A ControlClock carries the
+ * position within the current control block from one process() call to the
+ * next, so a host calling with 128, 256 or 4096 frames, or a block split at
+ * an event, does the same control work at the same frames.
+ */
+
+#ifndef ANKH_DSP_CONTROL_H
+#define ANKH_DSP_CONTROL_H
+
+#define CONTROL_BLOCK_SIZE 32
+
+typedef struct {
+    int position; // Frames already rendered in the current control block
+} ControlClock;
+
+static inline void controlClockReset(ControlClock* clock) {
+    clock->position = 0;
+}
+
+/**
+ * True at the start of a control block, where its control work is due
+ */
+static inline int controlClockAtBoundary(const ControlClock* clock) {
+    return clock->position == 0;
+}
+
+/**
+ * Frames of `frames` that fit before the next control block boundary
+ */
+static inline int controlClockSpan(const ControlClock* clock, int frames) {
+    int left = CONTROL_BLOCK_SIZE - clock->position;
+    return frames < left ? frames : left;
+}
+
+/**
+ * Move the clock forward by any number of frames
+ */
+static inline void controlClockAdvance(ControlClock* clock, int frames) {
+    clock->position = (clock->position + frames) % CONTROL_BLOCK_SIZE;
+}
+
+#endif // ANKH_DSP_CONTROL_H
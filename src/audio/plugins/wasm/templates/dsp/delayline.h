@@ -0,0 +1,85 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Power-of-two ring-buffer delay line
+ *
+ * The buffer length is rounded up to a power of two so the read and write
+ * positions wrap with a mask instead of a modulo or a branch. Buffers come
+ * from an Arena at init time.
+ */
+
+#ifndef ANKH_DSP_DELAYLINE_H
+#define ANKH_DSP_DELAYLINE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "arena.h"
+
+typedef struct {
+    float* buffer;
+    uint32_t mask;     // Length - 1
+    uint32_t writePos; // Next slot to write
+} DelayLine;
+
+/**
+ * Buffer length for delays up to maxDelay samples, including the extra
+ * sample a fractional read at maxDelay needs
+ */
+static inline uint32_t delayLineLength(uint32_t maxDelay) {
+    uint32_t length = 1;
+    while (length < maxDelay + 2) length <<= 1;
+    return length;
+}
+
+/**
+ * Arena bytes needed by one delay line
+ */
+static inline size_t delayLineBytes(uint32_t maxDelay) {
+    return arenaAlignedSize(delayLineLength(maxDelay) * sizeof(float));
+}
+
+/**
+ * Allocate a cleared line from the arena. Returns 0 if the arena is too small.
+ */
+static inline int delayLineInit(DelayLine* line, Arena* arena, uint32_t maxDelay) {
+    uint32_t length = delayLineLength(maxDelay);
+    line->buffer = (float*)arenaAlloc(arena, length * sizeof(float));
+    line->mask = line->buffer ? length - 1 : 0;
+    line->writePos = 0;
+    if (!line->buffer) return 0;
+
+    memset(line->buffer, 0, length * sizeof(float));
+    return 1;
+}
+
+static inline void delayLineClear(DelayLine* line) {
+    if (line->buffer) memset(line->buffer, 0, (line->mask + 1) * sizeof(float));
+    line->writePos = 0;
+}
+
+static inline void delayLineWrite(DelayLine* line, float x) {
+    line->buffer[line->writePos] = x;
+    line->writePos = (line->writePos + 1) & line->mask;
+}
+
+/**
+ * Sample written delay samples ago (0 = the most recent write)
+ */
+static inline float delayLineRead(const DelayLine* line, uint32_t delay) {
+    return line->buffer[(line->writePos - 1 - delay) & line->mask];
+}
+
+/**
+ * Linearly interpolated read at a fractional delay
+ */
+static inline float delayLineReadFrac(const DelayLine* line, float delay) {
+    uint32_t whole = (uint32_t)delay;
+    float frac = delay - (float)whole;
+    float a = delayLineRead(line, whole);
+    float b = delayLineRead(line, whole + 1);
+    return a + (b - a) * frac;
+}
+
+#endif // ANKH_DSP_DELAYLINE_H
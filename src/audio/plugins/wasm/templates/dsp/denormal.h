@@ -0,0 +1,48 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Denormal protection for recursive state
+ *
+ * Filter and envelope state decaying toward zero eventually passes through
+ * subnormal floats, which take a slow path on x86 CPUs. WASM has no
+ * flush-to-zero mode, so plugins flush their state instead: once per block,
+ * anything below DENORMAL_THRESHOLD is set to exactly zero. Flushing at
+ * block rate keeps the per-sample loops untouched: a fast decay may still
+ * cross the subnormal range within a block, but the slow decays that would
+ * linger there for thousands of samples are cut off.
+ */
+
+#ifndef ANKH_DSP_DENORMAL_H
+#define ANKH_DSP_DENORMAL_H
+
+#include "simd.h"
+
+// About -300 dBFS, well above FLT_MIN (1.2e-38)
+#define DENORMAL_THRESHOLD 1e-15f
+
+/**
+ * value, or 0 if it is below DENORMAL_THRESHOLD
+ */
+static inline float flushDenormal(float value) {
+    return (value < DENORMAL_THRESHOLD && value > -DENORMAL_THRESHOLD) ? 0.0f : value;
+}
+
+/**
+ * Flush an array of state values in place
+ */
+static inline void flushDenormals(float* state, int count) {
+    for (int i = 0; i < count; i++) {
+        state[i] = flushDenormal(state[i]);
+    }
+}
+
+/**
+ * Per-lane flushDenormal()
+ */
+static inline f32x4 f32x4FlushDenormals(f32x4 v) {
+    m32x4 tiny = f32x4Lt(f32x4Abs(v), f32x4Splat(DENORMAL_THRESHOLD));
+    return f32x4Select(tiny, f32x4Splat(0.0f), v);
+}
+
+#endif // ANKH_DSP_DENORMAL_H
@@ -0,0 +1,90 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Precomputed ADSR segments
+ *
+ * Every stage is a one-pole segment, level = level * mul + add per sample
+ * (mul = 1 gives a linear ramp, add = 0 an exponential decay). Coefficients
+ * are computed once when the ADSR parameters change, and the number of
+ * samples until a segment reaches its target is solved up front, so a voice
+ * can render whole runs of a segment without per-sample stage checks.
+ */
+
+#ifndef ANKH_DSP_ENVELOPE_H
+#define ANKH_DSP_ENVELOPE_H
+
+#include <math.h>
+
+// Segment length for stages that never end on their own (sustain, off)
+#define ENVELOPE_FOREVER 0x3FFFFFFF
+
+// Release ends once the level falls below this
+#define ENVELOPE_RELEASE_FLOOR 0.001f
+
+typedef enum {
+    ENV_OFF = 0,
+    ENV_ATTACK,
+    ENV_DECAY,
+    ENV_SUSTAIN,
+    ENV_RELEASE,
+    ENV_NUM_STAGES
+} EnvelopeStage;
+
+typedef struct {
+    float mul;      // Per-sample level multiplier
+    float add;      // Per-sample level offset
+    float target;   // Level that ends the segment
+    float endLevel; // Level the envelope is set to when the segment ends
+    int hasTarget;  // 0 for stages that hold until released
+} EnvelopeSegment;
+
+typedef struct {
+    EnvelopeSegment segments[ENV_NUM_STAGES];
+} EnvelopeShape;
+
+/**
+ * Recompute all segments from ADSR times (seconds) and sustain level
+ */
+static inline void envelopeShapeUpdate(EnvelopeShape* shape, float attack, float decay,
+                                       float sustain, float release, float sampleRate) {
+    EnvelopeSegment off = { 0.0f, 0.0f, 0.0f, 0.0f, 0 };
+    EnvelopeSegment att = { 1.0f, 1.0f / (attack * sampleRate), 1.0f, 1.0f, 1 };
+    EnvelopeSegment dec = { 1.0f, -(1.0f - sustain) / (decay * sampleRate), sustain, sustain, 1 };
+    EnvelopeSegment sus = { 1.0f, 0.0f, sustain, sustain, 0 };
+    EnvelopeSegment rel = { 1.0f - 1.0f / (release * sampleRate), 0.0f, ENVELOPE_RELEASE_FLOOR, 0.0f, 1 };
+
+    shape->segments[ENV_OFF] = off;
+    shape->segments[ENV_ATTACK] = att;
+    shape->segments[ENV_DECAY] = dec;
+    shape->segments[ENV_SUSTAIN] = sus;
+    shape->segments[ENV_RELEASE] = rel;
+}
+
+/**
+ * Samples a segment runs from `level` until it reaches its target (at least 1)
+ */
+static inline int envelopeSegmentLength(const EnvelopeSegment* seg, float level) {
+    float samples;
+
+    if (!seg->hasTarget) return ENVELOPE_FOREVER;
+
+    if (seg->mul == 1.0f) {
+        // Linear: level + n * add crosses target
+        if (seg->add == 0.0f) return level == seg->target ? 1 : ENVELOPE_FOREVER;
+        samples = (seg->target - level) / seg->add;
+    } else {
+        // One-pole towards asymptote a: level_n = a + (level - a) * mul^n
+        float a = seg->add / (1.0f - seg->mul);
+        float ratio = (seg->target - a) / (level - a);
+        if (ratio >= 1.0f) return 1;
+        if (ratio <= 0.0f) return ENVELOPE_FOREVER;
+        samples = logf(ratio) / logf(seg->mul);
+    }
+
+    if (samples < 1.0f) return 1;
+    if (samples >= (float)ENVELOPE_FOREVER) return ENVELOPE_FOREVER;
+    return (int)ceilf(samples);
+}
+
+#endif // ANKH_DSP_ENVELOPE_H
@@ -0,0 +1,47 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Timestamped event buffer shared between host and plugin
+ *
+ * The host writes a packed array of TimedEvent (five int32 each, sorted by
+ * sampleOffset) into WASM memory and passes it to processWithEvents() with
+ * the audio block. The plugin renders up to each event's offset, applies the
+ * event and continues, giving sample-accurate timing with one call per block.
+ */
+
+#ifndef ANKH_DSP_EVENTS_H
+#define ANKH_DSP_EVENTS_H
+
+#include <stdint.h>
+
+#define MAX_EVENTS_PER_BLOCK 512
+
+typedef enum {
+    EVENT_NOTE_ON = 1,        // data1 = note, data2 = velocity
+    EVENT_NOTE_OFF = 2,       // data1 = note
+    EVENT_CONTROL_CHANGE = 3, // data1 = controller, data2 = value
+    EVENT_PITCH_BEND = 4      // data1 = 14-bit value (center 8192)
+} TimedEventType;
+
+typedef struct {
+    int32_t sampleOffset; // Frame within the block, 0..numSamples-1
+    int32_t type;         // TimedEventType
+    int32_t data1;
+    int32_t data2;
+    int32_t channel;
+} TimedEvent;
+
+/**
+ * Number of frames to render before the next event is due, starting at pos.
+ * Out-of-range or out-of-order offsets are clamped so rendering always
+ * makes progress.
+ */
+static inline int eventSpanEnd(const TimedEvent* events, int numEvents, int next, int pos, int numSamples) {
+    if (next >= numEvents) return numSamples;
+    int offset = events[next].sampleOffset;
+    if (offset <= pos) return pos;
+    return offset < numSamples ? offset : numSamples;
+}
+
+#endif // ANKH_DSP_EVENTS_H
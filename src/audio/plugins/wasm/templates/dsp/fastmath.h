@@ -0,0 +1,45 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Fast scalar approximations for control-rate math
+ *
+ * These replace libm calls that would otherwise be made on the audio path
+ * (each one is an import or a large function in a WASM build).
+ */
+
+#ifndef ANKH_DSP_FASTMATH_H
+#define ANKH_DSP_FASTMATH_H
+
+#include <stdint.h>
+#include <math.h>
+
+/**
+ * 2^x with a relative error below 3e-6 (about 0.005 cents as a pitch ratio)
+ */
+static inline float fastExp2(float x) {
+    if (x < -126.0f) x = -126.0f;
+    if (x > 126.0f) x = 126.0f;
+
+    // Split into integer exponent and fraction in [-0.5, 0.5)
+    float whole = floorf(x + 0.5f);
+    float f = x - whole;
+
+    // Taylor series of 2^f
+    float p = 1.0f + f * (0.69314718f + f * (0.24022651f + f * (0.05550411f +
+              f * (0.00961813f + f * 0.00133336f))));
+
+    union { float f; int32_t i; } bits;
+    bits.f = p;
+    bits.i += (int32_t)whole << 23;
+    return bits.f;
+}
+
+/**
+ * Frequency ratio for an offset in semitones
+ */
+static inline float semitonesToRatio(float semitones) {
+    return fastExp2(semitones * (1.0f / 12.0f));
+}
+
+#endif // ANKH_DSP_FASTMATH_H
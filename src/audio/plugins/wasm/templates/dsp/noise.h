@@ -0,0 +1,45 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Vectorized white noise
+ *
+ * Four independent xorshift32 streams, one per SIMD lane, so a voice group
+ * draws noise for all of its voices with a handful of integer vector ops
+ * and no voice shares (or correlates with) another voice's sequence.
+ */
+
+#ifndef ANKH_DSP_NOISE_H
+#define ANKH_DSP_NOISE_H
+
+#include <stdint.h>
+
+#include "simd.h"
+
+/**
+ * Non-zero seed for stream n, spread over the whole state space
+ */
+static inline uint32_t noiseSeed(uint32_t n) {
+    uint32_t x = (n + 1u) * 0x9E3779B9u;
+    x ^= x >> 16;
+    x *= 0x85EBCA6Bu;
+    x ^= x >> 13;
+    return x ? x : 0x6D2B79F5u;
+}
+
+/**
+ * Advance four xorshift32 streams and return one sample of each in [-1, 1)
+ */
+DSP_FORCE_INLINE f32x4 noiseNext4(u32x4* state) {
+    u32x4 x = *state;
+    x = u32x4Xor(x, u32x4Shl(x, 13));
+    x = u32x4Xor(x, u32x4Shr(x, 17));
+    x = u32x4Xor(x, u32x4Shl(x, 5));
+    *state = x;
+
+    // Top 23 bits as the mantissa of a float in [1, 2), then map to [-1, 1)
+    f32x4 unit = u32x4AsF32x4(u32x4Or(u32x4Shr(x, 9), u32x4Splat(0x3F800000u)));
+    return f32x4Sub(f32x4Add(unit, unit), f32x4Splat(3.0f));
+}
+
+#endif // ANKH_DSP_NOISE_H
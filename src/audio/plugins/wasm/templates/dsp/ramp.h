@@ -0,0 +1,47 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Linear parameter ramps
+ *
+ * The host sets a target and a duration once instead of streaming many
+ * setParameter() calls. Plugins advance active ramps once per control block
+ * (see control.h) and interpolate within it from the start and end values;
+ * a parameter that is not ramping is never touched.
+ */
+
+#ifndef ANKH_DSP_RAMP_H
+#define ANKH_DSP_RAMP_H
+
+typedef struct {
+    float step;    // Change per sample
+    float target;
+    int remaining; // Samples until target is reached, 0 = idle
+} ParamRamp;
+
+/**
+ * Start ramping from current to target over the given number of samples
+ */
+static inline void paramRampStart(ParamRamp* ramp, float current, float target, int samples) {
+    ramp->target = target;
+    ramp->remaining = samples;
+    ramp->step = (target - current) / (float)samples;
+}
+
+static inline void paramRampStop(ParamRamp* ramp) {
+    ramp->remaining = 0;
+}
+
+/**
+ * Value after advancing a ramp by one block; lands exactly on the target
+ */
+static inline float paramRampAdvance(ParamRamp* ramp, float current, int samples) {
+    if (samples >= ramp->remaining) {
+        ramp->remaining = 0;
+        return ramp->target;
+    }
+    ramp->remaining -= samples;
+    return current + ramp->step * (float)samples;
+}
+
+#endif // ANKH_DSP_RAMP_H
@@ -0,0 +1,148 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Lock-free fork/join for rendering on helper threads
+ *
+ * The audio thread splits a block into tasks and calls renderPoolRun(),
+ * which publishes the job, renders tasks itself and then spins until the
+ * tasks other threads claimed are done. Helper threads sit in
+ * renderPoolWorker(), claiming tasks as they are published and sleeping
+ * between jobs. No mutexes: the audio thread never waits on a sleeping
+ * thread, only on a task a running thread has already claimed, and it
+ * renders every task nobody claimed, so it finishes even if no helper ever
+ * wakes up.
+ *
+ * The job word packs the job's task count with the next unclaimed task, and
+ * a task is claimed by a compare-and-swap on it. A thread reads the job's
+ * function and context only after a successful claim, while the job cannot
+ * end, so a thread waking up late can never run a task of the wrong job.
+ *
+ * On WASM the module needs -matomics -mbulk-memory and a shared memory;
+ * helpers sleep with memory.atomic.wait, so they must run in Web Workers.
+ * Helper threads get no thread-local storage, so tasks must not use libc
+ * state such as errno.
+ */
+
+#ifndef ANKH_DSP_RENDERPOOL_H
+#define ANKH_DSP_RENDERPOOL_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+#if defined(__wasm__) && !defined(__wasm_atomics__)
+#error "dsp/renderpool.h needs -matomics -mbulk-memory"
+#endif
+
+#if !defined(__wasm__)
+#include <sched.h>
+#endif
+
+// Task count and next task, 16 bits each
+#define RENDER_POOL_TASK_BITS 16
+#define RENDER_POOL_TASK_MASK ((1u << RENDER_POOL_TASK_BITS) - 1)
+#define RENDER_POOL_MAX_TASKS RENDER_POOL_TASK_MASK
+
+// Claim attempts before an idle helper goes to sleep
+#define RENDER_POOL_SPIN 1024
+
+// Longest sleep, so a helper notices renderPoolStop() even without a wakeup
+#define RENDER_POOL_WAIT_NS 100000000LL
+
+typedef void (*RenderTask)(void* context, int task);
+
+typedef struct {
+    _Atomic uint32_t job;     // Task count << RENDER_POOL_TASK_BITS | next unclaimed task
+    _Atomic int32_t done;     // Tasks finished in the current job
+    _Atomic int32_t helpers;  // Threads inside renderPoolWorker()
+    _Atomic int32_t stopping; // Set by renderPoolStop()
+    RenderTask task;
+    void* context;
+} RenderPool;
+
+static inline void renderPoolSleep(RenderPool* pool, uint32_t job) {
+#if defined(__wasm__)
+    __builtin_wasm_memory_atomic_wait32((int32_t*)&pool->job, (int32_t)job, RENDER_POOL_WAIT_NS);
+#else
+    sched_yield();
+#endif
+}
+
+static inline void renderPoolWake(RenderPool* pool) {
+#if defined(__wasm__)
+    __builtin_wasm_memory_atomic_notify((int32_t*)&pool->job, UINT32_MAX);
+#endif
+}
+
+/**
+ * Claim and run one task of the current job. Returns 0 if every task is
+ * already claimed.
+ */
+static inline int renderPoolRunOne(RenderPool* pool) {
+    uint32_t job = atomic_load_explicit(&pool->job, memory_order_acquire);
+    for (;;) {
+        uint32_t count = job >> RENDER_POOL_TASK_BITS;
+        uint32_t next = job & RENDER_POOL_TASK_MASK;
+        if (next >= count) return 0;
+
+        if (atomic_compare_exchange_weak_explicit(&pool->job, &job, job + 1,
+                                                  memory_order_acq_rel, memory_order_acquire)) {
+            pool->task(pool->context, (int)next);
+            atomic_fetch_add_explicit(&pool->done, 1, memory_order_release);
+            return 1;
+        }
+    }
+}
+
+/**
+ * Number of helper threads currently serving the pool
+ */
+static inline int renderPoolHelpers(RenderPool* pool) {
+    return atomic_load_explicit(&pool->helpers, memory_order_relaxed);
+}
+
+/**
+ * Run task(context, 0..count-1) across the calling thread and the helpers,
+ * returning once all are done. Called by one thread at a time.
+ */
+static inline void renderPoolRun(RenderPool* pool, RenderTask task, void* context, int count) {
+    pool->task = task;
+    pool->context = context;
+    atomic_store_explicit(&pool->done, 0, memory_order_relaxed);
+    atomic_store_explicit(&pool->job, (uint32_t)count << RENDER_POOL_TASK_BITS, memory_order_release);
+    renderPoolWake(pool);
+
+    while (renderPoolRunOne(pool)) {
+    }
+    while (atomic_load_explicit(&pool->done, memory_order_acquire) < count) {
+    }
+}
+
+/**
+ * Serve the pool on a helper thread until renderPoolStop()
+ */
+static inline void renderPoolWorker(RenderPool* pool) {
+    atomic_fetch_add_explicit(&pool->helpers, 1, memory_order_relaxed);
+
+    int idle = 0;
+    while (!atomic_load_explicit(&pool->stopping, memory_order_relaxed)) {
+        if (renderPoolRunOne(pool)) {
+            idle = 0;
+        } else if (++idle >= RENDER_POOL_SPIN) {
+            renderPoolSleep(pool, atomic_load_explicit(&pool->job, memory_order_relaxed));
+            idle = 0;
+        }
+    }
+
+    atomic_fetch_sub_explicit(&pool->helpers, 1, memory_order_relaxed);
+}
+
+/**
+ * Make every helper return from renderPoolWorker() after its current task
+ */
+static inline void renderPoolStop(RenderPool* pool) {
+    atomic_store_explicit(&pool->stopping, 1, memory_order_relaxed);
+    renderPoolWake(pool);
+}
+
+#endif // ANKH_DSP_RENDERPOOL_H
@@ -0,0 +1,90 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Block saturation stage
+ *
+ * Replaces a per-sample tanhf() with a rational approximation (or a hard
+ * clip) applied to a whole mixed block, four samples at a time.
+ */
+
+#ifndef ANKH_DSP_SATURATION_H
+#define ANKH_DSP_SATURATION_H
+
+#include "simd.h"
+
+typedef enum {
+    SATURATION_SOFT = 0, // tanh-shaped soft clip
+    SATURATION_HARD,     // Clamp to [-1, 1]
+    SATURATION_OFF       // Gain only
+} SaturationMode;
+
+// Beyond this the approximation below is within 1e-4 of +/-1 and is clamped
+#define SATURATION_TANH_LIMIT 4.97f
+
+/**
+ * tanh(x) as a 7/6 rational (Lambert continued fraction), error < 1e-4
+ */
+static inline float fastTanh(float x) {
+    if (x > SATURATION_TANH_LIMIT) x = SATURATION_TANH_LIMIT;
+    if (x < -SATURATION_TANH_LIMIT) x = -SATURATION_TANH_LIMIT;
+    float x2 = x * x;
+    float num = x * (135135.0f + x2 * (17325.0f + x2 * (378.0f + x2)));
+    float den = 135135.0f + x2 * (62370.0f + x2 * (3150.0f + x2 * 28.0f));
+    return num / den;
+}
+
+static inline f32x4 fastTanh4(f32x4 x) {
+    x = f32x4Clamp(x, f32x4Splat(-SATURATION_TANH_LIMIT), f32x4Splat(SATURATION_TANH_LIMIT));
+    f32x4 x2 = f32x4Mul(x, x);
+    f32x4 num = f32x4MulAdd(x2, f32x4Splat(1.0f), f32x4Splat(378.0f));
+    num = f32x4MulAdd(num, x2, f32x4Splat(17325.0f));
+    num = f32x4MulAdd(num, x2, f32x4Splat(135135.0f));
+    num = f32x4Mul(num, x);
+    f32x4 den = f32x4MulAdd(x2, f32x4Splat(28.0f), f32x4Splat(3150.0f));
+    den = f32x4MulAdd(den, x2, f32x4Splat(62370.0f));
+    den = f32x4MulAdd(den, x2, f32x4Splat(135135.0f));
+    return f32x4Div(num, den);
+}
+
+static inline float saturateSample(float x, SaturationMode mode) {
+    switch (mode) {
+        case SATURATION_SOFT: return fastTanh(x);
+        case SATURATION_HARD: return x > 1.0f ? 1.0f : (x < -1.0f ? -1.0f : x);
+        default:              return x;
+    }
+}
+
+/**
+ * Apply gain and saturation to a block in place
+ */
+static inline void saturateBlock(float* buffer, int length, float gain, SaturationMode mode) {
+    f32x4 g = f32x4Splat(gain);
+    f32x4 lo = f32x4Splat(-1.0f);
+    f32x4 hi = f32x4Splat(1.0f);
+    int i = 0;
+
+    switch (mode) {
+        case SATURATION_SOFT:
+            for (; i + SIMD_LANES <= length; i += SIMD_LANES) {
+                f32x4Store(buffer + i, fastTanh4(f32x4Mul(f32x4Load(buffer + i), g)));
+            }
+            break;
+        case SATURATION_HARD:
+            for (; i + SIMD_LANES <= length; i += SIMD_LANES) {
+                f32x4Store(buffer + i, f32x4Clamp(f32x4Mul(f32x4Load(buffer + i), g), lo, hi));
+            }
+            break;
+        default:
+            for (; i + SIMD_LANES <= length; i += SIMD_LANES) {
+                f32x4Store(buffer + i, f32x4Mul(f32x4Load(buffer + i), g));
+            }
+            break;
+    }
+
+    for (; i < length; i++) {
+        buffer[i] = saturateSample(buffer[i] * gain, mode);
+    }
+}
+
+#endif // ANKH_DSP_SATURATION_H
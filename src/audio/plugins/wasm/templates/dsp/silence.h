@@ -0,0 +1,44 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Silence detection
+ *
+ * Plugins use these to skip processing entirely while both their input and
+ * their internal state are silent, and report that through isQuiescent() so
+ * the host can stop calling them until audio (or MIDI) arrives again.
+ */
+
+#ifndef ANKH_DSP_SILENCE_H
+#define ANKH_DSP_SILENCE_H
+
+// About -100 dBFS
+#define SILENCE_THRESHOLD 1e-5f
+
+/**
+ * Largest absolute sample value in a buffer
+ */
+static inline float bufferPeak(const float* buffer, int length) {
+    float peak = 0.0f;
+    for (int i = 0; i < length; i++) {
+        float a = buffer[i] < 0.0f ? -buffer[i] : buffer[i];
+        peak = a > peak ? a : peak;
+    }
+    return peak;
+}
+
+/**
+ * True if every sample is below SILENCE_THRESHOLD (a NULL buffer is silent)
+ */
+static inline int bufferIsSilent(const float* buffer, int length) {
+    return !buffer || bufferPeak(buffer, length) < SILENCE_THRESHOLD;
+}
+
+/**
+ * True if a state value is small enough to be treated as exactly zero
+ */
+static inline int stateIsSilent(float value) {
+    return value < SILENCE_THRESHOLD && value > -SILENCE_THRESHOLD;
+}
+
+#endif // ANKH_DSP_SILENCE_H
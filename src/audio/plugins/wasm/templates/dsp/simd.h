@@ -0,0 +1,257 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Portable 4-lane float vectors for the plugin templates
+ *
+ * When compiled with `-msimd128` these map directly onto WASM SIMD128
+ * intrinsics. Otherwise a plain 4-float struct is used so the same kernels
+ * build (and auto-vectorize) with any host compiler.
+ */
+
+#ifndef ANKH_DSP_SIMD_H
+#define ANKH_DSP_SIMD_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define SIMD_LANES 4
+#define SIMD_ALIGN 16
+
+#if defined(_MSC_VER)
+#define DSP_ALIGNED __declspec(align(SIMD_ALIGN))
+#else
+#define DSP_ALIGNED __attribute__((aligned(SIMD_ALIGN)))
+#endif
+
+// For helpers taking a function or mode argument that must be specialized
+// into each caller rather than called through, and for per-sample math the
+// compiler would otherwise outline once enough kernels call it
+#if defined(_MSC_VER)
+#define DSP_FORCE_INLINE static __forceinline
+#else
+#define DSP_FORCE_INLINE static inline __attribute__((always_inline))
+#endif
+
+#if defined(__wasm_simd128__)
+
+#include <wasm_simd128.h>
+
+typedef v128_t f32x4;
+typedef v128_t m32x4; // Lane mask: all bits set = true
+typedef v128_t u32x4;
+
+static inline f32x4 f32x4Splat(float x) { return wasm_f32x4_splat(x); }
+static inline f32x4 f32x4Load(const float* p) { return wasm_v128_load(p); }
+static inline void f32x4Store(float* p, f32x4 v) { wasm_v128_store(p, v); }
+
+static inline f32x4 f32x4Add(f32x4 a, f32x4 b) { return wasm_f32x4_add(a, b); }
+static inline f32x4 f32x4Sub(f32x4 a, f32x4 b) { return wasm_f32x4_sub(a, b); }
+static inline f32x4 f32x4Mul(f32x4 a, f32x4 b) { return wasm_f32x4_mul(a, b); }
+static inline f32x4 f32x4Div(f32x4 a, f32x4 b) { return wasm_f32x4_div(a, b); }
+static inline f32x4 f32x4Min(f32x4 a, f32x4 b) { return wasm_f32x4_pmin(a, b); }
+static inline f32x4 f32x4Max(f32x4 a, f32x4 b) { return wasm_f32x4_pmax(a, b); }
+static inline f32x4 f32x4Abs(f32x4 a) { return wasm_f32x4_abs(a); }
+static inline f32x4 f32x4Floor(f32x4 a) { return wasm_f32x4_floor(a); }
+
+static inline m32x4 f32x4Ge(f32x4 a, f32x4 b) { return wasm_f32x4_ge(a, b); }
+static inline m32x4 f32x4Gt(f32x4 a, f32x4 b) { return wasm_f32x4_gt(a, b); }
+static inline m32x4 f32x4Le(f32x4 a, f32x4 b) { return wasm_f32x4_le(a, b); }
+static inline m32x4 f32x4Lt(f32x4 a, f32x4 b) { return wasm_f32x4_lt(a, b); }
+static inline m32x4 f32x4Ne(f32x4 a, f32x4 b) { return wasm_f32x4_ne(a, b); }
+
+// mask ? a : b
+static inline f32x4 f32x4Select(m32x4 mask, f32x4 a, f32x4 b) {
+    return wasm_v128_bitselect(a, b, mask);
+}
+
+static inline int m32x4Any(m32x4 mask) { return wasm_v128_any_true(mask); }
+static inline int m32x4Bits(m32x4 mask) { return (int)wasm_i32x4_bitmask(mask); }
+
+static inline float f32x4HorizontalSum(f32x4 v) {
+    return wasm_f32x4_extract_lane(v, 0) + wasm_f32x4_extract_lane(v, 1) +
+           wasm_f32x4_extract_lane(v, 2) + wasm_f32x4_extract_lane(v, 3);
+}
+
+static inline u32x4 u32x4Splat(uint32_t x) { return wasm_i32x4_splat((int32_t)x); }
+static inline u32x4 u32x4Load(const uint32_t* p) { return wasm_v128_load(p); }
+static inline void u32x4Store(uint32_t* p, u32x4 v) { wasm_v128_store(p, v); }
+static inline u32x4 u32x4Xor(u32x4 a, u32x4 b) { return wasm_v128_xor(a, b); }
+static inline u32x4 u32x4Or(u32x4 a, u32x4 b) { return wasm_v128_or(a, b); }
+static inline u32x4 u32x4Shl(u32x4 a, int n) { return wasm_i32x4_shl(a, n); }
+static inline u32x4 u32x4Shr(u32x4 a, int n) { return wasm_u32x4_shr(a, n); }
+
+// Reinterpret the bits of each lane as a float
+static inline f32x4 u32x4AsF32x4(u32x4 a) { return a; }
+
+#else // Portable fallback
+
+typedef struct { float v[SIMD_LANES]; } f32x4;
+typedef struct { int32_t v[SIMD_LANES]; } m32x4; // Lane mask: -1 = true
+typedef struct { uint32_t v[SIMD_LANES]; } u32x4;
+
+static inline f32x4 f32x4Splat(float x) {
+    f32x4 r;
+    for (int i = 0; i < SIMD_LANES; i++) r.v[i] = x;
+    return r;
+}
+
+static inline f32x4 f32x4Load(const float* p) {
+    f32x4 r;
+    for (int i = 0; i < SIMD_LANES; i++) r.v[i] = p[i];
+    return r;
+}
+
+static inline void f32x4Store(float* p, f32x4 v) {
+    for (int i = 0; i < SIMD_LANES; i++) p[i] = v.v[i];
+}
+
+#define DSP_F32X4_BINARY(name, expr) \
+    static inline f32x4 name(f32x4 a, f32x4 b) { \
+        f32x4 r; \
+        for (int i = 0; i < SIMD_LANES; i++) r.v[i] = (expr); \
+        return r; \
+    }
+
+DSP_F32X4_BINARY(f32x4Add, a.v[i] + b.v[i])
+DSP_F32X4_BINARY(f32x4Sub, a.v[i] - b.v[i])
+DSP_F32X4_BINARY(f32x4Mul, a.v[i] * b.v[i])
+DSP_F32X4_BINARY(f32x4Div, a.v[i] / b.v[i])
+DSP_F32X4_BINARY(f32x4Min, b.v[i] < a.v[i] ? b.v[i] : a.v[i])
+DSP_F32X4_BINARY(f32x4Max, a.v[i] < b.v[i] ? b.v[i] : a.v[i])
+
+#undef DSP_F32X4_BINARY
+
+static inline f32x4 f32x4Abs(f32x4 a) {
+    for (int i = 0; i < SIMD_LANES; i++) a.v[i] = a.v[i] < 0.0f ? -a.v[i] : a.v[i];
+    return a;
+}
+
+static inline f32x4 f32x4Floor(f32x4 a) {
+    for (int i = 0; i < SIMD_LANES; i++) {
+        float t = (float)(int32_t)a.v[i];
+        a.v[i] = t > a.v[i] ? t - 1.0f : t;
+    }
+    return a;
+}
+
+#define DSP_F32X4_COMPARE(name, op) \
+    static inline m32x4 name(f32x4 a, f32x4 b) { \
+        m32x4 r; \
+        for (int i = 0; i < SIMD_LANES; i++) r.v[i] = a.v[i] op b.v[i] ? -1 : 0; \
+        return r; \
+    }
+
+DSP_F32X4_COMPARE(f32x4Ge, >=)
+DSP_F32X4_COMPARE(f32x4Gt, >)
+DSP_F32X4_COMPARE(f32x4Le, <=)
+DSP_F32X4_COMPARE(f32x4Lt, <)
+DSP_F32X4_COMPARE(f32x4Ne, !=)
+
+#undef DSP_F32X4_COMPARE
+
+// mask ? a : b
+static inline f32x4 f32x4Select(m32x4 mask, f32x4 a, f32x4 b) {
+    f32x4 r;
+    for (int i = 0; i < SIMD_LANES; i++) r.v[i] = mask.v[i] ? a.v[i] : b.v[i];
+    return r;
+}
+
+static inline int m32x4Any(m32x4 mask) {
+    return (mask.v[0] | mask.v[1] | mask.v[2] | mask.v[3]) != 0;
+}
+
+static inline int m32x4Bits(m32x4 mask) {
+    int bits = 0;
+    for (int i = 0; i < SIMD_LANES; i++) bits |= (mask.v[i] ? 1 : 0) << i;
+    return bits;
+}
+
+static inline float f32x4HorizontalSum(f32x4 v) {
+    return v.v[0] + v.v[1] + v.v[2] + v.v[3];
+}
+
+static inline u32x4 u32x4Splat(uint32_t x) {
+    u32x4 r;
+    for (int i = 0; i < SIMD_LANES; i++) r.v[i] = x;
+    return r;
+}
+
+static inline u32x4 u32x4Load(const uint32_t* p) {
+    u32x4 r;
+    for (int i = 0; i < SIMD_LANES; i++) r.v[i] = p[i];
+    return r;
+}
+
+static inline void u32x4Store(uint32_t* p, u32x4 v) {
+    for (int i = 0; i < SIMD_LANES; i++) p[i] = v.v[i];
+}
+
+static inline u32x4 u32x4Xor(u32x4 a, u32x4 b) {
+    for (int i = 0; i < SIMD_LANES; i++) a.v[i] ^= b.v[i];
+    return a;
+}
+
+static inline u32x4 u32x4Or(u32x4 a, u32x4 b) {
+    for (int i = 0; i < SIMD_LANES; i++) a.v[i] |= b.v[i];
+    return a;
+}
+
+static inline u32x4 u32x4Shl(u32x4 a, int n) {
+    for (int i = 0; i < SIMD_LANES; i++) a.v[i] <<= n;
+    return a;
+}
+
+static inline u32x4 u32x4Shr(u32x4 a, int n) {
+    for (int i = 0; i < SIMD_LANES; i++) a.v[i] >>= n;
+    return a;
+}
+
+// Reinterpret the bits of each lane as a float
+static inline f32x4 u32x4AsF32x4(u32x4 a) {
+    f32x4 r;
+    memcpy(r.v, a.v, sizeof(r.v));
+    return r;
+}
+
+#endif
+
+// ============================================================================
+// Shared vector math
+// ============================================================================
+
+static inline f32x4 f32x4MulAdd(f32x4 a, f32x4 b, f32x4 c) {
+    return f32x4Add(f32x4Mul(a, b), c);
+}
+
+static inline f32x4 f32x4Clamp(f32x4 v, f32x4 lo, f32x4 hi) {
+    return f32x4Min(f32x4Max(v, lo), hi);
+}
+
+/**
+ * sin(x) for |x| <= pi/2 (7th order odd polynomial, error < 2e-5)
+ */
+static inline f32x4 f32x4SinPoly(f32x4 x) {
+    f32x4 x2 = f32x4Mul(x, x);
+    f32x4 p = f32x4Splat(-1.0f / 5040.0f);
+    p = f32x4MulAdd(p, x2, f32x4Splat(1.0f / 120.0f));
+    p = f32x4MulAdd(p, x2, f32x4Splat(-1.0f / 6.0f));
+    p = f32x4MulAdd(p, x2, f32x4Splat(1.0f));
+    return f32x4Mul(p, x);
+}
+
+/**
+ * sin(2 * pi * t) for a normalized phase t in [0, 1)
+ */
+DSP_FORCE_INLINE f32x4 f32x4SinCycle(f32x4 t) {
+    const float pi = 3.14159265358979323846f;
+    // sin(2*pi*t) = -sin(pi*z) with z = 2t - 1 in [-1, 1)
+    f32x4 z = f32x4Sub(f32x4Add(t, t), f32x4Splat(1.0f));
+    // Fold |z| > 0.5 back into [-0.5, 0.5]
+    f32x4 one = f32x4Splat(1.0f);
+    f32x4 w = f32x4Select(f32x4Gt(z, f32x4Splat(0.5f)), f32x4Sub(one, z), z);
+    w = f32x4Select(f32x4Lt(w, f32x4Splat(-0.5f)), f32x4Sub(f32x4Splat(-1.0f), w), w);
+    return f32x4Mul(f32x4SinPoly(f32x4Mul(w, f32x4Splat(pi))), f32x4Splat(-1.0f));
+}
+
+#endif // ANKH_DSP_SIMD_H
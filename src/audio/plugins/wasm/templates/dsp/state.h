@@ -0,0 +1,147 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Binary state snapshots
+ *
+ * saveState() writes an instance into one block the host copies out of
+ * memory, and loadState() restores it, so restoring a project or an undo
+ * step costs one call instead of a setParameter() per parameter. Layout:
+ *
+ *   StateHeader                 (20 bytes)
+ *   float[parameterCount]       parameter values
+ *   DSP state                   voices, filter memory, delay history, ...
+ *
+ * The DSP state is the plugin's own fields copied as they are in memory, so
+ * it is only meaningful to the same build at the same sample rate. Plugins
+ * visit those fields with STATE_FIELD() in one function used for measuring,
+ * saving and loading, which keeps the three in step. A snapshot whose DSP
+ * state does not fit (another sample rate, polyphony or layout version)
+ * still restores its parameters.
+ */
+
+#ifndef ANKH_DSP_STATE_H
+#define ANKH_DSP_STATE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define STATE_MAGIC 0x534b4e41u // "ANKS"
+
+// Four-character plugin identifier for StateHeader.pluginId
+#define STATE_ID(a, b, c, d) \
+    ((uint32_t)(a) | (uint32_t)(b) << 8 | (uint32_t)(c) << 16 | (uint32_t)(d) << 24)
+
+/**
+ * Snapshot header (32-bit fields unless noted, little-endian)
+ */
+typedef struct {
+    uint32_t magic;          // STATE_MAGIC
+    uint32_t pluginId;       // STATE_ID() of the plugin that wrote it
+    uint16_t version;        // Plugin's layout version, bumped when its DSP state changes
+    uint16_t parameterCount;
+    uint32_t size;           // Whole snapshot in bytes, header included
+    float sampleRate;        // Rate the DSP state was captured at
+} StateHeader;
+
+typedef enum {
+    STATE_MEASURE = 0, // Only count bytes
+    STATE_SAVE,
+    STATE_LOAD
+} StateDirection;
+
+typedef struct {
+    uint8_t* data;
+    uint32_t pos; // Bytes visited so far
+    StateDirection direction;
+} StateCursor;
+
+static inline void stateCursorInit(StateCursor* c, void* data, StateDirection direction) {
+    c->data = (uint8_t*)data;
+    c->pos = 0;
+    c->direction = direction;
+}
+
+/**
+ * Copy bytes between a field and the snapshot, in the cursor's direction.
+ * Loading must only start once the snapshot size has been checked.
+ */
+static inline void stateBytes(StateCursor* c, void* field, uint32_t bytes) {
+    if (c->direction == STATE_SAVE) {
+        memcpy(c->data + c->pos, field, bytes);
+    } else if (c->direction == STATE_LOAD) {
+        memcpy(field, c->data + c->pos, bytes);
+    }
+    c->pos += bytes;
+}
+
+#define STATE_FIELD(c, field) stateBytes((c), &(field), (uint32_t)sizeof(field))
+
+/**
+ * Bytes of a snapshot whose DSP state takes dspBytes
+ */
+static inline uint32_t stateSize(int parameterCount, uint32_t dspBytes) {
+    return (uint32_t)(sizeof(StateHeader) + parameterCount * sizeof(float)) + dspBytes;
+}
+
+/**
+ * Write the header and parameters, leaving c at the DSP state
+ */
+static inline void stateBeginSave(StateCursor* c, void* data, uint32_t pluginId, uint16_t version,
+                                  const float* params, int parameterCount, uint32_t size,
+                                  float sampleRate) {
+    StateHeader header;
+    header.magic = STATE_MAGIC;
+    header.pluginId = pluginId;
+    header.version = version;
+    header.parameterCount = (uint16_t)parameterCount;
+    header.size = size;
+    header.sampleRate = sampleRate;
+
+    stateCursorInit(c, data, STATE_SAVE);
+    STATE_FIELD(c, header);
+    stateBytes(c, (void*)params, (uint32_t)(parameterCount * sizeof(float)));
+}
+
+/**
+ * Validate a snapshot of length bytes for a plugin and read its header.
+ * Returns 0 if it is not a snapshot of this plugin with parameterCount
+ * parameters, or its length does not match.
+ */
+static inline int stateReadHeader(StateHeader* header, const void* data, int length,
+                                  uint32_t pluginId, int parameterCount) {
+    if (!data || length < (int)sizeof(StateHeader)) return 0;
+
+    memcpy(header, data, sizeof(StateHeader));
+    return header->magic == STATE_MAGIC && header->pluginId == pluginId &&
+           header->parameterCount == parameterCount && header->size == (uint32_t)length &&
+           header->size >= stateSize(parameterCount, 0);
+}
+
+/**
+ * Parameter i of a validated snapshot
+ */
+static inline float stateParameter(const void* data, int i) {
+    float value;
+    memcpy(&value, (const uint8_t*)data + sizeof(StateHeader) + i * sizeof(float), sizeof(float));
+    return value;
+}
+
+/**
+ * Whether a validated snapshot's DSP state can be loaded by a plugin at
+ * layout version whose DSP state takes dspBytes, running at sampleRate.
+ * Initializes c to load it if so.
+ */
+static inline int stateBeginLoad(StateCursor* c, const StateHeader* header, const void* data,
+                                 uint16_t version, uint32_t dspBytes, float sampleRate) {
+    if (header->version != version || header->sampleRate != sampleRate ||
+        header->size != stateSize(header->parameterCount, dspBytes)) {
+        return 0;
+    }
+
+    stateCursorInit(c, (void*)data, STATE_LOAD);
+    c->pos = stateSize(header->parameterCount, 0);
+    return 1;
+}
+
+#endif // ANKH_DSP_STATE_H
@@ -0,0 +1,113 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Per-block processing statistics
+ *
+ * Plugins time each processed block with a clock imported from the host
+ * (env.hostClock, milliseconds) and keep the results in a ProcessStats
+ * struct the host reads through getProcessStats(). The host turns them into
+ * a DSP-load readout per plugin: load is processing time divided by the
+ * block's realtime budget, so 1.0 means the plugin alone used the whole
+ * block.
+ *
+ * Build with -DPROCESS_STATS=0 to compile the timing out, or with
+ * -DSTATS_LIBC_CLOCK to time with clock() instead of the import.
+ */
+
+#ifndef ANKH_DSP_STATS_H
+#define ANKH_DSP_STATS_H
+
+#include <stdint.h>
+
+#ifndef PROCESS_STATS
+#define PROCESS_STATS 1
+#endif
+
+// A block counts towards xrunRiskBlocks when it used more than this share of its budget
+#define STATS_XRUN_RISK_LOAD 0.5f
+
+// Smoothing of averageBlockMs, per block
+#define STATS_AVERAGE_WEIGHT (1.0f / 32.0f)
+
+/**
+ * Layout read by the host (32-bit fields, in this order)
+ */
+typedef struct {
+    uint32_t blockCount;       // Blocks processed since create()/init()
+    uint32_t activeVoices;     // Voices sounding after the last block (0 for effects)
+    uint32_t parameterChanges; // setParameter()/ramp/CC calls that changed a parameter
+    uint32_t xrunRiskBlocks;   // Blocks over STATS_XRUN_RISK_LOAD of their budget
+    float lastBlockMs;         // Processing time of the last block
+    float peakBlockMs;         // Longest block
+    float averageBlockMs;      // Exponential moving average
+    float lastLoad;            // lastBlockMs / block duration
+} ProcessStats;
+
+#if PROCESS_STATS
+
+#if defined(__wasm__) && !defined(STATS_LIBC_CLOCK)
+// Provided by the host, e.g. performance.now()
+__attribute__((import_module("env"), import_name("hostClock"))) double hostClock(void);
+#else
+// Native builds and Emscripten programs with a libc runtime
+#include <time.h>
+static inline double hostClock(void) {
+    return (double)clock() * 1000.0 / CLOCKS_PER_SEC;
+}
+#endif
+
+static inline double statsBlockBegin(void) {
+    return hostClock();
+}
+
+/**
+ * Milliseconds since start (from statsBlockBegin())
+ */
+static inline float statsElapsedMs(double start) {
+    return (float)(hostClock() - start);
+}
+
+/**
+ * Record a block of numSamples frames that took elapsed milliseconds
+ */
+static inline void statsBlockRecord(ProcessStats* stats, float elapsed, int numSamples, float sampleRate) {
+    float budget = numSamples * 1000.0f / sampleRate;
+
+    stats->lastBlockMs = elapsed;
+    if (elapsed > stats->peakBlockMs) stats->peakBlockMs = elapsed;
+    stats->averageBlockMs = stats->blockCount == 0 ? elapsed
+        : stats->averageBlockMs + (elapsed - stats->averageBlockMs) * STATS_AVERAGE_WEIGHT;
+    stats->lastLoad = budget > 0.0f ? elapsed / budget : 0.0f;
+    if (stats->lastLoad > STATS_XRUN_RISK_LOAD) stats->xrunRiskBlocks++;
+    stats->blockCount++;
+}
+
+/**
+ * Record a block of numSamples frames that started at start (from statsBlockBegin())
+ */
+static inline void statsBlockEnd(ProcessStats* stats, double start, int numSamples, float sampleRate) {
+    statsBlockRecord(stats, statsElapsedMs(start), numSamples, sampleRate);
+}
+
+#else
+
+static inline double statsBlockBegin(void) {
+    return 0.0;
+}
+
+static inline float statsElapsedMs(double start) {
+    return 0.0f;
+}
+
+static inline void statsBlockRecord(ProcessStats* stats, float elapsed, int numSamples, float sampleRate) {
+    stats->blockCount++;
+}
+
+static inline void statsBlockEnd(ProcessStats* stats, double start, int numSamples, float sampleRate) {
+    stats->blockCount++;
+}
+
+#endif // PROCESS_STATS
+
+#endif // ANKH_DSP_STATS_H
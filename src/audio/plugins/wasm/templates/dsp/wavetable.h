@@ -0,0 +1,200 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Band-limited mipmapped wavetables
+ *
+ * Each table holds one single-cycle waveform at WAVETABLE_MIP_LEVELS
+ * resolutions. Level k keeps only the harmonics that stay below Nyquist for
+ * phase increments up to 1 / (WAVETABLE_SIZE >> k), so an oscillator picks a
+ * level once per block and then only does a table read plus a lerp per sample.
+ *
+ * Tables are built from a spectrum with an inverse FFT, so building is cheap
+ * enough for init() and for loading custom single-cycle waveforms at runtime.
+ */
+
+#ifndef ANKH_DSP_WAVETABLE_H
+#define ANKH_DSP_WAVETABLE_H
+
+#include <math.h>
+#include <string.h>
+
+#include "simd.h"
+
+#define WAVETABLE_SIZE 2048        // Samples per cycle (power of two)
+#define WAVETABLE_MIP_LEVELS 11    // Level 0 = WAVETABLE_SIZE / 2 - 1 harmonics, last level = 1
+#define WAVETABLE_PI 3.14159265358979323846f
+
+/**
+ * One waveform, all mip levels. Each level carries one guard sample so
+ * interpolation never has to wrap.
+ */
+typedef struct {
+    DSP_ALIGNED float levels[WAVETABLE_MIP_LEVELS][WAVETABLE_SIZE + 1];
+} Wavetable;
+
+/**
+ * Spectrum scratch used while building (init-time only)
+ */
+typedef struct {
+    float re[WAVETABLE_SIZE];
+    float im[WAVETABLE_SIZE];
+    float levelRe[WAVETABLE_SIZE];
+    float levelIm[WAVETABLE_SIZE];
+} WavetableSpectrum;
+
+// ============================================================================
+// FFT (init-time)
+// ============================================================================
+
+/**
+ * In-place iterative radix-2 FFT. inverse != 0 computes the unscaled inverse.
+ */
+static void wavetableFFT(float* re, float* im, int n, int inverse) {
+    // Bit reversal
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            float t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+
+    for (int len = 2; len <= n; len <<= 1) {
+        float angle = (inverse ? 2.0f : -2.0f) * WAVETABLE_PI / (float)len;
+        float wRe = cosf(angle), wIm = sinf(angle);
+
+        for (int i = 0; i < n; i += len) {
+            float curRe = 1.0f, curIm = 0.0f;
+            for (int k = 0; k < len / 2; k++) {
+                int a = i + k, b = i + k + len / 2;
+                float tRe = re[b] * curRe - im[b] * curIm;
+                float tIm = re[b] * curIm + im[b] * curRe;
+                re[b] = re[a] - tRe;
+                im[b] = im[a] - tIm;
+                re[a] += tRe;
+                im[a] += tIm;
+
+                float nextRe = curRe * wRe - curIm * wIm;
+                curIm = curRe * wIm + curIm * wRe;
+                curRe = nextRe;
+            }
+        }
+    }
+}
+
+// ============================================================================
+// Building
+// ============================================================================
+
+/**
+ * Highest harmonic stored at a mip level
+ */
+static inline int wavetableMaxHarmonic(int level) {
+    int harmonics = (WAVETABLE_SIZE / 2) >> level;
+    return harmonics >= WAVETABLE_SIZE / 2 ? WAVETABLE_SIZE / 2 - 1 : harmonics;
+}
+
+/**
+ * Fill every mip level of a table from a spectrum where bin n holds the
+ * complex amplitude of harmonic n (x[k] = sum X[n] e^(2 pi i n k / N))
+ */
+static void wavetableBuildFromSpectrum(Wavetable* table, WavetableSpectrum* s) {
+    for (int level = 0; level < WAVETABLE_MIP_LEVELS; level++) {
+        int maxHarmonic = wavetableMaxHarmonic(level);
+
+        memset(s->levelRe, 0, sizeof(s->levelRe));
+        memset(s->levelIm, 0, sizeof(s->levelIm));
+        s->levelRe[0] = s->re[0];
+        for (int n = 1; n <= maxHarmonic; n++) {
+            s->levelRe[n] = s->re[n];
+            s->levelIm[n] = s->im[n];
+            s->levelRe[WAVETABLE_SIZE - n] = s->re[n];
+            s->levelIm[WAVETABLE_SIZE - n] = -s->im[n];
+        }
+
+        wavetableFFT(s->levelRe, s->levelIm, WAVETABLE_SIZE, 1);
+
+        float* out = table->levels[level];
+        for (int k = 0; k < WAVETABLE_SIZE; k++) out[k] = s->levelRe[k];
+        out[WAVETABLE_SIZE] = out[0];
+    }
+}
+
+/**
+ * Set harmonic n to a * cos(2 pi n t) + b * sin(2 pi n t)
+ */
+static inline void wavetableSetHarmonic(WavetableSpectrum* s, int n, float a, float b) {
+    s->re[n] = 0.5f * a;
+    s->im[n] = -0.5f * b;
+}
+
+/**
+ * Build a table from one cycle of arbitrary length (linearly resampled)
+ */
+static inline void wavetableBuildFromCycle(Wavetable* table, WavetableSpectrum* s, const float* cycle, int length) {
+    for (int k = 0; k < WAVETABLE_SIZE; k++) {
+        float pos = (float)k * (float)length / (float)WAVETABLE_SIZE;
+        int i0 = (int)pos;
+        int i1 = (i0 + 1) % length;
+        float frac = pos - (float)i0;
+        s->re[k] = cycle[i0] + (cycle[i1] - cycle[i0]) * frac;
+        s->im[k] = 0.0f;
+    }
+
+    wavetableFFT(s->re, s->im, WAVETABLE_SIZE, 0);
+
+    // Forward FFT of a real signal: X[n] already is the harmonic amplitude once scaled
+    float scale = 1.0f / (float)WAVETABLE_SIZE;
+    for (int n = 0; n < WAVETABLE_SIZE; n++) {
+        s->re[n] *= scale;
+        s->im[n] *= scale;
+    }
+
+    wavetableBuildFromSpectrum(table, s);
+}
+
+// ============================================================================
+// Playback
+// ============================================================================
+
+/**
+ * Mip level for a phase increment (cycles per sample)
+ */
+static inline int wavetableMipLevel(float phaseIncrement) {
+    int exponent;
+    float mantissa = frexpf(phaseIncrement * (float)WAVETABLE_SIZE, &exponent);
+
+    // ceil(log2(WAVETABLE_SIZE * phaseIncrement))
+    int level = mantissa > 0.5f ? exponent : exponent - 1;
+    if (level < 0) level = 0;
+    if (level >= WAVETABLE_MIP_LEVELS) level = WAVETABLE_MIP_LEVELS - 1;
+    return level;
+}
+
+/**
+ * Linearly interpolated read of four phases in [0, 1), each from its own level
+ */
+static inline f32x4 wavetableRead4(const float* const levels[SIMD_LANES], f32x4 phase) {
+    f32x4 pos = f32x4Mul(phase, f32x4Splat((float)WAVETABLE_SIZE));
+    f32x4 whole = f32x4Floor(pos);
+    f32x4 frac = f32x4Sub(pos, whole);
+
+    DSP_ALIGNED float index[SIMD_LANES];
+    DSP_ALIGNED float a[SIMD_LANES];
+    DSP_ALIGNED float b[SIMD_LANES];
+    f32x4Store(index, whole);
+
+    for (int l = 0; l < SIMD_LANES; l++) {
+        int i = (int)index[l] & (WAVETABLE_SIZE - 1);
+        a[l] = levels[l][i];
+        b[l] = levels[l][i + 1];
+    }
+
+    f32x4 va = f32x4Load(a);
+    return f32x4MulAdd(f32x4Sub(f32x4Load(b), va), frac, va);
+}
+
+#endif // ANKH_DSP_WAVETABLE_H
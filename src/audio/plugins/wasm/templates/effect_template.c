@@ -3,21 +3,57 @@
  */
 /**
  * WASM Effect Plugin Template
- * 
+ *
  * This is a template for creating audio effect plugins for AnkhWaveStudio.
  * Compile with Emscripten:
- * 
+ *
  * emcc effect_template.c -o my_effect.wasm \
  *   -s WASM=1 \
- *   -s EXPORTED_FUNCTIONS='["_init","_process","_dispose","_reset","_getParameterCount","_getParameter","_setParameter","_getLatency","_malloc","_free"]' \
- *   -s ALLOW_MEMORY_GROWTH=1 \
+ *   -s EXPORTED_FUNCTIONS='["_init","_process","_dispose","_reset","_getParameterCount","_getParameter","_setParameter","_setParameterRamp","_getInputBuffer","_getOutputBuffer","_processBuffers","_getLatency","_isQuiescent","_processOffline","_getProcessStats","_getAutomationBuffer","_getAutomationCapacity","_setAutomation","_getStateSize","_saveState","_loadState","_getRequiredMemory","_processBatch","_create","_destroy","_instanceProcess","_instanceProcessBlock","_instanceProcessOffline","_instanceProcessBuffers","_instanceGetInputBuffer","_instanceGetOutputBuffer","_instanceReset","_instanceGetParameter","_instanceSetParameter","_instanceSetParameterRamp","_instanceGetLatency","_instanceIsQuiescent","_instanceGetProcessStats","_instanceGetAutomationBuffer","_instanceSetAutomation","_instanceGetStateSize","_instanceSaveState","_instanceLoadState","_malloc","_free"]' \
+ *   -s IMPORTED_MEMORY=1 -s INITIAL_MEMORY=1MB \
  *   -O3
+ *
+ * All state lives in an EffectInstance, so one module and one memory can host
+ * any number of plugin instances: create() returns a handle that is passed to
+ * the instance*() functions. The handle-less functions (init, process, ...)
+ * operate on a default instance for single-instance hosts.
+ *
+ * Parameter ramps and the filter coefficient update once per control block
+ * of CONTROL_BLOCK_SIZE frames (see dsp/control.h), counted across calls, so
+ * the effect sounds and costs the same at any host block size.
+ *
+ * Automation curves uploaded with setAutomation() are evaluated every
+ * control block and drive the parameter ramps (see dsp/automation.h).
+ *
+ * saveState() captures an instance, filter memory and lookahead history
+ * included, in one block that loadState() restores (see dsp/state.h).
+ *
+ * getRequiredMemory() reports the heap an instance takes before it exists,
+ * so the host can size WASM memory once instead of growing it later. Build
+ * with IMPORTED_MEMORY and without ALLOW_MEMORY_GROWTH, as above: the host
+ * then creates the memory and is the only one growing it.
+ *
+ * processBatch() processes the I/O buffers of many instances in one call,
+ * four instances per SIMD vector, for hosts running the same effect on many
+ * channels.
  */
 
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 
+#include "dsp/control.h"
+#include "dsp/coefficients.h"
+#include "dsp/silence.h"
+#include "dsp/ramp.h"
+#include "dsp/automation.h"
+#include "dsp/simd.h"
+#include "dsp/arena.h"
+#include "dsp/delayline.h"
+#include "dsp/denormal.h"
+#include "dsp/stats.h"
+#include "dsp/state.h"
+
 // ============================================================================
 // Configuration
 // ============================================================================
@@ -26,28 +62,81 @@
 #define NUM_CHANNELS 2
 #define NUM_PARAMETERS 4
 
+// Frames per pass when processOffline() works through a large block
+#define OFFLINE_CHUNK 1024
+
+// Delay applied before processing, e.g. so a limiter can see peaks coming.
+// Reported to the host through getLatency().
+#ifndef LOOKAHEAD_SAMPLES
+#define LOOKAHEAD_SAMPLES 0
+#endif
+
+// Snapshot identity; bump STATE_VERSION when transferState() changes
+#define STATE_PLUGIN_ID STATE_ID('A', 'E', 'F', 'X')
+#define STATE_VERSION 1
+
+// Delay history kept in snapshots: the longest delay read from the lines
+#define STATE_DELAY_SAMPLES LOOKAHEAD_SAMPLES
+
 // ============================================================================
 // Plugin State
 // ============================================================================
 
-static float sampleRate = 44100.0f;
-static int bufferSize = 128;
-
-// Parameters
-static float params[NUM_PARAMETERS] = {
+// Parameter defaults
+static const float defaultParams[NUM_PARAMETERS] = {
     1.0f,   // 0: Gain (0-2)
     0.5f,   // 1: Mix (0-1)
     1000.0f,// 2: Cutoff (20-20000)
     0.5f    // 3: Resonance (0-1)
 };
 
-// Internal state
-static float* delayBuffer = NULL;
-static int delayWritePos = 0;
-static int delayLength = 0;
+typedef struct {
+    float sampleRate;
+    int bufferSize;
+    
+    // Parameters
+    float params[NUM_PARAMETERS];
+    
+    // Parameter ramps started by setParameterRamp()
+    ParamRamp paramRamps[NUM_PARAMETERS];
+    int rampingParams; // Bit per parameter with an active ramp
+    
+    // Automation curves uploaded by the host
+    AutomationLane automation[NUM_PARAMETERS];
+    int automatedParams; // Bit per parameter with an active lane
+    
+    // Control rate: position in the control block, and gain and mix at the
+    // current frame with their per-sample steps to the end of the block
+    ControlClock control;
+    float gain;
+    float mix;
+    float gainStep;
+    float mixStep;
+    
+    // All buffers come from the arena, allocated in one block with the instance
+    Arena arena;
+    
+    // Lookahead delay lines (per channel), only allocated when LOOKAHEAD_SAMPLES > 0
+    DelayLine delayLines[NUM_CHANNELS];
+    int delayReady;
+    int silentFrames; // Consecutive silent input frames already in the delay lines
+    
+    // Filter state
+    float filterState[NUM_CHANNELS]; // Per channel
+    SmoothedCoeff lowpassCoeff;      // Shared by both channels
+    
+    // Set while input and state are silent and processing is skipped
+    int quiescent;
+    
+    // Plugin-owned planar I/O for processBuffers(), processed in place
+    float* ioBuffers[NUM_CHANNELS];
+    
+    // Timing and counters read through getProcessStats()
+    ProcessStats stats;
+} EffectInstance;
 
-// Filter state
-static float filterState[2] = {0.0f, 0.0f}; // Per channel
+// Instance used by the handle-less functions
+static EffectInstance* defaultInstance = NULL;
 
 // ============================================================================
 // Helper Functions
@@ -63,107 +152,842 @@ static inline float lerp(float a, float b, float t) {
     return a + (b - a) * t;
 }
 
+// Clamp a parameter to its valid range
+static float clampParameter(int index, float value) {
+    switch (index) {
+        case 0: // Gain
+            return clamp(value, 0.0f, 2.0f);
+        case 1: // Mix
+            return clamp(value, 0.0f, 1.0f);
+        case 2: // Cutoff
+            return clamp(value, 20.0f, 20000.0f);
+        case 3: // Resonance
+            return clamp(value, 0.0f, 1.0f);
+    }
+    return value;
+}
+
+// Move ramping parameters to their value numSamples frames on
+static void advanceParameterRamps(EffectInstance* fx, int numSamples) {
+    for (int i = 0; i < NUM_PARAMETERS; i++) {
+        if (!(fx->rampingParams & (1 << i))) continue;
+        
+        fx->params[i] = paramRampAdvance(&fx->paramRamps[i], fx->params[i], numSamples);
+        if (fx->paramRamps[i].remaining == 0) {
+            fx->rampingParams &= ~(1 << i);
+        }
+    }
+}
+
 // Simple one-pole lowpass filter
-static inline float lowpass(float input, float* state, float cutoff) {
-    float rc = 1.0f / (2.0f * 3.14159265f * cutoff);
-    float dt = 1.0f / sampleRate;
-    float alpha = dt / (rc + dt);
+static inline float lowpass(float input, float* state, float alpha) {
     *state = lerp(*state, input, alpha);
     return *state;
 }
 
-// ============================================================================
-// Core Functions
-// ============================================================================
+// Retarget the lowpass coefficient when the cutoff changed
+static inline void updateLowpassCoeff(EffectInstance* fx, float cutoff) {
+    if (smoothedCoeffChanged(&fx->lowpassCoeff, cutoff)) {
+        smoothedCoeffRampTo(&fx->lowpassCoeff, cutoff, onePoleLowpassCoeff(cutoff, fx->sampleRate));
+    }
+}
+
+// Ramp automated parameters to their curve's value at the end of the control block
+static void advanceAutomation(EffectInstance* fx) {
+    for (int i = 0; i < NUM_PARAMETERS; i++) {
+        if (!(fx->automatedParams & (1 << i))) continue;
+        
+        AutomationLane* lane = &fx->automation[i];
+        float value = clampParameter(i, automationLaneAdvance(lane, CONTROL_BLOCK_SIZE));
+        paramRampStart(&fx->paramRamps[i], fx->params[i], value, CONTROL_BLOCK_SIZE);
+        fx->rampingParams |= 1 << i;
+        if (!automationLaneActive(lane)) fx->automatedParams &= ~(1 << i);
+    }
+}
 
 /**
- * Initialize the plugin
+ * Control work at the start of a control block: advance the automation and
+ * ramps to their values at its end, step gain and mix towards them per
+ * sample and retarget the lowpass coefficient
  */
-void init(float sr, int bs) {
-    sampleRate = sr;
-    bufferSize = bs;
+static void beginControlBlock(EffectInstance* fx) {
+    // Land exactly where the previous block's steps were heading
+    fx->gain = fx->params[0];
+    fx->mix = fx->params[1];
+    fx->gainStep = 0.0f;
+    fx->mixStep = 0.0f;
     
-    // Allocate delay buffer (1 second max)
-    delayLength = (int)sampleRate;
-    delayBuffer = (float*)malloc(delayLength * NUM_CHANNELS * sizeof(float));
-    if (delayBuffer) {
-        memset(delayBuffer, 0, delayLength * NUM_CHANNELS * sizeof(float));
+    if (fx->automatedParams) advanceAutomation(fx);
+    if (fx->rampingParams) {
+        advanceParameterRamps(fx, CONTROL_BLOCK_SIZE);
+        fx->gainStep = (fx->params[0] - fx->gain) / CONTROL_BLOCK_SIZE;
+        fx->mixStep = (fx->params[1] - fx->mix) / CONTROL_BLOCK_SIZE;
     }
     
-    delayWritePos = 0;
-    filterState[0] = 0.0f;
-    filterState[1] = 0.0f;
+    // float resonance = fx->params[3]; // Not used in this simple example
+    updateLowpassCoeff(fx, fx->params[2]);
 }
 
 /**
- * Process audio
- * Input/output are interleaved stereo (L0, R0, L1, R1, ...)
+ * Span of up to numSamples frames to process next, within one control
+ * block; runs the control work first if the span starts one
  */
-void process(float* input, float* output, int numSamples) {
-    float gain = params[0];
-    float mix = params[1];
-    float cutoff = params[2];
-    // float resonance = params[3]; // Not used in this simple example
-    
-    for (int i = 0; i < numSamples; i++) {
-        for (int ch = 0; ch < NUM_CHANNELS; ch++) {
-            int idx = i * NUM_CHANNELS + ch;
-            float in = input[idx];
+static inline int nextControlSpan(EffectInstance* fx, int numSamples) {
+    if (controlClockAtBoundary(&fx->control)) beginControlBlock(fx);
+    return controlClockSpan(&fx->control, numSamples);
+}
+
+/**
+ * Run the control work of frames output as silence, leaving ramps where
+ * processing them would have and settling the coefficient ramp
+ */
+static void skipControlBlocks(EffectInstance* fx, int numSamples) {
+    for (int pos = 0; pos < numSamples;) {
+        int span = nextControlSpan(fx, numSamples - pos);
+        fx->gain += fx->gainStep * span;
+        fx->mix += fx->mixStep * span;
+        pos += span;
+        controlClockAdvance(&fx->control, span);
+    }
+    smoothedCoeffReset(&fx->lowpassCoeff, fx->lowpassCoeff.source, fx->lowpassCoeff.target);
+}
+
+// Route a sample through the lookahead delay of a channel
+static inline float lookahead(EffectInstance* fx, int ch, float input) {
+    if (LOOKAHEAD_SAMPLES == 0 || !fx->delayReady) return input;
+    
+    delayLineWrite(&fx->delayLines[ch], input);
+    return delayLineRead(&fx->delayLines[ch], LOOKAHEAD_SAMPLES);
+}
+
+/**
+ * If the input block, the delayed input and all filter state are silent,
+ * clear the state and return 1; the caller then outputs silence and skips
+ * processing with skipControlBlocks().
+ */
+static int enterIdle(EffectInstance* fx, int inputSilent, int frames) {
+    fx->quiescent = inputSilent && fx->silentFrames >= LOOKAHEAD_SAMPLES &&
+                    stateIsSilent(fx->filterState[0]) && stateIsSilent(fx->filterState[1]);
+    if (!fx->quiescent) {
+        fx->silentFrames = inputSilent ? fx->silentFrames + frames : 0;
+        return 0;
+    }
+    
+    fx->filterState[0] = 0.0f;
+    fx->filterState[1] = 0.0f;
+    return 1;
+}
+
+/**
+ * Arena bytes an instance needs: the I/O buffers plus, with lookahead, the
+ * delay lines holding LOOKAHEAD_SAMPLES of input
+ */
+static size_t arenaBytes(void) {
+    size_t ioBytes = arenaAlignedSize(MAX_BUFFER_SIZE * sizeof(float));
+    size_t delayBytes = LOOKAHEAD_SAMPLES > 0 ? delayLineBytes(LOOKAHEAD_SAMPLES) : 0;
+    return NUM_CHANNELS * (delayBytes + ioBytes);
+}
+
+/**
+ * Bytes of the block create() allocates: the instance, then its arena
+ */
+static size_t instanceBlockBytes(void) {
+    return arenaAlignedSize(sizeof(EffectInstance)) + arenaBytes();
+}
+
+/**
+ * Carve the instance's buffers out of its arena, from the start. Nothing is
+ * allocated, so this is safe to repeat on every init().
+ */
+static void allocateBuffers(EffectInstance* fx) {
+    size_t ioBytes = arenaAlignedSize(MAX_BUFFER_SIZE * sizeof(float));
+    
+    arenaReset(&fx->arena);
+    
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        fx->ioBuffers[ch] = (float*)arenaAlloc(&fx->arena, ioBytes);
+        if (fx->ioBuffers[ch]) memset(fx->ioBuffers[ch], 0, ioBytes);
+    }
+    
+    fx->delayReady = 1;
+    for (int ch = 0; ch < NUM_CHANNELS && LOOKAHEAD_SAMPLES > 0; ch++) {
+        fx->delayReady = delayLineInit(&fx->delayLines[ch], &fx->arena, LOOKAHEAD_SAMPLES) && fx->delayReady;
+    }
+}
+
+static void processInterleaved(EffectInstance* fx, float* input, float* output, int numSamples) {
+    if (enterIdle(fx, bufferIsSilent(input, numSamples * NUM_CHANNELS), numSamples)) {
+        skipControlBlocks(fx, numSamples);
+        memset(output, 0, numSamples * NUM_CHANNELS * sizeof(float));
+        return;
+    }
+    
+    for (int pos = 0; pos < numSamples;) {
+        int span = nextControlSpan(fx, numSamples - pos);
+        float gain = fx->gain;
+        float mix = fx->mix;
+        
+        for (int i = pos; i < pos + span; i++) {
+            float alpha = smoothedCoeffNext(&fx->lowpassCoeff);
             
-            // Apply lowpass filter
-            float filtered = lowpass(in, &filterState[ch], cutoff);
+            for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+                int idx = i * NUM_CHANNELS + ch;
+                float in = lookahead(fx, ch, input[idx]);
+                
+                // Apply lowpass filter
+                float filtered = lowpass(in, &fx->filterState[ch], alpha);
+                
+                // Mix dry/wet
+                float processed = lerp(in, filtered, mix);
+                
+                // Apply gain
+                output[idx] = processed * gain;
+            }
             
-            // Mix dry/wet
-            float processed = lerp(in, filtered, mix);
+            gain += fx->gainStep;
+            mix += fx->mixStep;
+        }
+        
+        fx->gain = gain;
+        fx->mix = mix;
+        pos += span;
+        controlClockAdvance(&fx->control, span);
+    }
+    
+    flushDenormals(fx->filterState, NUM_CHANNELS);
+}
+
+/**
+ * Output silence and skip processing if a planar block leaves the plugin
+ * quiescent (see enterIdle()). Returns 1 if so.
+ */
+static int skipIdlePlanar(EffectInstance* fx, float* const* inputs, float* const* outputs,
+                          int numSamples, int numChannels) {
+    int inputSilent = 1;
+    for (int ch = 0; ch < numChannels; ch++) {
+        inputSilent = inputSilent && bufferIsSilent(inputs[ch], numSamples);
+    }
+    if (!enterIdle(fx, inputSilent, numSamples)) return 0;
+    
+    skipControlBlocks(fx, numSamples);
+    for (int ch = 0; ch < numChannels; ch++) {
+        memset(outputs[ch], 0, numSamples * sizeof(float));
+    }
+    return 1;
+}
+
+/**
+ * Process a planar block that is not skipped as idle
+ */
+static void processPlanarActive(EffectInstance* fx, float* const* inputs, float* const* outputs,
+                                int numSamples, int numChannels) {
+    for (int pos = 0; pos < numSamples;) {
+        int span = nextControlSpan(fx, numSamples - pos);
+        float gain = fx->gain;
+        float mix = fx->mix;
+        
+        // Every channel replays the same coefficient ramp
+        SmoothedCoeff spanStart = fx->lowpassCoeff;
+        
+        for (int ch = 0; ch < numChannels; ch++) {
+            const float* inCh = inputs[ch] + pos;
+            float* outCh = outputs[ch] + pos;
+            
+            fx->lowpassCoeff = spanStart;
+            gain = fx->gain;
+            mix = fx->mix;
             
-            // Apply gain
-            output[idx] = processed * gain;
+            for (int i = 0; i < span; i++) {
+                float in = lookahead(fx, ch, inCh[i]);
+                float filtered = lowpass(in, &fx->filterState[ch], smoothedCoeffNext(&fx->lowpassCoeff));
+                float processed = lerp(in, filtered, mix);
+                outCh[i] = processed * gain;
+                gain += fx->gainStep;
+                mix += fx->mixStep;
+            }
         }
+        
+        fx->gain = gain;
+        fx->mix = mix;
+        pos += span;
+        controlClockAdvance(&fx->control, span);
+    }
+    
+    flushDenormals(fx->filterState, numChannels);
+}
+
+/**
+ * Planar processing shared by processBlock() and processBuffers().
+ * inputs[ch] may equal outputs[ch] (in-place).
+ */
+static void processPlanar(EffectInstance* fx, float* const* inputs, float* const* outputs,
+                          int numSamples, int numChannels) {
+    if (numChannels > NUM_CHANNELS) numChannels = NUM_CHANNELS;
+    
+    if (!skipIdlePlanar(fx, inputs, outputs, numSamples, numChannels)) {
+        processPlanarActive(fx, inputs, outputs, numSamples, numChannels);
+    }
+}
+
+// ============================================================================
+// Batched Processing
+// ============================================================================
+
+/**
+ * One control span of processPlanarActive() on the I/O buffers of up to
+ * SIMD_LANES instances whose control clocks are in step, one instance per
+ * vector lane. Each lane computes exactly what processPlanarActive() would.
+ */
+static void processLanesSpan(EffectInstance* const* lanes, int count, int pos, int span, int numChannels) {
+    DSP_ALIGNED float gain[SIMD_LANES];
+    DSP_ALIGNED float mix[SIMD_LANES];
+    DSP_ALIGNED float gainStep[SIMD_LANES];
+    DSP_ALIGNED float mixStep[SIMD_LANES];
+    DSP_ALIGNED float coeff[SIMD_LANES];
+    DSP_ALIGNED float coeffStep[SIMD_LANES];
+    DSP_ALIGNED float coeffTarget[SIMD_LANES];
+    DSP_ALIGNED float countdown[SIMD_LANES];
+    DSP_ALIGNED float lane[SIMD_LANES];
+    
+    // Unused lanes repeat the first instance and are never written back
+    for (int l = 0; l < SIMD_LANES; l++) {
+        const EffectInstance* fx = lanes[l < count ? l : 0];
+        gain[l] = fx->gain;
+        mix[l] = fx->mix;
+        gainStep[l] = fx->gainStep;
+        mixStep[l] = fx->mixStep;
+        coeff[l] = fx->lowpassCoeff.value;
+        coeffStep[l] = fx->lowpassCoeff.step;
+        coeffTarget[l] = fx->lowpassCoeff.target;
+        countdown[l] = (float)fx->lowpassCoeff.countdown;
+    }
+    
+    f32x4 gainStepV = f32x4Load(gainStep);
+    f32x4 mixStepV = f32x4Load(mixStep);
+    f32x4 coeffStepV = f32x4Load(coeffStep);
+    f32x4 coeffTargetV = f32x4Load(coeffTarget);
+    f32x4 countdownV = f32x4Load(countdown);
+    f32x4 gainV = f32x4Load(gain);
+    f32x4 mixV = f32x4Load(mix);
+    f32x4 coeffV = f32x4Load(coeff);
+    
+    for (int ch = 0; ch < numChannels; ch++) {
+        // Every channel replays the same ramps
+        gainV = f32x4Load(gain);
+        mixV = f32x4Load(mix);
+        coeffV = f32x4Load(coeff);
+        
+        for (int l = 0; l < SIMD_LANES; l++) lane[l] = lanes[l < count ? l : 0]->filterState[ch];
+        f32x4 state = f32x4Load(lane);
+        
+        for (int i = pos; i < pos + span; i++) {
+            for (int l = 0; l < count; l++) lane[l] = lookahead(lanes[l], ch, lanes[l]->ioBuffers[ch][i]);
+            f32x4 in = f32x4Load(lane);
+            
+            // smoothedCoeffNext(): this frame's coefficient, then one step of
+            // the ramp, landing on the target on its last frame
+            f32x4 alpha = coeffV;
+            f32x4 frame = f32x4Splat((float)(i - pos));
+            f32x4 nextFrame = f32x4Splat((float)(i - pos + 1));
+            coeffV = f32x4Select(f32x4Gt(countdownV, nextFrame), f32x4Add(coeffV, coeffStepV),
+                                 f32x4Select(f32x4Gt(countdownV, frame), coeffTargetV, coeffV));
+            
+            // lowpass(), then lerp() between dry and filtered, then gain
+            state = f32x4Add(state, f32x4Mul(f32x4Sub(in, state), alpha));
+            f32x4 processed = f32x4Add(in, f32x4Mul(f32x4Sub(state, in), mixV));
+            f32x4Store(lane, f32x4Mul(processed, gainV));
+            for (int l = 0; l < count; l++) lanes[l]->ioBuffers[ch][i] = lane[l];
+            
+            gainV = f32x4Add(gainV, gainStepV);
+            mixV = f32x4Add(mixV, mixStepV);
+        }
+        
+        f32x4Store(lane, state);
+        for (int l = 0; l < count; l++) lanes[l]->filterState[ch] = lane[l];
+    }
+    
+    f32x4Store(gain, gainV);
+    f32x4Store(mix, mixV);
+    f32x4Store(coeff, coeffV);
+    for (int l = 0; l < count; l++) {
+        EffectInstance* fx = lanes[l];
+        fx->gain = gain[l];
+        fx->mix = mix[l];
+        fx->lowpassCoeff.value = coeff[l];
+        fx->lowpassCoeff.countdown = fx->lowpassCoeff.countdown > span ? fx->lowpassCoeff.countdown - span : 0;
+    }
+}
+
+/**
+ * processPlanarActive() on the I/O buffers of up to SIMD_LANES instances
+ * whose control clocks are in step
+ */
+static void processLanes(EffectInstance* const* lanes, int count, int numSamples, int numChannels) {
+    for (int pos = 0; pos < numSamples;) {
+        // In step, so every lane starts and ends its control blocks together
+        int span = 0;
+        for (int l = 0; l < count; l++) span = nextControlSpan(lanes[l], numSamples - pos);
+        
+        processLanesSpan(lanes, count, pos, span, numChannels);
+        for (int l = 0; l < count; l++) controlClockAdvance(&lanes[l]->control, span);
+        pos += span;
     }
+    
+    for (int l = 0; l < count; l++) flushDenormals(lanes[l]->filterState, numChannels);
+}
+
+// ============================================================================
+// Instance Functions
+// ============================================================================
+
+/**
+ * (Re)initialize an instance for a sample rate and block size
+ */
+static void instanceInit(EffectInstance* fx, float sr, int bs) {
+    fx->sampleRate = sr;
+    fx->bufferSize = bs;
+    memset(&fx->stats, 0, sizeof(fx->stats));
+    controlClockReset(&fx->control);
+    
+    allocateBuffers(fx);
+    fx->silentFrames = LOOKAHEAD_SAMPLES;
+    
+    fx->filterState[0] = 0.0f;
+    fx->filterState[1] = 0.0f;
+    smoothedCoeffReset(&fx->lowpassCoeff, fx->params[2], onePoleLowpassCoeff(fx->params[2], fx->sampleRate));
+}
+
+/**
+ * Create a plugin instance. Returns a handle for the instance*() functions,
+ * or 0 if out of memory.
+ */
+EffectInstance* create(float sr, int bs) {
+    uint8_t* block = (uint8_t*)aligned_alloc(SIMD_ALIGN, instanceBlockBytes());
+    if (!block) return NULL;
+    
+    EffectInstance* fx = (EffectInstance*)block;
+    memset(fx, 0, sizeof(EffectInstance));
+    arenaInit(&fx->arena, block + arenaAlignedSize(sizeof(EffectInstance)), arenaBytes());
+    memcpy(fx->params, defaultParams, sizeof(defaultParams));
+    instanceInit(fx, sr, bs);
+    return fx;
+}
+
+/**
+ * Free an instance and its buffers
+ */
+void destroy(EffectInstance* fx) {
+    if (!fx) return;
+    if (fx == defaultInstance) defaultInstance = NULL;
+    
+    free(fx);
+}
+
+/**
+ * Process audio
+ * Input/output are interleaved stereo (L0, R0, L1, R1, ...)
+ */
+void instanceProcess(EffectInstance* fx, float* input, float* output, int numSamples) {
+    double start = statsBlockBegin();
+    processInterleaved(fx, input, output, numSamples);
+    statsBlockEnd(&fx->stats, start, numSamples, fx->sampleRate);
 }
 
 /**
  * Process audio with separate channel buffers
  * Alternative processing function for non-interleaved audio
  */
-void processBlock(float* input, float* output, int numSamples, int numChannels) {
-    float gain = params[0];
-    float mix = params[1];
-    float cutoff = params[2];
+void instanceProcessBlock(EffectInstance* fx, float* input, float* output, int numSamples, int numChannels) {
+    float* in[NUM_CHANNELS];
+    float* out[NUM_CHANNELS];
+    double start = statsBlockBegin();
+    
+    if (numChannels > NUM_CHANNELS) numChannels = NUM_CHANNELS;
+    for (int ch = 0; ch < numChannels; ch++) {
+        in[ch] = input + ch * numSamples;
+        out[ch] = output + ch * numSamples;
+    }
+    
+    processPlanar(fx, in, out, numSamples, numChannels);
+    statsBlockEnd(&fx->stats, start, numSamples, fx->sampleRate);
+}
+
+/**
+ * Process an arbitrarily long planar block for offline rendering.
+ * input/output hold numChannels runs of numSamples samples (as for
+ * processBlock()) and may be the same memory. Works through the block in
+ * OFFLINE_CHUNK passes so silence detection behaves as it does for realtime
+ * blocks. Not counted in getProcessStats(), which
+ * measures realtime load.
+ */
+void instanceProcessOffline(EffectInstance* fx, float* input, float* output, int numSamples, int numChannels) {
+    float* in[NUM_CHANNELS];
+    float* out[NUM_CHANNELS];
+    
+    if (numChannels > NUM_CHANNELS) numChannels = NUM_CHANNELS;
+    
+    for (int offset = 0; offset < numSamples; offset += OFFLINE_CHUNK) {
+        int count = numSamples - offset;
+        if (count > OFFLINE_CHUNK) count = OFFLINE_CHUNK;
+        
+        for (int ch = 0; ch < numChannels; ch++) {
+            in[ch] = input + ch * numSamples + offset;
+            out[ch] = output + ch * numSamples + offset;
+        }
+        processPlanar(fx, in, out, count, numChannels);
+    }
+}
+
+/**
+ * Planar input buffer for channel ch, 16-byte aligned and owned by the
+ * plugin. Holds up to MAX_BUFFER_SIZE samples.
+ */
+float* instanceGetInputBuffer(EffectInstance* fx, int ch) {
+    if (ch < 0 || ch >= NUM_CHANNELS) return NULL;
+    return fx->ioBuffers[ch];
+}
+
+/**
+ * Planar output buffer for channel ch. Processing is in place, so this is
+ * the same memory as getInputBuffer(ch).
+ */
+float* instanceGetOutputBuffer(EffectInstance* fx, int ch) {
+    return instanceGetInputBuffer(fx, ch);
+}
+
+/**
+ * Process the plugin-owned buffers in place. The host writes each channel
+ * into getInputBuffer(ch) and reads the result from getOutputBuffer(ch).
+ */
+void instanceProcessBuffers(EffectInstance* fx, int numSamples, int numChannels) {
+    if (numSamples > MAX_BUFFER_SIZE) numSamples = MAX_BUFFER_SIZE;
+    if (numChannels > NUM_CHANNELS) numChannels = NUM_CHANNELS;
+    for (int ch = 0; ch < numChannels; ch++) {
+        if (!fx->ioBuffers[ch]) return;
+    }
+    
+    double start = statsBlockBegin();
+    processPlanar(fx, fx->ioBuffers, fx->ioBuffers, numSamples, numChannels);
+    statsBlockEnd(&fx->stats, start, numSamples, fx->sampleRate);
+}
+
+/**
+ * instanceProcessBuffers() for count instances in one call, e.g. the same
+ * effect inserted on many mixer channels. Instances whose control clocks
+ * are in step (always, for hosts whose blocks are multiples of
+ * CONTROL_BLOCK_SIZE) are processed SIMD_LANES at a time, one per vector
+ * lane, with the same result as processing each on its own. Each instance's
+ * stats record an even share of the batch.
+ */
+void processBatch(EffectInstance** instances, int count, int numSamples, int numChannels) {
+    EffectInstance* lanes[SIMD_LANES];
+    int laneCount = 0;
+    double start = statsBlockBegin();
     
-    for (int ch = 0; ch < numChannels && ch < NUM_CHANNELS; ch++) {
-        float* inCh = input + ch * numSamples;
-        float* outCh = output + ch * numSamples;
+    if (numSamples > MAX_BUFFER_SIZE) numSamples = MAX_BUFFER_SIZE;
+    if (numChannels > NUM_CHANNELS) numChannels = NUM_CHANNELS;
+    
+    for (int n = 0; n < count; n++) {
+        EffectInstance* fx = instances[n];
+        if (!fx) continue;
+        
+        int ready = 1;
+        for (int ch = 0; ch < numChannels; ch++) {
+            ready = ready && fx->ioBuffers[ch];
+        }
+        if (!ready || skipIdlePlanar(fx, fx->ioBuffers, fx->ioBuffers, numSamples, numChannels)) continue;
         
-        for (int i = 0; i < numSamples; i++) {
-            float in = inCh[i];
-            float filtered = lowpass(in, &filterState[ch], cutoff);
-            float processed = lerp(in, filtered, mix);
-            outCh[i] = processed * gain;
+        if (laneCount > 0 && fx->control.position != lanes[0]->control.position) {
+            processPlanarActive(fx, fx->ioBuffers, fx->ioBuffers, numSamples, numChannels);
+            continue;
+        }
+        lanes[laneCount++] = fx;
+        if (laneCount == SIMD_LANES) {
+            processLanes(lanes, laneCount, numSamples, numChannels);
+            laneCount = 0;
         }
     }
+    
+    if (laneCount == 1) {
+        processPlanarActive(lanes[0], lanes[0]->ioBuffers, lanes[0]->ioBuffers, numSamples, numChannels);
+    } else if (laneCount > 1) {
+        processLanes(lanes, laneCount, numSamples, numChannels);
+    }
+    
+    float share = count > 0 ? statsElapsedMs(start) / count : 0.0f;
+    for (int n = 0; n < count; n++) {
+        if (instances[n]) statsBlockRecord(&instances[n]->stats, share, numSamples, instances[n]->sampleRate);
+    }
 }
 
 /**
  * Reset plugin state
  */
-void reset() {
-    if (delayBuffer) {
-        memset(delayBuffer, 0, delayLength * NUM_CHANNELS * sizeof(float));
+void instanceReset(EffectInstance* fx) {
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        delayLineClear(&fx->delayLines[ch]);
+    }
+    fx->silentFrames = LOOKAHEAD_SAMPLES;
+    fx->filterState[0] = 0.0f;
+    fx->filterState[1] = 0.0f;
+    fx->quiescent = 0;
+    fx->automatedParams = 0;
+    controlClockReset(&fx->control);
+}
+
+float instanceGetParameter(EffectInstance* fx, int index) {
+    if (index >= 0 && index < NUM_PARAMETERS) {
+        return fx->params[index];
+    }
+    return 0.0f;
+}
+
+void instanceSetParameter(EffectInstance* fx, int index, float value) {
+    if (index >= 0 && index < NUM_PARAMETERS) {
+        float clamped = clampParameter(index, value);
+        if (clamped != fx->params[index]) fx->stats.parameterChanges++;
+        fx->params[index] = clamped;
+        
+        // A direct set cancels any ramp or automation in progress and holds
+        // from the next frame
+        paramRampStop(&fx->paramRamps[index]);
+        fx->rampingParams &= ~(1 << index);
+        fx->automatedParams &= ~(1 << index);
+        if (index == 0) {
+            fx->gain = clamped;
+            fx->gainStep = 0.0f;
+        } else if (index == 1) {
+            fx->mix = clamped;
+            fx->mixStep = 0.0f;
+        }
     }
-    delayWritePos = 0;
-    filterState[0] = 0.0f;
-    filterState[1] = 0.0f;
+}
+
+/**
+ * Ramp a parameter linearly to target over durationSamples, advanced by
+ * process()/processBlock() from the next control block on. A duration of 0
+ * or less sets it immediately.
+ */
+void instanceSetParameterRamp(EffectInstance* fx, int index, float target, int durationSamples) {
+    if (index < 0 || index >= NUM_PARAMETERS) return;
+    
+    if (durationSamples <= 0) {
+        instanceSetParameter(fx, index, target);
+        return;
+    }
+    
+    paramRampStart(&fx->paramRamps[index], fx->params[index], clampParameter(index, target), durationSamples);
+    fx->rampingParams |= 1 << index;
+    fx->automatedParams &= ~(1 << index);
+    fx->stats.parameterChanges++;
+}
+
+/**
+ * Breakpoint buffer of a parameter's automation lane, holding up to
+ * getAutomationCapacity() points. Write the points, then call setAutomation().
+ */
+AutomationPoint* instanceGetAutomationBuffer(EffectInstance* fx, int index) {
+    if (index < 0 || index >= NUM_PARAMETERS) return NULL;
+    return fx->automation[index].points;
+}
+
+/**
+ * Automate a parameter with the first count points of its buffer, which
+ * count frames from the next frame processed. The curve takes over from the
+ * next control block and ends at its last point; a count of 0, setParameter()
+ * or setParameterRamp() stops it.
+ */
+void instanceSetAutomation(EffectInstance* fx, int index, int count) {
+    if (index < 0 || index >= NUM_PARAMETERS) return;
+    
+    int toBoundary = (CONTROL_BLOCK_SIZE - fx->control.position) % CONTROL_BLOCK_SIZE;
+    automationLaneStart(&fx->automation[index], count, toBoundary);
+    if (automationLaneActive(&fx->automation[index])) {
+        fx->automatedParams |= 1 << index;
+    } else {
+        fx->automatedParams &= ~(1 << index);
+    }
+}
+
+/**
+ * Get plugin latency in samples
+ */
+int instanceGetLatency(EffectInstance* fx) {
+    return fx->delayReady ? LOOKAHEAD_SAMPLES : 0;
+}
+
+/**
+ * Returns 1 if the last block was silent and the plugin will keep producing
+ * silence for silent input, so the host may skip calling process()
+ */
+int instanceIsQuiescent(EffectInstance* fx) {
+    return fx->quiescent;
+}
+
+/**
+ * Processing statistics (see dsp/stats.h). The pointer stays valid until
+ * destroy(); the host reads the struct straight from memory.
+ */
+ProcessStats* instanceGetProcessStats(EffectInstance* fx) {
+    return &fx->stats;
+}
+
+// ============================================================================
+// State Snapshots
+// ============================================================================
+
+/**
+ * Copy the newest STATE_DELAY_SAMPLES of a delay line, oldest first. Loading
+ * clears what is older, which no read reaches.
+ */
+static void transferDelayHistory(DelayLine* line, StateCursor* c) {
+    if (c->direction == STATE_LOAD) delayLineClear(line);
+
+    for (uint32_t i = STATE_DELAY_SAMPLES; i > 0; i--) {
+        float sample = 0.0f;
+        float* slot = line->buffer ? &line->buffer[(line->writePos - i) & line->mask] : &sample;
+        stateBytes(c, slot, sizeof(float));
+    }
+}
+
+/**
+ * Visit the DSP state kept in snapshots, in layout order. Parameters are
+ * stored ahead of it; the I/O buffers are rebuilt by
+ * init() and stats start over.
+ */
+static void transferState(EffectInstance* fx, StateCursor* c) {
+    STATE_FIELD(c, fx->paramRamps);
+    STATE_FIELD(c, fx->rampingParams);
+    STATE_FIELD(c, fx->control);
+    STATE_FIELD(c, fx->gain);
+    STATE_FIELD(c, fx->mix);
+    STATE_FIELD(c, fx->gainStep);
+    STATE_FIELD(c, fx->mixStep);
+    STATE_FIELD(c, fx->silentFrames);
+    STATE_FIELD(c, fx->filterState);
+    STATE_FIELD(c, fx->lowpassCoeff);
+    STATE_FIELD(c, fx->quiescent);
+
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        transferDelayHistory(&fx->delayLines[ch], c);
+    }
+}
+
+static uint32_t dspStateSize(EffectInstance* fx) {
+    StateCursor c;
+    stateCursorInit(&c, NULL, STATE_MEASURE);
+    transferState(fx, &c);
+    return c.pos;
+}
+
+/**
+ * Bytes saveState() writes
+ */
+int instanceGetStateSize(EffectInstance* fx) {
+    return (int)stateSize(NUM_PARAMETERS, dspStateSize(fx));
+}
+
+/**
+ * Write a snapshot of the instance to data, which must hold getStateSize()
+ * bytes. Returns the bytes written.
+ */
+int instanceSaveState(EffectInstance* fx, void* data) {
+    uint32_t size = stateSize(NUM_PARAMETERS, dspStateSize(fx));
+    StateCursor c;
+    stateBeginSave(&c, data, STATE_PLUGIN_ID, STATE_VERSION, fx->params, NUM_PARAMETERS, size, fx->sampleRate);
+    transferState(fx, &c);
+    return (int)size;
+}
+
+/**
+ * Restore a snapshot of length bytes from saveState(). The parameters are
+ * always restored; the DSP state only when the snapshot was taken at the
+ * current sample rate by a build with the same layout, otherwise the
+ * instance is reset. Returns 1 on success, 0 if data is not a snapshot of
+ * this effect (the instance is left unchanged).
+ */
+int instanceLoadState(EffectInstance* fx, const void* data, int length) {
+    StateHeader header;
+    if (!stateReadHeader(&header, data, length, STATE_PLUGIN_ID, NUM_PARAMETERS)) return 0;
+
+    for (int i = 0; i < NUM_PARAMETERS; i++) {
+        instanceSetParameter(fx, i, stateParameter(data, i));
+    }
+
+    StateCursor c;
+    if (stateBeginLoad(&c, &header, data, STATE_VERSION, dspStateSize(fx), fx->sampleRate)) {
+        transferState(fx, &c);
+    } else {
+        instanceReset(fx);
+        smoothedCoeffReset(&fx->lowpassCoeff, fx->params[2], onePoleLowpassCoeff(fx->params[2], fx->sampleRate));
+    }
+    return 1;
+}
+
+// ============================================================================
+// Core Functions (default instance)
+// ============================================================================
+
+// Default instance, created on first use
+static EffectInstance* getDefaultInstance() {
+    if (!defaultInstance) {
+        defaultInstance = create(44100.0f, 128);
+    }
+    return defaultInstance;
+}
+
+/**
+ * Initialize the plugin
+ */
+void init(float sr, int bs) {
+    if (defaultInstance) {
+        instanceInit(defaultInstance, sr, bs);
+    } else {
+        defaultInstance = create(sr, bs);
+    }
+}
+
+void process(float* input, float* output, int numSamples) {
+    EffectInstance* fx = getDefaultInstance();
+    if (fx) instanceProcess(fx, input, output, numSamples);
+}
+
+void processBlock(float* input, float* output, int numSamples, int numChannels) {
+    EffectInstance* fx = getDefaultInstance();
+    if (fx) instanceProcessBlock(fx, input, output, numSamples, numChannels);
+}
+
+void processOffline(float* input, float* output, int numSamples, int numChannels) {
+    EffectInstance* fx = getDefaultInstance();
+    if (fx) instanceProcessOffline(fx, input, output, numSamples, numChannels);
+}
+
+float* getInputBuffer(int ch) {
+    EffectInstance* fx = getDefaultInstance();
+    return fx ? instanceGetInputBuffer(fx, ch) : NULL;
+}
+
+float* getOutputBuffer(int ch) {
+    return getInputBuffer(ch);
+}
+
+void processBuffers(int numSamples, int numChannels) {
+    EffectInstance* fx = getDefaultInstance();
+    if (fx) instanceProcessBuffers(fx, numSamples, numChannels);
+}
+
+/**
+ * Reset plugin state
+ */
+void reset() {
+    if (defaultInstance) instanceReset(defaultInstance);
 }
 
 /**
  * Clean up resources
  */
 void dispose() {
-    if (delayBuffer) {
-        free(delayBuffer);
-        delayBuffer = NULL;
-    }
+    destroy(defaultInstance);
 }
 
 // ============================================================================
@@ -181,33 +1005,35 @@ int getParameterCount() {
  * Get parameter value
  */
 float getParameter(int index) {
-    if (index >= 0 && index < NUM_PARAMETERS) {
-        return params[index];
-    }
-    return 0.0f;
+    EffectInstance* fx = getDefaultInstance();
+    return fx ? instanceGetParameter(fx, index) : 0.0f;
 }
 
 /**
  * Set parameter value
  */
 void setParameter(int index, float value) {
-    if (index >= 0 && index < NUM_PARAMETERS) {
-        // Clamp to valid ranges
-        switch (index) {
-            case 0: // Gain
-                params[0] = clamp(value, 0.0f, 2.0f);
-                break;
-            case 1: // Mix
-                params[1] = clamp(value, 0.0f, 1.0f);
-                break;
-            case 2: // Cutoff
-                params[2] = clamp(value, 20.0f, 20000.0f);
-                break;
-            case 3: // Resonance
-                params[3] = clamp(value, 0.0f, 1.0f);
-                break;
-        }
-    }
+    EffectInstance* fx = getDefaultInstance();
+    if (fx) instanceSetParameter(fx, index, value);
+}
+
+void setParameterRamp(int index, float target, int durationSamples) {
+    EffectInstance* fx = getDefaultInstance();
+    if (fx) instanceSetParameterRamp(fx, index, target, durationSamples);
+}
+
+AutomationPoint* getAutomationBuffer(int index) {
+    EffectInstance* fx = getDefaultInstance();
+    return fx ? instanceGetAutomationBuffer(fx, index) : NULL;
+}
+
+int getAutomationCapacity() {
+    return AUTOMATION_MAX_POINTS;
+}
+
+void setAutomation(int index, int count) {
+    EffectInstance* fx = getDefaultInstance();
+    if (fx) instanceSetAutomation(fx, index, count);
 }
 
 // ============================================================================
@@ -218,12 +1044,49 @@ void setParameter(int index, float value) {
  * Get plugin latency in samples
  */
 int getLatency() {
-    return 0; // This effect has no latency
+    return defaultInstance ? instanceGetLatency(defaultInstance) : 0;
+}
+
+int isQuiescent() {
+    return defaultInstance ? instanceIsQuiescent(defaultInstance) : 1;
+}
+
+ProcessStats* getProcessStats() {
+    EffectInstance* fx = getDefaultInstance();
+    return fx ? instanceGetProcessStats(fx) : NULL;
+}
+
+int getStateSize() {
+    EffectInstance* fx = getDefaultInstance();
+    return fx ? instanceGetStateSize(fx) : 0;
+}
+
+int saveState(void* data) {
+    EffectInstance* fx = getDefaultInstance();
+    return fx ? instanceSaveState(fx, data) : 0;
+}
+
+int loadState(const void* data, int length) {
+    EffectInstance* fx = getDefaultInstance();
+    return fx ? instanceLoadState(fx, data, length) : 0;
 }
 
 /**
  * Get sample rate
  */
 float getSampleRate() {
-    return sampleRate;
-}
\ No newline at end of file
+    return defaultInstance ? defaultInstance->sampleRate : 44100.0f;
+}
+
+/**
+ * Heap bytes one instance created with create(sampleRate, maxBlock) takes,
+ * so the host can size WASM memory up front and never grow it while audio
+ * runs. The figure covers the instance and all of its buffers; the I/O
+ * buffers hold MAX_BUFFER_SIZE frames whatever maxBlock is, and the delay
+ * lines only LOOKAHEAD_SAMPLES, so the figure is the same at every rate.
+ */
+int getRequiredMemory(float sampleRate, int maxBlock) {
+    (void)sampleRate;
+    (void)maxBlock;
+    return (int)heapBlockBytes(instanceBlockBytes());
+}
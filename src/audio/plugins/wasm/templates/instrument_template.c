@@ -3,32 +3,134 @@
  */
 /**
  * WASM Instrument Plugin Template
- * 
+ *
  * This is a template for creating synthesizer/instrument plugins for AnkhWaveStudio.
  * Compile with Emscripten:
- * 
+ *
  * emcc instrument_template.c -o my_synth.wasm \
  *   -s WASM=1 \
- *   -s EXPORTED_FUNCTIONS='["_init","_process","_dispose","_reset","_getParameterCount","_getParameter","_setParameter","_noteOn","_noteOff","_controlChange","_pitchBend","_malloc","_free"]' \
- *   -s ALLOW_MEMORY_GROWTH=1 \
+ *   -s EXPORTED_FUNCTIONS='["_init","_process","_dispose","_reset","_getParameterCount","_getParameter","_setParameter","_noteOn","_noteOff","_controlChange","_pitchBend","_isQuiescent","_getActiveVoiceCount","_processWithEvents","_getEventBuffer","_getEventBufferCapacity","_processOffline","_loadWavetable","_getProcessStats","_getAutomationBuffer","_getAutomationCapacity","_setAutomation","_getStateSize","_saveState","_loadState","_getRequiredMemory","_create","_destroy","_instanceProcess","_instanceProcessWithEvents","_instanceProcessOffline","_instanceGetEventBuffer","_instanceReset","_instanceNoteOn","_instanceNoteOff","_instanceControlChange","_instancePitchBend","_instanceGetParameter","_instanceSetParameter","_instanceIsQuiescent","_instanceGetActiveVoiceCount","_instanceLoadWavetable","_instanceGetProcessStats","_instanceGetAutomationBuffer","_instanceSetAutomation","_instanceGetStateSize","_instanceSaveState","_instanceLoadState","_malloc","_free"]' \
+ *   -s IMPORTED_MEMORY=1 -s INITIAL_MEMORY=2MB \
+ *   -msimd128 \
  *   -O3 \
  *   -lm
+ *
+ * Built with -DRENDER_THREADS=N (plus -matomics -mbulk-memory and shared,
+ * imported memory, see README.md) voice groups can also render on N helper
+ * threads the host runs in Web Workers. Add "_getRenderThreadCount",
+ * "_renderThreadStack", "_renderThreadRun" and "_stopRenderThreads" to the
+ * exported functions.
+ *
+ * Voices are stored as a structure of arrays and rendered four at a time
+ * (one voice per SIMD lane). Without -msimd128 the same code falls back to
+ * portable scalar lanes. With unison above 1 each voice plays on that many
+ * consecutive lanes, detuned and panned across the stereo field, so polyphony
+ * becomes MAX_VOICES / unison.
+ *
+ * Oscillators read from band-limited mipmapped wavetables built in init().
+ * Built with -DNUM_CUSTOM_WAVETABLES=<n>, custom single-cycle waveforms can
+ * be loaded into n more slots with loadWavetable() and selected as waveforms
+ * WAVE_CUSTOM and up.
+ *
+ * MIDI can either be sent with the individual noteOn()/noteOff()/... calls,
+ * applied at block boundaries, or as a timestamped event buffer passed to
+ * processWithEvents(), applied at the exact sample.
+ *
+ * All per-instance state lives in an InstrumentInstance, so one module and
+ * one memory can host any number of plugin instances: create() returns a
+ * handle that is passed to the instance*() functions, while the built-in
+ * wavetables are built once and shared. The handle-less functions (init,
+ * process, noteOn, ...) operate on a default instance.
+ *
+ * Automation curves uploaded with setAutomation() are evaluated every
+ * control block (see dsp/automation.h).
+ *
+ * saveState() captures an instance, playing voices included, in one block
+ * that loadState() restores (see dsp/state.h). Custom wavetables are not
+ * part of it; the host loads them again.
+ *
+ * getRequiredMemory() reports the heap an instance takes before it exists,
+ * so the host can size WASM memory once instead of growing it later. Build
+ * with IMPORTED_MEMORY and without ALLOW_MEMORY_GROWTH, as above: the host
+ * then creates the memory and is the only one growing it.
  */
 
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 
+// Helper threads for voice rendering, 0 for a single-threaded build (see
+// Render Threads below)
+#ifndef RENDER_THREADS
+#define RENDER_THREADS 0
+#endif
+
+#include "dsp/simd.h"
+#include "dsp/fastmath.h"
+#include "dsp/control.h"
+#include "dsp/coefficients.h"
+#include "dsp/wavetable.h"
+#include "dsp/events.h"
+#include "dsp/automation.h"
+#include "dsp/envelope.h"
+#include "dsp/noise.h"
+#include "dsp/saturation.h"
+#include "dsp/arena.h"
+#include "dsp/denormal.h"
+#include "dsp/stats.h"
+#include "dsp/state.h"
+#if RENDER_THREADS
+#include "dsp/renderpool.h"
+#endif
+
 // ============================================================================
 // Configuration
 // ============================================================================
 
+// Polyphony can be raised at build time, e.g. -DMAX_VOICES=64
+#ifndef MAX_VOICES
 #define MAX_VOICES 16
+#endif
+
 #define NUM_CHANNELS 2
-#define NUM_PARAMETERS 8
+#define NUM_PARAMETERS 13
+#define NUM_MIDI_NOTES 128
 #define PI 3.14159265358979323846f
 #define TWO_PI (2.0f * PI)
 
+// Voices are rendered in groups of SIMD_LANES
+#define NUM_VOICE_GROUPS (MAX_VOICES / SIMD_LANES)
+
+// Most unison lanes per voice
+#define MAX_UNISON 8
+
+// Samples rendered per pass into the mix buffer
+#define RENDER_CHUNK 256
+
+// Fewest playing voice groups worth splitting across render threads
+#ifndef RENDER_THREAD_MIN_GROUPS
+#define RENDER_THREAD_MIN_GROUPS 4
+#endif
+
+// Stack of each render thread
+#define RENDER_THREAD_STACK_SIZE (32 * 1024)
+
+// Snapshot identity; bump STATE_VERSION when transferState() changes
+#define STATE_PLUGIN_ID STATE_ID('A', 'S', 'Y', 'N')
+#define STATE_VERSION 1
+
+#if MAX_VOICES % SIMD_LANES != 0
+#error "MAX_VOICES must be a multiple of SIMD_LANES"
+#endif
+
+#if MAX_VOICES > 128
+#error "MAX_VOICES must not exceed 128"
+#endif
+
+#if MAX_VOICES < MAX_UNISON
+#error "MAX_VOICES must be at least MAX_UNISON"
+#endif
+
 // ============================================================================
 // Waveform Types
 // ============================================================================
@@ -38,44 +140,96 @@ typedef enum {
     WAVE_SQUARE,
     WAVE_SAW,
     WAVE_TRIANGLE,
-    WAVE_NOISE
+    WAVE_NOISE,
+    WAVE_CUSTOM // First custom wavetable slot
 } WaveformType;
 
+typedef enum {
+    OSC_MODE_ANALYTIC = 0, // Direct sine/polyblep computation
+    OSC_MODE_WAVETABLE     // Band-limited wavetable playback
+} OscillatorMode;
+
+#define NUM_BUILTIN_WAVETABLES 4 // Sine, square, saw, triangle
+
+// Custom wavetable slots for loadWavetable(), selected as waveforms
+// WAVE_CUSTOM and up. Each adds a Wavetable (about 90 KB) to every
+// instance's memory block, so builds opt in with -DNUM_CUSTOM_WAVETABLES=<n>.
+#ifndef NUM_CUSTOM_WAVETABLES
+#define NUM_CUSTOM_WAVETABLES 0
+#endif
+#define NUM_WAVETABLES (NUM_BUILTIN_WAVETABLES + NUM_CUSTOM_WAVETABLES)
+#define MAX_WAVEFORM (WAVE_CUSTOM + NUM_CUSTOM_WAVETABLES - 1)
+
 // ============================================================================
-// Voice Structure
+// Voice Bank (structure of arrays)
 // ============================================================================
 
+// One entry per lane. A voice plays on synth->unison consecutive lanes
+// starting at voiceLane(); they share the note, velocity and envelope and
+// differ in detune, start phase and pan.
+
 typedef struct {
-    int active;
-    int note;
-    float velocity;
-    float phase;
-    float phaseIncrement;
-    
-    // Envelope
-    float envelope;
-    int envStage; // 0=off, 1=attack, 2=decay, 3=sustain, 4=release
-    float envTarget;
-    
-    // Filter
-    float filterState[2]; // 2-pole filter
-    
+    // Oscillator
+    DSP_ALIGNED float phase[MAX_VOICES];
+    DSP_ALIGNED float phaseIncrement[MAX_VOICES];
+    DSP_ALIGNED uint32_t noiseState[MAX_VOICES]; // Independent xorshift stream per lane
+
+    // Envelope: envelope = envelope * envMul + envAdd each sample for
+    // envRemaining more samples, then the stage ends
+    DSP_ALIGNED float envelope[MAX_VOICES];
+    DSP_ALIGNED float envMul[MAX_VOICES];
+    DSP_ALIGNED float envAdd[MAX_VOICES];
+
+    // Filter (2-pole state variable filter)
+    DSP_ALIGNED float filterBand[MAX_VOICES];
+    DSP_ALIGNED float filterLow[MAX_VOICES];
+    DSP_ALIGNED float filterCoeff[MAX_VOICES];  // Current SVF frequency coefficient
+    DSP_ALIGNED float filterCutoff[MAX_VOICES]; // Modulated cutoff it was last computed for
+    DSP_ALIGNED float filterStep[MAX_VOICES];   // Coefficient ramp step until the next control block
+
+    DSP_ALIGNED float velocity[MAX_VOICES]; // Includes the unison level compensation
+
+    // Stereo gain per lane, used only when the unison is spread
+    DSP_ALIGNED float panLeft[MAX_VOICES];
+    DSP_ALIGNED float panRight[MAX_VOICES];
+
     // Modulation
-    float lfoPhase;
-} Voice;
+    DSP_ALIGNED float lfoPhase[MAX_VOICES];
+
+    int active[MAX_VOICES];
+    int note[MAX_VOICES];
+    int envStage[MAX_VOICES];     // EnvelopeStage
+    int envRemaining[MAX_VOICES]; // Samples left in the current stage
+} VoiceBank;
 
 // ============================================================================
-// Plugin State
+// Voice Allocator
 // ============================================================================
 
-static float sampleRate = 44100.0f;
-static int bufferSize = 128;
+// Indexes voices, not lanes: with unison only MAX_VOICES / unison are in use
+
+typedef struct {
+    // Free slots, used as a stack so recently freed (low) slots are reused
+    // first and active voices stay packed into few SIMD groups
+    int freeList[MAX_VOICES];
+    int freeCount;
+
+    // Compact list of playing voices and each voice's position in it
+    int activeList[MAX_VOICES];
+    int activeCount;
+    int activePosition[MAX_VOICES];
+
+    // Note-on order, for stealing the oldest voice
+    unsigned int age[MAX_VOICES];
+    unsigned int nextAge;
+} VoiceAllocator;
 
-// Voices
-static Voice voices[MAX_VOICES];
+// ============================================================================
+// Plugin State
+// ============================================================================
 
-// Parameters
-static float params[NUM_PARAMETERS] = {
+// Parameter defaults
+static const float defaultParams[NUM_PARAMETERS] = {
     0.0f,   // 0: Waveform (0-4)
     0.01f,  // 1: Attack (0.001-2)
     0.1f,   // 2: Decay (0.001-2)
@@ -83,13 +237,103 @@ static float params[NUM_PARAMETERS] = {
     0.3f,   // 4: Release (0.001-5)
     5000.0f,// 5: Filter Cutoff (20-20000)
     0.3f,   // 6: Filter Resonance (0-1)
-    0.0f    // 7: Detune (-1 to 1 semitones)
+    0.0f,   // 7: Detune (-1 to 1 semitones)
+    1.0f,   // 8: Oscillator Mode (0=analytic, 1=wavetable)
+    0.0f,   // 9: Saturation (0=soft, 1=hard clip, 2=off)
+    1.0f,   // 10: Unison Voices (1-8)
+    0.2f,   // 11: Unison Detune (0-1 semitones between the outer lanes and the center)
+    0.5f    // 12: Stereo Spread (0=mono, 1=outer lanes hard left/right)
+};
+
+// Parameter ranges, in the order above
+static const float parameterMin[NUM_PARAMETERS] = {
+    0.0f, 0.001f, 0.001f, 0.0f, 0.001f, 20.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f
+};
+static const float parameterMax[NUM_PARAMETERS] = {
+    (float)MAX_WAVEFORM, 2.0f, 2.0f, 1.0f, 5.0f, 20000.0f, 1.0f, 1.0f, 1.0f, 2.0f, (float)MAX_UNISON, 1.0f, 1.0f
 };
 
-// Global state
-static float masterVolume = 0.8f;
-static float pitchBendValue = 0.0f; // -1 to 1, representing -2 to +2 semitones
-static float modWheel = 0.0f;
+// Built-in wavetables, shared by all instances
+static Wavetable wavetables[NUM_BUILTIN_WAVETABLES];
+static WavetableSpectrum wavetableScratch;
+static int wavetablesBuilt = 0;
+
+typedef struct {
+    float sampleRate;
+    int bufferSize;
+
+    // Voices
+    VoiceBank voices;
+    VoiceAllocator allocator;
+
+    // Voice mix for the current chunk; only the first channel is used while
+    // the output is mono
+    DSP_ALIGNED float mixBuffer[NUM_CHANNELS][RENDER_CHUNK];
+
+#if RENDER_THREADS
+    // Mix of each voice group on threaded chunks, summed in group order so
+    // the result does not depend on which thread rendered which group
+    DSP_ALIGNED float groupMix[NUM_VOICE_GROUPS][NUM_CHANNELS][RENDER_CHUNK];
+#endif
+
+    // Voices whose release ended during the current chunk, per group of
+    // their first lane in the order they ended. Freed after the chunk, when
+    // no group is rendering.
+    int finishedVoices[NUM_VOICE_GROUPS][SIMD_LANES];
+    int finishedCount[NUM_VOICE_GROUPS];
+
+    // Unison (control rate): lanes per voice and, per lane of a voice, its
+    // detune ratio and stereo gains, rebuilt by updateUnison()
+    int unison;
+    int numVoices; // MAX_VOICES / unison
+    float unisonRatio[MAX_UNISON];
+    float unisonPanLeft[MAX_UNISON];
+    float unisonPanRight[MAX_UNISON];
+    float unisonGain; // Keeps the summed level independent of the lane count
+    int stereo;       // Set when the lanes are spread, selecting the stereo kernels
+
+#if NUM_CUSTOM_WAVETABLES > 0
+    // Custom wavetable slots, carved from the arena on first load (NULL plays a sine)
+    Wavetable* customWavetables[NUM_CUSTOM_WAVETABLES];
+    Arena arena; // Room for every slot, allocated in one block with the instance
+#endif
+
+    // Set while no voice is playing and processing is skipped
+    int quiescent;
+
+    // Position in the control block, carried across process() calls so
+    // cutoff modulation updates on the same frames at any host block size
+    ControlClock control;
+
+    // Host-written events for processWithEvents()
+    TimedEvent eventBuffer[MAX_EVENTS_PER_BLOCK];
+
+    // Parameters
+    float params[NUM_PARAMETERS];
+
+    // Automation curves uploaded by the host
+    AutomationLane automation[NUM_PARAMETERS];
+    int automatedParams; // Bit per parameter with an active lane
+
+    // Global state
+    float masterVolume;
+    float pitchBendValue; // -1 to 1, representing -2 to +2 semitones
+    float modWheel;
+
+    // Pitch (control rate)
+    float noteIncrementTable[NUM_MIDI_NOTES]; // Phase increment per MIDI note, built in init()
+    float pitchRatio;                         // Combined bend and detune ratio
+    int pitchDirty;                           // Set when bend or detune change
+
+    // Envelope segments, recomputed when an ADSR parameter changes
+    EnvelopeShape envelopeShape;
+
+    // Timing and counters read through getProcessStats()
+    ProcessStats stats;
+} InstrumentInstance;
+
+// Instance used by the handle-less functions
+static InstrumentInstance* defaultInstance = NULL;
 
 // ============================================================================
 // Helper Functions
@@ -101,363 +345,1566 @@ static inline float clamp(float value, float min, float max) {
     return value;
 }
 
+static inline float clampParameter(int index, float value) {
+    return clamp(value, parameterMin[index], parameterMax[index]);
+}
+
 static inline float noteToFrequency(int note) {
     return 440.0f * powf(2.0f, (note - 69) / 12.0f);
 }
 
-static inline float frequencyToPhaseIncrement(float freq) {
-    return freq / sampleRate;
+static inline float frequencyToPhaseIncrement(InstrumentInstance* synth, float freq) {
+    return freq / synth->sampleRate;
 }
 
-// Polyblep for anti-aliased waveforms
-static inline float polyblep(float t, float dt) {
-    if (t < dt) {
-        t /= dt;
-        return t + t - t * t - 1.0f;
-    } else if (t > 1.0f - dt) {
-        t = (t - 1.0f) / dt;
-        return t * t + t + t + 1.0f;
-    }
-    return 0.0f;
+static inline float notePhaseIncrement(InstrumentInstance* synth, int note) {
+    if (note < 0) note = 0;
+    if (note >= NUM_MIDI_NOTES) note = NUM_MIDI_NOTES - 1;
+    return synth->noteIncrementTable[note] * synth->pitchRatio;
+}
+
+/**
+ * First lane of voice v
+ */
+static inline int voiceLane(const InstrumentInstance* synth, int v) {
+    return v * synth->unison;
 }
 
-// Simple noise generator
-static unsigned int noiseState = 12345;
-static inline float noise() {
-    noiseState = noiseState * 1103515245 + 12345;
-    return ((noiseState >> 16) & 0x7FFF) / 16383.5f - 1.0f;
+// Polyblep for anti-aliased waveforms, four phases at a time
+static inline f32x4 polyblep(f32x4 t, f32x4 dt, f32x4 invDt) {
+    f32x4 one = f32x4Splat(1.0f);
+
+    // t < dt: rising edge just passed
+    f32x4 a = f32x4Mul(t, invDt);
+    f32x4 lower = f32x4Sub(f32x4Sub(f32x4Add(a, a), f32x4Mul(a, a)), one);
+
+    // t > 1 - dt: edge coming up
+    f32x4 b = f32x4Mul(f32x4Sub(t, one), invDt);
+    f32x4 upper = f32x4Add(f32x4Add(f32x4Mul(b, b), f32x4Add(b, b)), one);
+
+    f32x4 result = f32x4Select(f32x4Gt(t, f32x4Sub(one, dt)), upper, f32x4Splat(0.0f));
+    return f32x4Select(f32x4Lt(t, dt), lower, result);
 }
 
 // ============================================================================
-// Oscillator
+// Voice Kernels
 // ============================================================================
 
-static float generateOscillator(Voice* v, WaveformType waveform) {
-    float t = v->phase;
-    float dt = v->phaseIncrement;
-    float sample = 0.0f;
-    
-    switch (waveform) {
-        case WAVE_SINE:
-            sample = sinf(t * TWO_PI);
-            break;
-            
-        case WAVE_SQUARE:
-            sample = t < 0.5f ? 1.0f : -1.0f;
-            sample -= polyblep(t, dt);
-            sample += polyblep(fmodf(t + 0.5f, 1.0f), dt);
-            break;
-            
-        case WAVE_SAW:
-            sample = 2.0f * t - 1.0f;
-            sample -= polyblep(t, dt);
-            break;
-            
-        case WAVE_TRIANGLE:
-            sample = 4.0f * fabsf(t - 0.5f) - 1.0f;
-            break;
-            
-        case WAVE_NOISE:
-            sample = noise();
-            break;
-    }
-    
-    // Advance phase
-    v->phase += dt;
-    if (v->phase >= 1.0f) {
-        v->phase -= 1.0f;
+// The per-sample voice loop is specialized for every oscillator instead of
+// branching on the waveform per sample: DEFINE_VOICE_KERNEL stamps out one
+// group renderer per oscillator and renderBlock() picks one from
+// voiceKernels once per block. Everything else the loop needs (filter
+// coefficient and its per-sample step, resonance, envelope) is read into
+// registers before it starts. Adding an oscillator means writing an osc*()
+// function and a kernel, not a branch in the loop.
+//
+// The filter sweep is kept as data (fStep is 0 while the cutoff holds)
+// rather than as a second loop per oscillator: one add per sample costs
+// less than the doubled code, which stops the compiler from inlining the
+// oscillators. Stereo output is a second set of kernels, though: panning
+// costs two more multiplies and sums per sample, which the mono kernels
+// used whenever the unison is not spread leave out.
+
+/**
+ * Oscillator: the next sample of four voices at phase t. All share one
+ * signature so a kernel can be stamped out for each.
+ */
+typedef f32x4 (*Oscillator)(f32x4 t, f32x4 dt, f32x4 invDt, u32x4* noise, const float* const* levels);
+
+DSP_FORCE_INLINE f32x4 oscSine(f32x4 t, f32x4 dt, f32x4 invDt, u32x4* noise, const float* const* levels) {
+    return f32x4SinCycle(t);
+}
+
+DSP_FORCE_INLINE f32x4 oscSquare(f32x4 t, f32x4 dt, f32x4 invDt, u32x4* noise, const float* const* levels) {
+    f32x4 one = f32x4Splat(1.0f);
+    f32x4 sample = f32x4Select(f32x4Lt(t, f32x4Splat(0.5f)), one, f32x4Splat(-1.0f));
+    f32x4 shifted = f32x4Add(t, f32x4Splat(0.5f));
+    shifted = f32x4Select(f32x4Ge(shifted, one), f32x4Sub(shifted, one), shifted);
+    sample = f32x4Sub(sample, polyblep(t, dt, invDt));
+    return f32x4Add(sample, polyblep(shifted, dt, invDt));
+}
+
+DSP_FORCE_INLINE f32x4 oscSaw(f32x4 t, f32x4 dt, f32x4 invDt, u32x4* noise, const float* const* levels) {
+    f32x4 sample = f32x4Sub(f32x4Add(t, t), f32x4Splat(1.0f));
+    return f32x4Sub(sample, polyblep(t, dt, invDt));
+}
+
+DSP_FORCE_INLINE f32x4 oscTriangle(f32x4 t, f32x4 dt, f32x4 invDt, u32x4* noise, const float* const* levels) {
+    return f32x4Sub(f32x4Mul(f32x4Splat(4.0f), f32x4Abs(f32x4Sub(t, f32x4Splat(0.5f)))), f32x4Splat(1.0f));
+}
+
+DSP_FORCE_INLINE f32x4 oscNoise(f32x4 t, f32x4 dt, f32x4 invDt, u32x4* noise, const float* const* levels) {
+    return noiseNext4(noise);
+}
+
+DSP_FORCE_INLINE f32x4 oscWavetable(f32x4 t, f32x4 dt, f32x4 invDt, u32x4* noise, const float* const* levels) {
+    return wavetableRead4(levels, t);
+}
+
+/**
+ * State of one voice group between runs
+ */
+typedef struct {
+    f32x4 phase;
+    f32x4 dt;
+    f32x4 invDt;
+    u32x4 noise;
+    const float* levels[SIMD_LANES]; // Wavetable level per lane
+
+    f32x4 env;
+    f32x4 envMul;
+    f32x4 envAdd;
+    f32x4 velocity;
+    f32x4 panLeft;  // Stereo kernels only
+    f32x4 panRight;
+
+    f32x4 band;
+    f32x4 low;
+    f32x4 f;     // SVF frequency coefficient
+    f32x4 fStep; // Per-sample coefficient step, 0 while the cutoff holds
+    f32x4 q;
+} VoiceRun;
+
+/**
+ * Render numSamples samples of a voice group, adding the voices into mixL,
+ * or panned into mixL and mixR if stereo. oscillator and stereo are
+ * constants in every caller, so each expansion is a branch-free loop; the
+ * state is copied into locals to stay in registers.
+ */
+DSP_FORCE_INLINE void renderRun(VoiceRun* run, float* mixL, float* mixR, int numSamples, Oscillator oscillator,
+                                int stereo) {
+    f32x4 one = f32x4Splat(1.0f);
+    f32x4 phase = run->phase;
+    f32x4 dt = run->dt;
+    f32x4 invDt = run->invDt;
+    u32x4 noise = run->noise;
+    f32x4 env = run->env;
+    f32x4 envMul = run->envMul;
+    f32x4 envAdd = run->envAdd;
+    f32x4 velocity = run->velocity;
+    f32x4 panLeft = stereo ? run->panLeft : one;
+    f32x4 panRight = stereo ? run->panRight : one;
+    f32x4 band = run->band;
+    f32x4 low = run->low;
+    f32x4 f = run->f;
+    f32x4 fStep = run->fStep;
+    f32x4 q = run->q;
+
+    for (int i = 0; i < numSamples; i++) {
+        f32x4 osc = oscillator(phase, dt, invDt, &noise, run->levels);
+
+        // Advance phase
+        phase = f32x4Add(phase, dt);
+        phase = f32x4Select(f32x4Ge(phase, one), f32x4Sub(phase, one), phase);
+
+        // Apply filter
+        f = f32x4Add(f, fStep);
+        low = f32x4MulAdd(f, band, low);
+        f32x4 high = f32x4Sub(f32x4Sub(osc, low), f32x4Mul(q, band));
+        band = f32x4MulAdd(f, high, band);
+
+        // Apply envelope
+        f32x4 voiced = f32x4Mul(f32x4Mul(low, env), velocity);
+        if (stereo) {
+            mixL[i] += f32x4HorizontalSum(f32x4Mul(voiced, panLeft));
+            mixR[i] += f32x4HorizontalSum(f32x4Mul(voiced, panRight));
+        } else {
+            mixL[i] += f32x4HorizontalSum(voiced);
+        }
+
+        // Update envelope
+        env = f32x4MulAdd(env, envMul, envAdd);
     }
-    
-    return sample;
+
+    run->phase = phase;
+    run->noise = noise;
+    run->env = env;
+    run->band = band;
+    run->low = low;
+    run->f = f;
 }
 
 // ============================================================================
-// Envelope
+// Voice Allocation
 // ============================================================================
 
-static void updateEnvelope(Voice* v) {
-    float attack = params[1];
-    float decay = params[2];
-    float sustain = params[3];
-    float release = params[4];
-    
-    float rate;
-    
-    switch (v->envStage) {
-        case 1: // Attack
-            rate = 1.0f / (attack * sampleRate);
-            v->envelope += rate;
-            if (v->envelope >= 1.0f) {
-                v->envelope = 1.0f;
-                v->envStage = 2;
-            }
-            break;
-            
-        case 2: // Decay
-            rate = (1.0f - sustain) / (decay * sampleRate);
-            v->envelope -= rate;
-            if (v->envelope <= sustain) {
-                v->envelope = sustain;
-                v->envStage = 3;
-            }
-            break;
-            
-        case 3: // Sustain
-            // Hold at sustain level
-            break;
-            
-        case 4: // Release
-            rate = v->envelope / (release * sampleRate);
-            v->envelope -= rate;
-            if (v->envelope <= 0.001f) {
-                v->envelope = 0.0f;
-                v->envStage = 0;
-                v->active = 0;
-            }
-            break;
+static void resetAllocator(VoiceAllocator* allocator, int numVoices) {
+    allocator->freeCount = 0;
+    for (int v = MAX_VOICES - 1; v >= 0; v--) {
+        if (v < numVoices) allocator->freeList[allocator->freeCount++] = v;
+        allocator->activePosition[v] = -1;
+        allocator->age[v] = 0;
     }
+    allocator->activeCount = 0;
+    allocator->nextAge = 0;
 }
 
-// ============================================================================
-// Filter (State Variable Filter)
-// ============================================================================
+/**
+ * Pick the voice to steal: the quietest voice already releasing, otherwise
+ * the oldest note
+ */
+static int findVoiceToSteal(InstrumentInstance* synth) {
+    VoiceAllocator* allocator = &synth->allocator;
+    VoiceBank* voices = &synth->voices;
+    int quietest = -1;
+    int oldest = allocator->activeList[0];
 
-static float processFilter(Voice* v, float input) {
-    float cutoff = params[5];
-    float resonance = params[6];
-    
-    // Modulate cutoff with envelope
-    float envMod = v->envelope * 0.5f;
-    cutoff = cutoff * (1.0f + envMod);
-    cutoff = clamp(cutoff, 20.0f, 20000.0f);
-    
-    // Calculate filter coefficients
-    float f = 2.0f * sinf(PI * cutoff / sampleRate);
-    float q = 1.0f - resonance * 0.9f;
-    
-    // State variable filter
-    float low = v->filterState[1] + f * v->filterState[0];
-    float high = input - low - q * v->filterState[0];
-    float band = f * high + v->filterState[0];
-    
-    v->filterState[0] = band;
-    v->filterState[1] = low;
-    
-    return low; // Lowpass output
+    // The lanes of a voice share its envelope, so the first one stands for all
+    for (int i = 0; i < allocator->activeCount; i++) {
+        int v = allocator->activeList[i];
+        int lane = voiceLane(synth, v);
+        if (voices->envStage[lane] == ENV_RELEASE &&
+            (quietest < 0 || voices->envelope[lane] < voices->envelope[voiceLane(synth, quietest)])) {
+            quietest = v;
+        }
+        if (allocator->age[v] < allocator->age[oldest]) {
+            oldest = v;
+        }
+    }
+
+    return quietest >= 0 ? quietest : oldest;
 }
 
-// ============================================================================
-// Core Functions
-// ============================================================================
+/**
+ * Take a free voice, or steal one if all are playing
+ */
+static int allocateVoice(InstrumentInstance* synth) {
+    VoiceAllocator* allocator = &synth->allocator;
+    int v;
 
-void init(float sr, int bs) {
-    sampleRate = sr;
-    bufferSize = bs;
-    
-    // Initialize voices
-    for (int i = 0; i < MAX_VOICES; i++) {
-        voices[i].active = 0;
-        voices[i].note = 0;
-        voices[i].velocity = 0.0f;
-        voices[i].phase = 0.0f;
-        voices[i].phaseIncrement = 0.0f;
-        voices[i].envelope = 0.0f;
-        voices[i].envStage = 0;
-        voices[i].filterState[0] = 0.0f;
-        voices[i].filterState[1] = 0.0f;
-        voices[i].lfoPhase = 0.0f;
+    if (allocator->freeCount > 0) {
+        v = allocator->freeList[--allocator->freeCount];
+        allocator->activePosition[v] = allocator->activeCount;
+        allocator->activeList[allocator->activeCount++] = v;
+    } else {
+        v = findVoiceToSteal(synth);
+    }
+
+    allocator->age[v] = ++allocator->nextAge;
+    for (int u = 0; u < synth->unison; u++) {
+        synth->voices.active[voiceLane(synth, v) + u] = 1;
     }
+    return v;
 }
 
-void process(float* input, float* output, int numSamples) {
-    WaveformType waveform = (WaveformType)(int)params[0];
-    float detune = params[7];
-    
-    // Clear output buffer
-    memset(output, 0, numSamples * NUM_CHANNELS * sizeof(float));
-    
-    for (int i = 0; i < numSamples; i++) {
-        float sample = 0.0f;
-        
-        for (int v = 0; v < MAX_VOICES; v++) {
-            if (!voices[v].active) continue;
-            
-            // Update pitch with pitch bend and detune
-            float freq = noteToFrequency(voices[v].note);
-            float bendSemitones = pitchBendValue * 2.0f; // +/- 2 semitones
-            float totalDetune = bendSemitones + detune;
-            freq *= powf(2.0f, totalDetune / 12.0f);
-            voices[v].phaseIncrement = frequencyToPhaseIncrement(freq);
-            
-            // Generate oscillator
-            float osc = generateOscillator(&voices[v], waveform);
-            
-            // Apply filter
-            float filtered = processFilter(&voices[v], osc);
-            
-            // Apply envelope
-            float voiced = filtered * voices[v].envelope * voices[v].velocity;
-            
-            // Update envelope
-            updateEnvelope(&voices[v]);
-            
-            sample += voiced;
-        }
-        
-        // Apply master volume
-        sample *= masterVolume;
-        
-        // Soft clip
-        sample = tanhf(sample);
-        
-        // Output stereo
-        output[i * NUM_CHANNELS] = sample;
-        output[i * NUM_CHANNELS + 1] = sample;
+/**
+ * Return a finished voice to the free list
+ */
+static void releaseVoice(InstrumentInstance* synth, int v) {
+    VoiceAllocator* allocator = &synth->allocator;
+    int position = allocator->activePosition[v];
+    if (position < 0) return;
+
+    // Swap-remove from the active list
+    int last = allocator->activeList[--allocator->activeCount];
+    allocator->activeList[position] = last;
+    allocator->activePosition[last] = position;
+
+    allocator->activePosition[v] = -1;
+    allocator->freeList[allocator->freeCount++] = v;
+
+    // Drop any coefficient ramp, so a group that next renders inside a
+    // control block does not resume a stale one
+    for (int u = 0; u < synth->unison; u++) {
+        synth->voices.active[voiceLane(synth, v) + u] = 0;
+        synth->voices.filterStep[voiceLane(synth, v) + u] = 0.0f;
     }
 }
 
-void reset() {
-    for (int i = 0; i < MAX_VOICES; i++) {
-        voices[i].active = 0;
-        voices[i].envelope = 0.0f;
-        voices[i].envStage = 0;
-        voices[i].filterState[0] = 0.0f;
-        voices[i].filterState[1] = 0.0f;
+/**
+ * Free the voices whose release ended while the groups were rendering, in
+ * group order
+ */
+static void releaseFinishedVoices(InstrumentInstance* synth, const int* groups, int numGroups) {
+    for (int g = 0; g < numGroups; g++) {
+        int group = groups[g];
+        for (int i = 0; i < synth->finishedCount[group]; i++) {
+            releaseVoice(synth, synth->finishedVoices[group][i]);
+        }
+        synth->finishedCount[group] = 0;
     }
-    pitchBendValue = 0.0f;
-    modWheel = 0.0f;
 }
 
-void dispose() {
-    // Nothing to free in this simple implementation
+/**
+ * Collect the SIMD groups that contain at least one lane of a playing voice
+ */
+static int collectActiveGroups(const InstrumentInstance* synth, int* groups) {
+    const VoiceAllocator* allocator = &synth->allocator;
+    unsigned char seen[NUM_VOICE_GROUPS];
+    int count = 0;
+
+    if (allocator->activeCount == 0) return 0;
+
+    memset(seen, 0, sizeof(seen));
+    for (int i = 0; i < allocator->activeCount; i++) {
+        int lane = voiceLane(synth, allocator->activeList[i]);
+        int last = (lane + synth->unison - 1) / SIMD_LANES;
+        for (int g = lane / SIMD_LANES; g <= last; g++) {
+            if (!seen[g]) {
+                seen[g] = 1;
+                groups[count++] = g;
+            }
+        }
+    }
+
+    return count;
 }
 
 // ============================================================================
-// MIDI Functions
+// Wavetables
 // ============================================================================
 
-void noteOn(int note, int velocity, int channel) {
-    if (velocity == 0) {
-        noteOff(note, channel);
-        return;
-    }
-    
-    // Find free voice or steal oldest
-    int voiceIndex = -1;
-    float oldestTime = 0.0f;
-    int oldestIndex = 0;
-    
-    for (int i = 0; i < MAX_VOICES; i++) {
-        if (!voices[i].active) {
-            voiceIndex = i;
-            break;
-        }
-        // Track oldest for voice stealing
-        if (voices[i].envelope < oldestTime || i == 0) {
-            oldestTime = voices[i].envelope;
-            oldestIndex = i;
+static void buildWavetables() {
+    WavetableSpectrum* s = &wavetableScratch;
+
+    for (int w = 0; w < NUM_BUILTIN_WAVETABLES; w++) {
+        memset(s->re, 0, sizeof(s->re));
+        memset(s->im, 0, sizeof(s->im));
+
+        for (int n = 1; n < WAVETABLE_SIZE / 2; n++) {
+            float odd = (n & 1) ? 1.0f : 0.0f;
+            switch ((WaveformType)w) {
+                case WAVE_SINE:
+                    if (n == 1) wavetableSetHarmonic(s, n, 0.0f, 1.0f);
+                    break;
+                case WAVE_SQUARE:
+                    wavetableSetHarmonic(s, n, 0.0f, odd * 4.0f / (PI * n));
+                    break;
+                case WAVE_SAW:
+                    wavetableSetHarmonic(s, n, 0.0f, -2.0f / (PI * n));
+                    break;
+                case WAVE_TRIANGLE:
+                    wavetableSetHarmonic(s, n, odd * 8.0f / (PI * PI * n * n), 0.0f);
+                    break;
+                default:
+                    break;
+            }
         }
+
+        wavetableBuildFromSpectrum(&wavetables[w], s);
     }
-    
-    // Steal oldest voice if no free voice
-    if (voiceIndex == -1) {
-        voiceIndex = oldestIndex;
-    }
-    
-    // Initialize voice
-    Voice* v = &voices[voiceIndex];
-    v->active = 1;
-    v->note = note;
-    v->velocity = velocity / 127.0f;
-    v->phase = 0.0f;
-    v->phaseIncrement = frequencyToPhaseIncrement(noteToFrequency(note));
-    v->envelope = 0.0f;
-    v->envStage = 1; // Attack
-    v->filterState[0] = 0.0f;
-    v->filterState[1] = 0.0f;
+
+    wavetablesBuilt = 1;
 }
 
-void noteOff(int note, int channel) {
-    for (int i = 0; i < MAX_VOICES; i++) {
-        if (voices[i].active && voices[i].note == note && voices[i].envStage != 4) {
-            voices[i].envStage = 4; // Release
-        }
+/**
+ * Wavetable to play for a waveform, or NULL to use the analytic oscillator
+ */
+static inline const Wavetable* wavetableForWaveform(const InstrumentInstance* synth, WaveformType waveform,
+                                                    OscillatorMode mode) {
+#if NUM_CUSTOM_WAVETABLES > 0
+    if (waveform >= WAVE_CUSTOM) {
+        // Custom slots play a sine until something is loaded
+        const Wavetable* custom = synth->customWavetables[waveform - WAVE_CUSTOM];
+        return custom ? custom : &wavetables[WAVE_SINE];
     }
+#else
+    (void)synth;
+#endif
+    if (waveform == WAVE_NOISE || mode != OSC_MODE_WAVETABLE) return NULL;
+    return &wavetables[waveform];
 }
 
-void controlChange(int cc, int value, int channel) {
-    float normalizedValue = value / 127.0f;
-    
-    switch (cc) {
-        case 1: // Mod wheel
-            modWheel = normalizedValue;
-            break;
-        case 7: // Volume
-            masterVolume = normalizedValue;
+// ============================================================================
+// Envelope
+// ============================================================================
+
+/**
+ * Enter a stage, taking its coefficients from the precomputed shape and
+ * solving how many samples it runs from the current level
+ */
+static void enterEnvelopeStage(InstrumentInstance* synth, int v, EnvelopeStage stage) {
+    const EnvelopeSegment* seg = &synth->envelopeShape.segments[stage];
+    VoiceBank* voices = &synth->voices;
+    voices->envStage[v] = stage;
+    voices->envMul[v] = seg->mul;
+    voices->envAdd[v] = seg->add;
+    voices->envRemaining[v] = envelopeSegmentLength(seg, voices->envelope[v]);
+}
+
+/**
+ * Move a lane whose current stage has run out on to the next stage
+ */
+static void advanceEnvelopeStage(InstrumentInstance* synth, int v) {
+    EnvelopeStage stage = (EnvelopeStage)synth->voices.envStage[v];
+    synth->voices.envelope[v] = synth->envelopeShape.segments[stage].endLevel;
+
+    switch (stage) {
+        case ENV_ATTACK:
+            enterEnvelopeStage(synth, v, ENV_DECAY);
             break;
-        case 74: // Filter cutoff (commonly used)
-            params[5] = 20.0f + normalizedValue * 19980.0f;
+
+        case ENV_DECAY:
+            enterEnvelopeStage(synth, v, ENV_SUSTAIN);
             break;
-        case 71: // Filter resonance
-            params[6] = normalizedValue;
+
+        case ENV_RELEASE: {
+            // Freed by releaseFinishedVoices(): the allocator is shared by all
+            // groups. The voice's lanes end together, so its first one frees it.
+            enterEnvelopeStage(synth, v, ENV_OFF);
+            if (v % synth->unison == 0) {
+                int group = v / SIMD_LANES;
+                synth->finishedVoices[group][synth->finishedCount[group]++] = v / synth->unison;
+            }
             break;
-        case 123: // All notes off
-            reset();
+        }
+
+        default:
             break;
     }
 }
 
-void pitchBend(int value, int channel) {
-    // value is 0-16383, center is 8192
-    pitchBendValue = (value - 8192) / 8192.0f;
+/**
+ * Recompute the envelope shape after an ADSR change and re-solve the stage
+ * lengths of playing voices from where they are now
+ */
+static void updateEnvelopeShape(InstrumentInstance* synth) {
+    const float* params = synth->params;
+    envelopeShapeUpdate(&synth->envelopeShape, params[1], params[2], params[3], params[4], synth->sampleRate);
+
+    for (int i = 0; i < synth->allocator.activeCount; i++) {
+        int lane = voiceLane(synth, synth->allocator.activeList[i]);
+        for (int u = 0; u < synth->unison; u++) {
+            enterEnvelopeStage(synth, lane + u, (EnvelopeStage)synth->voices.envStage[lane + u]);
+        }
+    }
+}
+
+/**
+ * Smallest number of samples until any voice in a group changes stage
+ */
+static inline int groupEnvelopeRemaining(const VoiceBank* voices, int base) {
+    int remaining = voices->envRemaining[base];
+    for (int l = 1; l < SIMD_LANES; l++) {
+        if (voices->envRemaining[base + l] < remaining) remaining = voices->envRemaining[base + l];
+    }
+    return remaining;
+}
+
+/**
+ * Count a rendered run against each voice of a group and advance the voices
+ * whose stage has run out
+ */
+static void consumeEnvelopeRun(InstrumentInstance* synth, int base, int samples) {
+    VoiceBank* voices = &synth->voices;
+    for (int l = 0; l < SIMD_LANES; l++) {
+        int v = base + l;
+        if (voices->envRemaining[v] >= ENVELOPE_FOREVER) continue;
+
+        voices->envRemaining[v] -= samples;
+        if (voices->envRemaining[v] <= 0) advanceEnvelopeStage(synth, v);
+    }
 }
 
 // ============================================================================
-// Parameter Functions
+// Pitch
 // ============================================================================
 
-int getParameterCount() {
-    return NUM_PARAMETERS;
+static void buildNoteTable(InstrumentInstance* synth) {
+    for (int n = 0; n < NUM_MIDI_NOTES; n++) {
+        synth->noteIncrementTable[n] = frequencyToPhaseIncrement(synth, noteToFrequency(n));
+    }
 }
 
-float getParameter(int index) {
-    if (index >= 0 && index < NUM_PARAMETERS) {
-        return params[index];
+/**
+ * Recompute voice pitch after a bend or detune change
+ */
+static void updatePitch(InstrumentInstance* synth) {
+    float bendSemitones = synth->pitchBendValue * 2.0f; // +/- 2 semitones
+    synth->pitchRatio = semitonesToRatio(bendSemitones + synth->params[7]);
+
+    for (int i = 0; i < synth->allocator.activeCount; i++) {
+        int lane = voiceLane(synth, synth->allocator.activeList[i]);
+        float increment = notePhaseIncrement(synth, synth->voices.note[lane]);
+        for (int u = 0; u < synth->unison; u++) {
+            synth->voices.phaseIncrement[lane + u] = increment * synth->unisonRatio[u];
+        }
     }
-    return 0.0f;
+
+    synth->pitchDirty = 0;
 }
 
-void setParameter(int index, float value) {
-    if (index >= 0 && index < NUM_PARAMETERS) {
-        switch (index) {
-            case 0: // Waveform
-                params[0] = clamp(value, 0.0f, 4.0f);
-                break;
-            case 1: // Attack
-                params[1] = clamp(value, 0.001f, 2.0f);
-                break;
-            case 2: // Decay
-                params[2] = clamp(value, 0.001f, 2.0f);
-                break;
-            case 3: // Sustain
-                params[3] = clamp(value, 0.0f, 1.0f);
-                break;
-            case 4: // Release
-                params[4] = clamp(value, 0.001f, 5.0f);
-                break;
-            case 5: // Filter Cutoff
-                params[5] = clamp(value, 20.0f, 20000.0f);
-                break;
-            case 6: // Filter Resonance
-                params[6] = clamp(value, 0.0f, 1.0f);
-                break;
-            case 7: // Detune
-                params[7] = clamp(value, -1.0f, 1.0f);
-                break;
-        }
+// ============================================================================
+// Unison
+// ============================================================================
+
+/**
+ * Offset of lane u of a voice across the unison, from -1 to 1 (0 alone)
+ */
+static inline float unisonOffset(int u, int unison) {
+    return unison > 1 ? 2.0f * u / (unison - 1) - 1.0f : 0.0f;
+}
+
+/**
+ * Start phase of lane u, spread by the golden ratio so the lanes of a new
+ * note do not start in phase and sum to a spike
+ */
+static inline float unisonPhase(int u) {
+    float phase = u * 0.61803398875f;
+    return phase - (int)phase;
+}
+
+/**
+ * Set a lane's stereo gains from the unison pan table
+ */
+static inline void setLanePan(InstrumentInstance* synth, int lane, int u) {
+    synth->voices.panLeft[lane] = synth->unisonPanLeft[u];
+    synth->voices.panRight[lane] = synth->unisonPanRight[u];
+}
+
+/**
+ * Stop every voice at once and free all lanes
+ */
+static void resetVoices(InstrumentInstance* synth) {
+    resetAllocator(&synth->allocator, synth->numVoices);
+    for (int i = 0; i < MAX_VOICES; i++) {
+        synth->voices.active[i] = 0;
+        synth->voices.envelope[i] = 0.0f;
+        synth->voices.filterBand[i] = 0.0f;
+        synth->voices.filterLow[i] = 0.0f;
+        synth->voices.filterStep[i] = 0.0f;
+        enterEnvelopeStage(synth, i, ENV_OFF);
     }
 }
 
-int getLatency() {
-    return 0;
-}
\ No newline at end of file
+/**
+ * Rebuild the unison tables after a unison parameter change. Playing
+ * voices pick up detune and spread; a new lane count stops them, since
+ * it changes which lanes make up a voice.
+ */
+static void updateUnison(InstrumentInstance* synth) {
+    const float* params = synth->params;
+    int unison = (int)params[10];
+
+    if (unison != synth->unison) {
+        synth->unison = unison;
+        synth->numVoices = MAX_VOICES / unison;
+        resetVoices(synth);
+    }
+
+    for (int u = 0; u < unison; u++) {
+        float offset = unisonOffset(u, unison);
+        synth->unisonRatio[u] = offset != 0.0f ? semitonesToRatio(offset * params[11]) : 1.0f;
+
+        // Constant power pan, scaled so a centered lane keeps unit gain
+        float angle = (offset * params[12] + 1.0f) * (PI / 4.0f);
+        synth->unisonPanLeft[u] = cosf(angle) * 1.41421356f;
+        synth->unisonPanRight[u] = sinf(angle) * 1.41421356f;
+    }
+    synth->unisonGain = 1.0f / sqrtf((float)unison);
+    synth->stereo = unison > 1 && params[12] > 0.0f;
+
+    for (int i = 0; i < synth->allocator.activeCount; i++) {
+        int lane = voiceLane(synth, synth->allocator.activeList[i]);
+        for (int u = 0; u < unison; u++) {
+            setLanePan(synth, lane + u, u);
+        }
+    }
+    synth->pitchDirty = 1;
+}
+
+// ============================================================================
+// Filter (State Variable Filter)
+// ============================================================================
+
+/**
+ * Cutoff after envelope modulation
+ */
+static inline float modulatedCutoff(const InstrumentInstance* synth, float envelope) {
+    float envMod = envelope * 0.5f;
+    return clamp(synth->params[5] * (1.0f + envMod), 20.0f, 20000.0f);
+}
+
+/**
+ * Start a voice's filter coefficient at its current modulated cutoff
+ */
+static void resetFilterCoefficient(InstrumentInstance* synth, int v) {
+    float cutoff = modulatedCutoff(synth, synth->voices.envelope[v]);
+    synth->voices.filterCutoff[v] = cutoff;
+    synth->voices.filterCoeff[v] = svfCoeff(cutoff, synth->sampleRate);
+    synth->voices.filterStep[v] = 0.0f;
+}
+
+// ============================================================================
+// Voice Rendering
+// ============================================================================
+
+/**
+ * Render one group of SIMD_LANES lanes and add it to mixL, or to mixL and
+ * mixR if stereo. Expanded once per oscillator and output by
+ * DEFINE_VOICE_KERNEL.
+ */
+DSP_FORCE_INLINE void renderVoiceGroup(InstrumentInstance* synth, int group, const Wavetable* table,
+                                       float* mixL, float* mixR, int numSamples, Oscillator oscillator,
+                                       int stereo) {
+    VoiceBank* voices = &synth->voices;
+    int base = group * SIMD_LANES;
+    float* envPtr = &voices->envelope[base];
+    VoiceRun run;
+
+    // Wavetable level per lane, chosen from its pitch
+    if (table) {
+        for (int l = 0; l < SIMD_LANES; l++) {
+            run.levels[l] = table->levels[wavetableMipLevel(voices->phaseIncrement[base + l])];
+        }
+    }
+
+    f32x4 one = f32x4Splat(1.0f);
+
+    // Oscillator
+    run.phase = f32x4Load(&voices->phase[base]);
+    run.dt = f32x4Load(&voices->phaseIncrement[base]);
+    run.invDt = f32x4Div(one, f32x4Max(run.dt, f32x4Splat(1e-9f)));
+    run.noise = u32x4Load(&voices->noiseState[base]);
+
+    // Envelope
+    run.env = f32x4Load(envPtr);
+    run.envMul = f32x4Load(&voices->envMul[base]);
+    run.envAdd = f32x4Load(&voices->envAdd[base]);
+    run.velocity = f32x4Load(&voices->velocity[base]);
+    if (stereo) {
+        run.panLeft = f32x4Load(&voices->panLeft[base]);
+        run.panRight = f32x4Load(&voices->panRight[base]);
+    }
+    int runRemaining = groupEnvelopeRemaining(voices, base); // Samples until the next stage change
+    int runDone = 0;                                         // Samples rendered since lengths were last updated
+
+    // Filter
+    run.band = f32x4Load(&voices->filterBand[base]);
+    run.low = f32x4Load(&voices->filterLow[base]);
+    run.f = f32x4Load(&voices->filterCoeff[base]);
+    run.fStep = f32x4Load(&voices->filterStep[base]);
+    run.q = f32x4Splat(1.0f - synth->params[6] * 0.9f);
+    f32x4 lastCutoff = f32x4Load(&voices->filterCutoff[base]);
+    f32x4 cutoff = f32x4Splat(synth->params[5]);
+    f32x4 cutoffToAngle = f32x4Splat(PI / synth->sampleRate);
+    f32x4 minCutoff = f32x4Splat(20.0f);
+    f32x4 maxCutoff = f32x4Splat(20000.0f);
+
+    // Coefficients update at control block boundaries of the stream; a call
+    // starting inside a block continues the ramp started at its boundary
+    ControlClock clock = synth->control;
+
+    for (int start = 0; start < numSamples;) {
+        int span = controlClockSpan(&clock, numSamples - start);
+
+        if (controlClockAtBoundary(&clock)) {
+            // Modulate cutoff with envelope; only recompute the coefficient if it moved
+            f32x4 fc = f32x4Mul(cutoff, f32x4MulAdd(run.env, f32x4Splat(0.5f), one));
+            fc = f32x4Clamp(fc, minCutoff, maxCutoff);
+
+            int moved = m32x4Any(f32x4Ne(fc, lastCutoff));
+            run.fStep = f32x4Splat(0.0f);
+            if (moved) {
+                run.fStep = coeffRampStep4(run.f, svfCoeff4(fc, cutoffToAngle), COEFF_UPDATE_INTERVAL);
+                lastCutoff = fc;
+            }
+        }
+
+        // Render in runs during which no voice changes stage
+        for (int i = start; i < start + span;) {
+            int count = start + span - i;
+            if (count > runRemaining) count = runRemaining;
+
+            renderRun(&run, mixL + i, stereo ? mixR + i : NULL, count, oscillator, stereo);
+            i += count;
+
+            runDone += count;
+            runRemaining -= count;
+
+            if (runRemaining == 0) {
+                f32x4Store(envPtr, run.env);
+                consumeEnvelopeRun(synth, base, runDone);
+                runDone = 0;
+                run.env = f32x4Load(envPtr);
+                run.envMul = f32x4Load(&voices->envMul[base]);
+                run.envAdd = f32x4Load(&voices->envAdd[base]);
+                runRemaining = groupEnvelopeRemaining(voices, base);
+            }
+        }
+
+        start += span;
+        controlClockAdvance(&clock, span);
+    }
+
+    // Decaying filter and envelope state must not linger in subnormals
+    run.band = f32x4FlushDenormals(run.band);
+    run.low = f32x4FlushDenormals(run.low);
+    run.env = f32x4FlushDenormals(run.env);
+
+    f32x4Store(&voices->phase[base], run.phase);
+    u32x4Store(&voices->noiseState[base], run.noise);
+    f32x4Store(envPtr, run.env);
+    consumeEnvelopeRun(synth, base, runDone);
+    f32x4Store(&voices->filterBand[base], run.band);
+    f32x4Store(&voices->filterLow[base], run.low);
+    f32x4Store(&voices->filterCoeff[base], run.f);
+    f32x4Store(&voices->filterCutoff[base], lastCutoff);
+    f32x4Store(&voices->filterStep[base], run.fStep);
+}
+
+/**
+ * Define the mono and stereo group renderers for one oscillator
+ */
+#define DEFINE_VOICE_KERNEL(name, oscillator) \
+    static void name(InstrumentInstance* synth, int group, const Wavetable* table, float* mixL, float* mixR, \
+                     int numSamples) { \
+        renderVoiceGroup(synth, group, table, mixL, NULL, numSamples, oscillator, 0); \
+    } \
+    static void name##Stereo(InstrumentInstance* synth, int group, const Wavetable* table, float* mixL, \
+                             float* mixR, int numSamples) { \
+        renderVoiceGroup(synth, group, table, mixL, mixR, numSamples, oscillator, 1); \
+    }
+
+DEFINE_VOICE_KERNEL(renderSineVoices, oscSine)
+DEFINE_VOICE_KERNEL(renderSquareVoices, oscSquare)
+DEFINE_VOICE_KERNEL(renderSawVoices, oscSaw)
+DEFINE_VOICE_KERNEL(renderTriangleVoices, oscTriangle)
+DEFINE_VOICE_KERNEL(renderNoiseVoices, oscNoise)
+DEFINE_VOICE_KERNEL(renderWavetableVoices, oscWavetable)
+
+typedef void (*VoiceKernel)(InstrumentInstance* synth, int group, const Wavetable* table, float* mixL, float* mixR,
+                            int numSamples);
+
+// Analytic oscillators in WaveformType order, then wavetable playback
+typedef enum {
+    KERNEL_SINE = 0,
+    KERNEL_SQUARE,
+    KERNEL_SAW,
+    KERNEL_TRIANGLE,
+    KERNEL_NOISE,
+    KERNEL_WAVETABLE,
+    NUM_VOICE_KERNELS
+} VoiceKernelIndex;
+
+// Mono kernels, then the same kernels panning into stereo
+static const VoiceKernel voiceKernels[2][NUM_VOICE_KERNELS] = {
+    {
+        renderSineVoices,
+        renderSquareVoices,
+        renderSawVoices,
+        renderTriangleVoices,
+        renderNoiseVoices,
+        renderWavetableVoices
+    },
+    {
+        renderSineVoicesStereo,
+        renderSquareVoicesStereo,
+        renderSawVoicesStereo,
+        renderTriangleVoicesStereo,
+        renderNoiseVoicesStereo,
+        renderWavetableVoicesStereo
+    }
+};
+
+// ============================================================================
+// Render Threads
+// ============================================================================
+
+// A build with -DRENDER_THREADS=N can render voice groups on up to N helper
+// threads besides the audio thread. The host starts them: each runs
+// renderThreadRun() in a Web Worker sharing this module's memory, on the
+// stack from renderThreadStack(). Chunks with at least
+// RENDER_THREAD_MIN_GROUPS playing groups are split into one task per group;
+// without helpers every chunk renders on the audio thread as in a
+// single-threaded build, with the same output.
+
+#if RENDER_THREADS
+
+// Shared by all instances in the module; the audio thread runs one job at a time
+static RenderPool renderPool;
+static DSP_ALIGNED uint8_t renderThreadStacks[RENDER_THREADS][RENDER_THREAD_STACK_SIZE];
+
+typedef struct {
+    InstrumentInstance* synth;
+    const int* groups;
+    const Wavetable* table;
+    VoiceKernel renderVoices;
+    int numSamples;
+    int channels; // Mix channels the kernel writes
+} GroupRenderJob;
+
+static void renderGroupTask(void* context, int task) {
+    GroupRenderJob* job = (GroupRenderJob*)context;
+    float (*mix)[RENDER_CHUNK] = job->synth->groupMix[task];
+    for (int c = 0; c < job->channels; c++) {
+        memset(mix[c], 0, job->numSamples * sizeof(float));
+    }
+    job->renderVoices(job->synth, job->groups[task], job->table, mix[0], mix[1], job->numSamples);
+}
+
+#endif // RENDER_THREADS
+
+/**
+ * Render the playing groups into the zeroed channels of mixBuffer, on the
+ * render threads if there are enough groups to share
+ */
+static void renderGroups(InstrumentInstance* synth, const int* groups, int numGroups, const Wavetable* table,
+                         VoiceKernel renderVoices, int channels, int numSamples) {
+#if RENDER_THREADS
+    if (numGroups >= RENDER_THREAD_MIN_GROUPS && renderPoolHelpers(&renderPool) > 0) {
+        GroupRenderJob job = { synth, groups, table, renderVoices, numSamples, channels };
+        renderPoolRun(&renderPool, renderGroupTask, &job, numGroups);
+
+        for (int g = 0; g < numGroups; g++) {
+            for (int c = 0; c < channels; c++) {
+                const float* mix = synth->groupMix[g][c];
+                float* out = synth->mixBuffer[c];
+                for (int i = 0; i < numSamples; i++) {
+                    out[i] += mix[i];
+                }
+            }
+        }
+        return;
+    }
+#endif
+
+    for (int g = 0; g < numGroups; g++) {
+        renderVoices(synth, groups[g], table, synth->mixBuffer[0], synth->mixBuffer[1], numSamples);
+    }
+}
+
+// ============================================================================
+// Instance Functions
+// ============================================================================
+
+/**
+ * (Re)initialize an instance for a sample rate and block size
+ */
+static void instanceInit(InstrumentInstance* synth, float sr, int bs) {
+    synth->sampleRate = sr;
+    synth->bufferSize = bs;
+    memset(&synth->stats, 0, sizeof(synth->stats));
+    controlClockReset(&synth->control);
+
+    buildNoteTable(synth);
+    if (!wavetablesBuilt) {
+        buildWavetables();
+    }
+    synth->pitchDirty = 1;
+
+    // Initialize voices; updateUnison() lays out the lanes and the allocator
+    memset(&synth->voices, 0, sizeof(synth->voices));
+    memset(&synth->allocator, 0, sizeof(synth->allocator));
+    for (int i = 0; i < MAX_VOICES; i++) {
+        synth->voices.noiseState[i] = noiseSeed((uint32_t)i);
+    }
+    updateEnvelopeShape(synth);
+    synth->unison = 0;
+    updateUnison(synth);
+}
+
+/**
+ * Bytes of the block create() allocates: the instance, then an arena with
+ * room for all custom wavetable slots
+ */
+static size_t instanceBlockBytes(void) {
+    return arenaAlignedSize(sizeof(InstrumentInstance)) + NUM_CUSTOM_WAVETABLES * arenaAlignedSize(sizeof(Wavetable));
+}
+
+/**
+ * Create a plugin instance. Returns a handle for the instance*() functions,
+ * or 0 if out of memory.
+ */
+InstrumentInstance* create(float sr, int bs) {
+    uint8_t* block = (uint8_t*)aligned_alloc(SIMD_ALIGN, instanceBlockBytes());
+    if (!block) return NULL;
+
+    InstrumentInstance* synth = (InstrumentInstance*)block;
+    memset(synth, 0, sizeof(InstrumentInstance));
+#if NUM_CUSTOM_WAVETABLES > 0
+    arenaInit(&synth->arena, block + arenaAlignedSize(sizeof(InstrumentInstance)),
+              NUM_CUSTOM_WAVETABLES * arenaAlignedSize(sizeof(Wavetable)));
+#endif
+    memcpy(synth->params, defaultParams, sizeof(defaultParams));
+    synth->masterVolume = 0.8f;
+    synth->pitchRatio = 1.0f;
+    instanceInit(synth, sr, bs);
+    return synth;
+}
+
+/**
+ * Free an instance and its custom wavetables
+ */
+void destroy(InstrumentInstance* synth) {
+    if (!synth) return;
+    if (synth == defaultInstance) defaultInstance = NULL;
+
+    free(synth);
+}
+
+/**
+ * Render numSamples frames into outL/outR, stride floats apart per frame
+ * (NUM_CHANNELS for interleaved output, 1 for planar)
+ */
+static void renderBlock(InstrumentInstance* synth, float* outL, float* outR, int stride, int numSamples) {
+    WaveformType waveform = (WaveformType)(int)synth->params[0];
+    const Wavetable* table = wavetableForWaveform(synth, waveform, (OscillatorMode)(int)synth->params[8]);
+
+    // One kernel for the whole block; custom waveforms always have a table
+    VoiceKernelIndex kernel = table ? KERNEL_WAVETABLE : (VoiceKernelIndex)waveform;
+    VoiceKernel renderVoices = voiceKernels[synth->stereo][kernel];
+    int channels = synth->stereo ? NUM_CHANNELS : 1;
+    SaturationMode saturation = (SaturationMode)(int)synth->params[9];
+
+    // Update pitch with pitch bend and detune
+    if (synth->pitchDirty) {
+        updatePitch(synth);
+    }
+
+    // Nothing playing: output silence without running the mixdown
+    synth->quiescent = synth->allocator.activeCount == 0;
+    if (synth->quiescent) {
+        controlClockAdvance(&synth->control, numSamples);
+        if (stride == 1) {
+            memset(outL, 0, numSamples * sizeof(float));
+            memset(outR, 0, numSamples * sizeof(float));
+        } else {
+            for (int i = 0; i < numSamples; i++) {
+                outL[i * stride] = 0.0f;
+                outR[i * stride] = 0.0f;
+            }
+        }
+        return;
+    }
+
+    int groups[NUM_VOICE_GROUPS];
+    const float* mixL = synth->mixBuffer[0];
+    const float* mixR = synth->mixBuffer[channels - 1]; // Same as mixL while mono
+
+    for (int offset = 0; offset < numSamples; offset += RENDER_CHUNK) {
+        int count = numSamples - offset;
+        if (count > RENDER_CHUNK) count = RENDER_CHUNK;
+
+        for (int c = 0; c < channels; c++) {
+            memset(synth->mixBuffer[c], 0, count * sizeof(float));
+        }
+
+        int numGroups = collectActiveGroups(synth, groups);
+        renderGroups(synth, groups, numGroups, table, renderVoices, channels, count);
+        releaseFinishedVoices(synth, groups, numGroups);
+        controlClockAdvance(&synth->control, count);
+
+        // Apply master volume and saturation to the whole chunk
+        for (int c = 0; c < channels; c++) {
+            saturateBlock(synth->mixBuffer[c], count, synth->masterVolume, saturation);
+        }
+
+        // Output stereo
+        float* left = outL + offset * stride;
+        float* right = outR + offset * stride;
+        for (int i = 0; i < count; i++) {
+            left[i * stride] = mixL[i];
+            right[i * stride] = mixR[i];
+        }
+    }
+}
+
+static void applyParameter(InstrumentInstance* synth, int index, float value);
+
+// Set automated parameters to their curve's value at the end of the control block
+static void advanceAutomation(InstrumentInstance* synth) {
+    for (int i = 0; i < NUM_PARAMETERS; i++) {
+        if (!(synth->automatedParams & (1 << i))) continue;
+
+        // Flat stretches of a curve would otherwise rebuild the envelope or
+        // unison tables every control block
+        AutomationLane* lane = &synth->automation[i];
+        float value = clampParameter(i, automationLaneAdvance(lane, CONTROL_BLOCK_SIZE));
+        if (value != synth->params[i]) applyParameter(synth, i, value);
+        if (!automationLaneActive(lane)) synth->automatedParams &= ~(1 << i);
+    }
+}
+
+/**
+ * renderBlock() with automation: while any parameter is automated the block
+ * is rendered one control block at a time, with the curves applied at each
+ * start
+ */
+static void renderAutomatedBlock(InstrumentInstance* synth, float* outL, float* outR, int stride, int numSamples) {
+    int pos = 0;
+    while (pos < numSamples && synth->automatedParams) {
+        if (controlClockAtBoundary(&synth->control)) advanceAutomation(synth);
+
+        int span = controlClockSpan(&synth->control, numSamples - pos);
+        renderBlock(synth, outL + pos * stride, outR + pos * stride, stride, span);
+        pos += span;
+    }
+
+    // The rest in one pass once no lane is left
+    if (pos < numSamples) {
+        renderBlock(synth, outL + pos * stride, outR + pos * stride, stride, numSamples - pos);
+    }
+}
+
+void instanceProcess(InstrumentInstance* synth, float* input, float* output, int numSamples) {
+    double start = statsBlockBegin();
+    renderAutomatedBlock(synth, output, output + 1, NUM_CHANNELS, numSamples);
+    synth->stats.activeVoices = synth->allocator.activeCount;
+    statsBlockEnd(&synth->stats, start, numSamples, synth->sampleRate);
+}
+
+void instanceReset(InstrumentInstance* synth) {
+    resetVoices(synth);
+    controlClockReset(&synth->control);
+    synth->pitchBendValue = 0.0f;
+    synth->pitchDirty = 1;
+    synth->modWheel = 0.0f;
+    synth->automatedParams = 0;
+}
+
+// ============================================================================
+// MIDI Functions
+// ============================================================================
+
+void instanceNoteOff(InstrumentInstance* synth, int note, int channel);
+
+void instanceNoteOn(InstrumentInstance* synth, int note, int velocity, int channel) {
+    if (velocity == 0) {
+        instanceNoteOff(synth, note, channel);
+        return;
+    }
+
+    // Take a free voice or steal one
+    int lane = voiceLane(synth, allocateVoice(synth));
+    VoiceBank* voices = &synth->voices;
+    float increment = notePhaseIncrement(synth, note);
+    synth->quiescent = 0;
+
+    // Initialize each of its lanes
+    for (int u = 0; u < synth->unison; u++) {
+        int l = lane + u;
+        voices->note[l] = note;
+        voices->velocity[l] = velocity / 127.0f * synth->unisonGain;
+        voices->phase[l] = unisonPhase(u);
+        voices->phaseIncrement[l] = increment * synth->unisonRatio[u];
+        setLanePan(synth, l, u);
+        voices->envelope[l] = 0.0f;
+        voices->filterBand[l] = 0.0f;
+        voices->filterLow[l] = 0.0f;
+        resetFilterCoefficient(synth, l);
+        enterEnvelopeStage(synth, l, ENV_ATTACK);
+    }
+}
+
+void instanceNoteOff(InstrumentInstance* synth, int note, int channel) {
+    for (int i = 0; i < synth->allocator.activeCount; i++) {
+        int lane = voiceLane(synth, synth->allocator.activeList[i]);
+        if (synth->voices.note[lane] == note && synth->voices.envStage[lane] != ENV_RELEASE) {
+            for (int u = 0; u < synth->unison; u++) {
+                enterEnvelopeStage(synth, lane + u, ENV_RELEASE);
+            }
+        }
+    }
+}
+
+void instanceControlChange(InstrumentInstance* synth, int cc, int value, int channel) {
+    float normalizedValue = value / 127.0f;
+
+    switch (cc) {
+        case 1: // Mod wheel
+            synth->modWheel = normalizedValue;
+            break;
+        case 7: // Volume
+            synth->masterVolume = normalizedValue;
+            break;
+        case 74: // Filter cutoff (commonly used)
+            synth->params[5] = 20.0f + normalizedValue * 19980.0f;
+            synth->stats.parameterChanges++;
+            break;
+        case 71: // Filter resonance
+            synth->params[6] = normalizedValue;
+            synth->stats.parameterChanges++;
+            break;
+        case 123: // All notes off
+            instanceReset(synth);
+            break;
+    }
+}
+
+void instancePitchBend(InstrumentInstance* synth, int value, int channel) {
+    // value is 0-16383, center is 8192
+    synth->pitchBendValue = (value - 8192) / 8192.0f;
+    synth->pitchDirty = 1;
+}
+
+// ============================================================================
+// Event Functions
+// ============================================================================
+
+static void dispatchEvent(InstrumentInstance* synth, const TimedEvent* event) {
+    switch (event->type) {
+        case EVENT_NOTE_ON:
+            instanceNoteOn(synth, event->data1, event->data2, event->channel);
+            break;
+        case EVENT_NOTE_OFF:
+            instanceNoteOff(synth, event->data1, event->channel);
+            break;
+        case EVENT_CONTROL_CHANGE:
+            instanceControlChange(synth, event->data1, event->data2, event->channel);
+            break;
+        case EVENT_PITCH_BEND:
+            instancePitchBend(synth, event->data1, event->channel);
+            break;
+    }
+}
+
+/**
+ * Buffer the host can write up to getEventBufferCapacity() events into
+ */
+TimedEvent* instanceGetEventBuffer(InstrumentInstance* synth) {
+    return synth->eventBuffer;
+}
+
+int getEventBufferCapacity() {
+    return MAX_EVENTS_PER_BLOCK;
+}
+
+/**
+ * Process audio, applying each event at its sampleOffset within the block
+ * events: packed TimedEvent array sorted by sampleOffset (may be the event buffer)
+ */
+void instanceProcessWithEvents(InstrumentInstance* synth, float* input, float* output, int numSamples,
+                               const TimedEvent* events, int numEvents) {
+    int pos = 0;
+    int next = 0;
+    double start = statsBlockBegin();
+
+    while (pos < numSamples) {
+        // Apply everything that is due at this frame
+        while (next < numEvents && eventSpanEnd(events, numEvents, next, pos, numSamples) == pos) {
+            dispatchEvent(synth, &events[next++]);
+        }
+
+        int end = eventSpanEnd(events, numEvents, next, pos, numSamples);
+        float* out = output + pos * NUM_CHANNELS;
+        renderAutomatedBlock(synth, out, out + 1, NUM_CHANNELS, end - pos);
+        pos = end;
+    }
+
+    // Events stamped past the end of the block still take effect
+    while (next < numEvents) {
+        dispatchEvent(synth, &events[next++]);
+    }
+
+    // One block for the stats, however many spans the events split it into
+    synth->stats.activeVoices = synth->allocator.activeCount;
+    statsBlockEnd(&synth->stats, start, numSamples, synth->sampleRate);
+}
+
+/**
+ * Render an arbitrarily long block for offline export, without the
+ * per-quantum call overhead of the realtime path. input is unused.
+ * output: planar, NUM_CHANNELS runs of numSamples samples
+ * events: packed TimedEvent array sorted by sampleOffset, relative to the
+ * start of this block (any number, not limited to the event buffer).
+ * Not counted in getProcessStats(), which measures realtime load.
+ */
+void instanceProcessOffline(InstrumentInstance* synth, float* input, float* output, int numSamples,
+                            const TimedEvent* events, int numEvents) {
+    float* outL = output;
+    float* outR = output + numSamples;
+    int pos = 0;
+    int next = 0;
+
+    while (pos < numSamples) {
+        while (next < numEvents && eventSpanEnd(events, numEvents, next, pos, numSamples) == pos) {
+            dispatchEvent(synth, &events[next++]);
+        }
+
+        // renderBlock() works through long spans in RENDER_CHUNK passes
+        int end = eventSpanEnd(events, numEvents, next, pos, numSamples);
+        renderAutomatedBlock(synth, outL + pos, outR + pos, 1, end - pos);
+        pos = end;
+    }
+
+    while (next < numEvents) {
+        dispatchEvent(synth, &events[next++]);
+    }
+}
+
+// ============================================================================
+// Parameter Functions
+// ============================================================================
+
+int getParameterCount() {
+    return NUM_PARAMETERS;
+}
+
+float instanceGetParameter(InstrumentInstance* synth, int index) {
+    if (index >= 0 && index < NUM_PARAMETERS) {
+        return synth->params[index];
+    }
+    return 0.0f;
+}
+
+/**
+ * Clamp and set a parameter and update the state derived from it
+ */
+static void applyParameter(InstrumentInstance* synth, int index, float value) {
+    if (index < 0 || index >= NUM_PARAMETERS) return;
+
+    float previous = synth->params[index];
+    synth->params[index] = clampParameter(index, value);
+    switch (index) {
+        case 1: // Attack
+        case 2: // Decay
+        case 3: // Sustain
+        case 4: // Release
+            updateEnvelopeShape(synth);
+            break;
+        case 7: // Detune
+            synth->pitchDirty = 1;
+            break;
+        case 10: // Unison Voices
+        case 11: // Unison Detune
+        case 12: // Stereo Spread
+            updateUnison(synth);
+            break;
+    }
+    if (synth->params[index] != previous) synth->stats.parameterChanges++;
+}
+
+/**
+ * Set a parameter, stopping its automation
+ */
+void instanceSetParameter(InstrumentInstance* synth, int index, float value) {
+    if (index >= 0 && index < NUM_PARAMETERS) synth->automatedParams &= ~(1 << index);
+    applyParameter(synth, index, value);
+}
+
+/**
+ * Breakpoint buffer of a parameter's automation lane, holding up to
+ * getAutomationCapacity() points. Write the points, then call setAutomation().
+ */
+AutomationPoint* instanceGetAutomationBuffer(InstrumentInstance* synth, int index) {
+    if (index < 0 || index >= NUM_PARAMETERS) return NULL;
+    return synth->automation[index].points;
+}
+
+int getAutomationCapacity() {
+    return AUTOMATION_MAX_POINTS;
+}
+
+/**
+ * Automate a parameter with the first count points of its buffer, which
+ * count frames from the next frame rendered. The curve takes over from the
+ * next control block and ends at its last point; a count of 0 or
+ * setParameter() stops it.
+ */
+void instanceSetAutomation(InstrumentInstance* synth, int index, int count) {
+    if (index < 0 || index >= NUM_PARAMETERS) return;
+
+    int toBoundary = (CONTROL_BLOCK_SIZE - synth->control.position) % CONTROL_BLOCK_SIZE;
+    automationLaneStart(&synth->automation[index], count, toBoundary);
+    if (automationLaneActive(&synth->automation[index])) {
+        synth->automatedParams |= 1 << index;
+    } else {
+        synth->automatedParams &= ~(1 << index);
+    }
+}
+
+int getLatency() {
+    return 0;
+}
+
+/**
+ * Returns 1 if the last block was silent because no voice is playing, so the
+ * host may skip calling process() until the next note
+ */
+int instanceIsQuiescent(InstrumentInstance* synth) {
+    return synth->quiescent;
+}
+
+/**
+ * Number of voices currently sounding (including releasing voices), each
+ * counted once however many unison lanes it plays on
+ */
+int instanceGetActiveVoiceCount(InstrumentInstance* synth) {
+    return synth->allocator.activeCount;
+}
+
+/**
+ * Processing statistics (see dsp/stats.h). The pointer stays valid until
+ * destroy(); the host reads the struct straight from memory.
+ */
+ProcessStats* instanceGetProcessStats(InstrumentInstance* synth) {
+    return &synth->stats;
+}
+
+// ============================================================================
+// State Snapshots
+// ============================================================================
+
+/**
+ * Visit the DSP state kept in snapshots, in layout order. Parameters are
+ * stored ahead of it, and the tables derived from them (envelope shape,
+ * unison, note increments) are rebuilt when they are restored.
+ */
+static void transferState(InstrumentInstance* synth, StateCursor* c) {
+    STATE_FIELD(c, synth->voices);
+    STATE_FIELD(c, synth->allocator);
+    STATE_FIELD(c, synth->control);
+    STATE_FIELD(c, synth->quiescent);
+    STATE_FIELD(c, synth->masterVolume);
+    STATE_FIELD(c, synth->pitchBendValue);
+    STATE_FIELD(c, synth->modWheel);
+    STATE_FIELD(c, synth->pitchRatio);
+    STATE_FIELD(c, synth->pitchDirty);
+}
+
+static uint32_t dspStateSize(InstrumentInstance* synth) {
+    StateCursor c;
+    stateCursorInit(&c, NULL, STATE_MEASURE);
+    transferState(synth, &c);
+    return c.pos;
+}
+
+/**
+ * Bytes saveState() writes
+ */
+int instanceGetStateSize(InstrumentInstance* synth) {
+    return (int)stateSize(NUM_PARAMETERS, dspStateSize(synth));
+}
+
+/**
+ * Write a snapshot of the instance to data, which must hold getStateSize()
+ * bytes. Returns the bytes written.
+ */
+int instanceSaveState(InstrumentInstance* synth, void* data) {
+    uint32_t size = stateSize(NUM_PARAMETERS, dspStateSize(synth));
+    StateCursor c;
+    stateBeginSave(&c, data, STATE_PLUGIN_ID, STATE_VERSION, synth->params, NUM_PARAMETERS, size,
+                   synth->sampleRate);
+    transferState(synth, &c);
+    return (int)size;
+}
+
+/**
+ * Restore a snapshot of length bytes from saveState(). The parameters are
+ * always restored; the voices only when the snapshot was taken at the
+ * current sample rate by a build with the same polyphony and layout,
+ * otherwise all voices stop. Returns 1 on success, 0 if data is not a
+ * snapshot of this instrument (the instance is left unchanged).
+ */
+int instanceLoadState(InstrumentInstance* synth, const void* data, int length) {
+    StateHeader header;
+    if (!stateReadHeader(&header, data, length, STATE_PLUGIN_ID, NUM_PARAMETERS)) return 0;
+
+    for (int i = 0; i < NUM_PARAMETERS; i++) {
+        instanceSetParameter(synth, i, stateParameter(data, i));
+    }
+
+    StateCursor c;
+    if (stateBeginLoad(&c, &header, data, STATE_VERSION, dspStateSize(synth), synth->sampleRate)) {
+        transferState(synth, &c);
+    } else {
+        instanceReset(synth);
+    }
+    return 1;
+}
+
+// ============================================================================
+// Wavetable Functions
+// ============================================================================
+
+/**
+ * Load a custom single-cycle waveform into a wavetable slot of an instance
+ * data: one cycle of any length (resampled to WAVETABLE_SIZE)
+ * Returns 1 on success, 0 if the slot or length is invalid (always, in a
+ * build without custom slots)
+ */
+int instanceLoadWavetable(InstrumentInstance* synth, int slot, const float* data, int length) {
+    if (slot < 0 || slot >= NUM_CUSTOM_WAVETABLES || !data || length < 2) {
+        return 0;
+    }
+
+#if NUM_CUSTOM_WAVETABLES > 0
+    if (!synth->customWavetables[slot]) {
+        synth->customWavetables[slot] = (Wavetable*)arenaAlloc(&synth->arena, sizeof(Wavetable));
+        if (!synth->customWavetables[slot]) return 0;
+    }
+
+    wavetableBuildFromCycle(synth->customWavetables[slot], &wavetableScratch, data, length);
+    return 1;
+#else
+    (void)synth;
+    return 0;
+#endif
+}
+
+#if RENDER_THREADS
+
+// ============================================================================
+// Render Thread Functions
+// ============================================================================
+
+/**
+ * Most helper threads the build can use
+ */
+int getRenderThreadCount() {
+    return RENDER_THREADS;
+}
+
+/**
+ * Top of the stack for render thread index, for the host to point the
+ * thread's stack pointer at before calling renderThreadRun(); NULL if index
+ * is out of range
+ */
+void* renderThreadStack(int index) {
+    if (index < 0 || index >= RENDER_THREADS) return NULL;
+    return renderThreadStacks[index] + RENDER_THREAD_STACK_SIZE;
+}
+
+/**
+ * Serve voice rendering on the calling thread until stopRenderThreads().
+ * Blocks, so call it from a Web Worker, never the audio thread.
+ */
+void renderThreadRun(int index) {
+    if (index < 0 || index >= RENDER_THREADS) return;
+    renderPoolWorker(&renderPool);
+}
+
+/**
+ * Make every render thread return from renderThreadRun(); rendering goes
+ * back to the audio thread alone
+ */
+void stopRenderThreads() {
+    renderPoolStop(&renderPool);
+}
+
+#endif // RENDER_THREADS
+
+// ============================================================================
+// Core Functions (default instance)
+// ============================================================================
+
+// Default instance, created on first use
+static InstrumentInstance* getDefaultInstance() {
+    if (!defaultInstance) {
+        defaultInstance = create(44100.0f, 128);
+    }
+    return defaultInstance;
+}
+
+void init(float sr, int bs) {
+    if (defaultInstance) {
+        instanceInit(defaultInstance, sr, bs);
+    } else {
+        defaultInstance = create(sr, bs);
+    }
+}
+
+void process(float* input, float* output, int numSamples) {
+    InstrumentInstance* synth = getDefaultInstance();
+    if (synth) instanceProcess(synth, input, output, numSamples);
+}
+
+void reset() {
+    if (defaultInstance) instanceReset(defaultInstance);
+}
+
+void dispose() {
+    destroy(defaultInstance);
+}
+
+void noteOn(int note, int velocity, int channel) {
+    InstrumentInstance* synth = getDefaultInstance();
+    if (synth) instanceNoteOn(synth, note, velocity, channel);
+}
+
+void noteOff(int note, int channel) {
+    InstrumentInstance* synth = getDefaultInstance();
+    if (synth) instanceNoteOff(synth, note, channel);
+}
+
+void controlChange(int cc, int value, int channel) {
+    InstrumentInstance* synth = getDefaultInstance();
+    if (synth) instanceControlChange(synth, cc, value, channel);
+}
+
+void pitchBend(int value, int channel) {
+    InstrumentInstance* synth = getDefaultInstance();
+    if (synth) instancePitchBend(synth, value, channel);
+}
+
+TimedEvent* getEventBuffer() {
+    InstrumentInstance* synth = getDefaultInstance();
+    return synth ? instanceGetEventBuffer(synth) : NULL;
+}
+
+void processWithEvents(float* input, float* output, int numSamples, const TimedEvent* events, int numEvents) {
+    InstrumentInstance* synth = getDefaultInstance();
+    if (synth) instanceProcessWithEvents(synth, input, output, numSamples, events, numEvents);
+}
+
+void processOffline(float* input, float* output, int numSamples, const TimedEvent* events, int numEvents) {
+    InstrumentInstance* synth = getDefaultInstance();
+    if (synth) instanceProcessOffline(synth, input, output, numSamples, events, numEvents);
+}
+
+float getParameter(int index) {
+    InstrumentInstance* synth = getDefaultInstance();
+    return synth ? instanceGetParameter(synth, index) : 0.0f;
+}
+
+void setParameter(int index, float value) {
+    InstrumentInstance* synth = getDefaultInstance();
+    if (synth) instanceSetParameter(synth, index, value);
+}
+
+int isQuiescent() {
+    return defaultInstance ? instanceIsQuiescent(defaultInstance) : 1;
+}
+
+int getActiveVoiceCount() {
+    return defaultInstance ? instanceGetActiveVoiceCount(defaultInstance) : 0;
+}
+
+ProcessStats* getProcessStats() {
+    InstrumentInstance* synth = getDefaultInstance();
+    return synth ? instanceGetProcessStats(synth) : NULL;
+}
+
+int loadWavetable(int slot, const float* data, int length) {
+    InstrumentInstance* synth = getDefaultInstance();
+    return synth ? instanceLoadWavetable(synth, slot, data, length) : 0;
+}
+
+AutomationPoint* getAutomationBuffer(int index) {
+    InstrumentInstance* synth = getDefaultInstance();
+    return synth ? instanceGetAutomationBuffer(synth, index) : NULL;
+}
+
+void setAutomation(int index, int count) {
+    InstrumentInstance* synth = getDefaultInstance();
+    if (synth) instanceSetAutomation(synth, index, count);
+}
+
+int getStateSize() {
+    InstrumentInstance* synth = getDefaultInstance();
+    return synth ? instanceGetStateSize(synth) : 0;
+}
+
+int saveState(void* data) {
+    InstrumentInstance* synth = getDefaultInstance();
+    return synth ? instanceSaveState(synth, data) : 0;
+}
+
+int loadState(const void* data, int length) {
+    InstrumentInstance* synth = getDefaultInstance();
+    return synth ? instanceLoadState(synth, data, length) : 0;
+}
+
+/**
+ * Heap bytes one instance created with create(sampleRate, maxBlock) takes,
+ * so the host can size WASM memory up front. create() allocates the instance
+ * and the room for all custom wavetable slots in this one block, so
+ * loadWavetable() never allocates. The built-in wavetables are static data,
+ * already part of the module's own memory.
+ */
+int getRequiredMemory(float sampleRate, int maxBlock) {
+    (void)sampleRate;
+    (void)maxBlock;
+    return (int)heapBlockBytes(instanceBlockBytes());
+}
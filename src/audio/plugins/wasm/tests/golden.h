@@ -0,0 +1,175 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Golden-output checks for the plugin templates
+ *
+ * A golden test renders fixed scenarios and compares each against a
+ * reference line in a text file:
+ *
+ *   <scenario> <count> <rms> <rms> ...
+ *
+ * holding the RMS level of every GOLDEN_BLOCK frames of every channel.
+ * Levels are compared with a small tolerance, so rounding differences
+ * between compilers, SIMD and scalar builds, or a changed summation order
+ * pass, while anything audible (a different waveform, envelope, filter
+ * response or event timing) fails.
+ *
+ * Usage: golden_<template> <reference.txt> [--update]
+ * --update rewrites the reference file from the current output; review the
+ * diff before committing it.
+ */
+
+#ifndef ANKH_GOLDEN_H
+#define ANKH_GOLDEN_H
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GOLDEN_BLOCK 1024
+#define GOLDEN_MAX_VALUES 1024
+
+// A level passes if within GOLDEN_ABS_TOLERANCE or GOLDEN_REL_TOLERANCE of the reference
+#define GOLDEN_ABS_TOLERANCE 1e-6
+#define GOLDEN_REL_TOLERANCE 1e-3
+
+typedef struct {
+    const char* path;
+    int update;
+    FILE* out;       // Update mode: reference being written
+    char* reference; // Check mode: reference file contents
+    int checked;
+    int failures;
+} Golden;
+
+/**
+ * Parse the command line and open the reference file. Returns 0 on failure.
+ */
+static int goldenOpen(Golden* g, int argc, char** argv) {
+    memset(g, 0, sizeof(Golden));
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <reference.txt> [--update]\n", argv[0]);
+        return 0;
+    }
+    g->path = argv[1];
+    g->update = argc > 2 && strcmp(argv[2], "--update") == 0;
+
+    if (g->update) {
+        g->out = fopen(g->path, "w");
+        if (!g->out) {
+            fprintf(stderr, "cannot write %s\n", g->path);
+            return 0;
+        }
+        return 1;
+    }
+
+    FILE* in = fopen(g->path, "rb");
+    if (!in) {
+        fprintf(stderr, "cannot read %s (run with --update to create it)\n", g->path);
+        return 0;
+    }
+    fseek(in, 0, SEEK_END);
+    long size = ftell(in);
+    fseek(in, 0, SEEK_SET);
+    g->reference = (char*)malloc(size + 1);
+    size_t got = g->reference ? fread(g->reference, 1, size, in) : 0;
+    fclose(in);
+    if (!g->reference || got != (size_t)size) {
+        fprintf(stderr, "cannot read %s\n", g->path);
+        return 0;
+    }
+    g->reference[size] = '\0';
+    return 1;
+}
+
+/**
+ * Reference line for a scenario, or NULL
+ */
+static const char* goldenFind(const Golden* g, const char* scenario) {
+    size_t length = strlen(scenario);
+    const char* line = g->reference;
+    while (line && *line) {
+        if (strncmp(line, scenario, length) == 0 && line[length] == ' ') {
+            return line + length;
+        }
+        line = strchr(line, '\n');
+        if (line) line++;
+    }
+    return NULL;
+}
+
+/**
+ * Check (or record) a rendered scenario. samples holds frames frames of
+ * numChannels interleaved channels.
+ */
+static void goldenCheck(Golden* g, const char* scenario, const float* samples, int frames, int numChannels) {
+    static double levels[GOLDEN_MAX_VALUES];
+    int count = 0;
+
+    for (int ch = 0; ch < numChannels; ch++) {
+        for (int start = 0; start < frames && count < GOLDEN_MAX_VALUES; start += GOLDEN_BLOCK) {
+            int end = start + GOLDEN_BLOCK < frames ? start + GOLDEN_BLOCK : frames;
+            double sum = 0.0;
+            for (int i = start; i < end; i++) {
+                double s = samples[i * numChannels + ch];
+                sum += s * s;
+            }
+            levels[count++] = sqrt(sum / (end - start));
+        }
+    }
+
+    g->checked++;
+
+    if (g->update) {
+        fprintf(g->out, "%s %d", scenario, count);
+        for (int i = 0; i < count; i++) fprintf(g->out, " %.9g", levels[i]);
+        fprintf(g->out, "\n");
+        return;
+    }
+
+    const char* line = goldenFind(g, scenario);
+    if (!line) {
+        printf("FAIL %s: no reference\n", scenario);
+        g->failures++;
+        return;
+    }
+
+    char* cursor;
+    long expectedCount = strtol(line, &cursor, 10);
+    if (expectedCount != count) {
+        printf("FAIL %s: %d levels, reference has %ld\n", scenario, count, expectedCount);
+        g->failures++;
+        return;
+    }
+
+    for (int i = 0; i < count; i++) {
+        double expected = strtod(cursor, &cursor);
+        double diff = fabs(levels[i] - expected);
+        if (diff > GOLDEN_ABS_TOLERANCE && diff > GOLDEN_REL_TOLERANCE * fabs(expected)) {
+            int blocksPerChannel = count / numChannels;
+            printf("FAIL %s: channel %d block %d level %.9g, reference %.9g\n",
+                   scenario, i / blocksPerChannel, i % blocksPerChannel, levels[i], expected);
+            g->failures++;
+            return;
+        }
+    }
+}
+
+/**
+ * Print a summary and free the reference. Returns the process exit code.
+ */
+static int goldenClose(Golden* g) {
+    if (g->out) fclose(g->out);
+    free(g->reference);
+
+    if (g->update) {
+        printf("wrote %d scenarios to %s\n", g->checked, g->path);
+        return 0;
+    }
+    printf("%d/%d scenarios match %s\n", g->checked - g->failures, g->checked, g->path);
+    return g->failures ? 1 : 0;
+}
+
+#endif // ANKH_GOLDEN_H
@@ -0,0 +1,113 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Golden-output test for drumsynth/drumsynth.c
+ *
+ * Renders patches from samples/drumsynth that between them use every
+ * source, overtone method, filter mode and distortion setting, at several
+ * sample rates, and compares the levels against tests/golden/drumsynth.txt
+ * (see golden.h). Also checks that a render is repeatable, since the host
+ * caches renders by patch content.
+ */
+
+#include "golden.h"
+
+// ============================================================================
+// Renderer ABI
+// ============================================================================
+
+int renderPatch(const char* text, int length, float sampleRate);
+float* getRenderOutput();
+void releaseRender();
+
+#ifndef DRUMSYNTH_PATCH_DIR
+#define DRUMSYNTH_PATCH_DIR "../../../../samples/drumsynth"
+#endif
+
+#define MAX_PATCH_BYTES 16384
+
+typedef struct {
+    const char* path;
+    float sampleRate;
+} Scenario;
+
+static const Scenario scenarios[] = {
+    { "tr808/Kick.ds", 44100.0f },
+    { "tr808/Kick.ds", 48000.0f },
+    { "tr808/Kick.ds", 96000.0f },
+    { "tr808/Snare.ds", 44100.0f },
+    { "tr808/Clave.ds", 44100.0f },        // Additive overtones
+    { "tr808/Hat_o.ds", 44100.0f },        // 808 cymbal, filtered
+    { "tr808/Hat_o.ds", 96000.0f },
+    { "tr909/Kick.ds", 48000.0f },
+    { "effects/dialing.ds", 44100.0f },    // FM overtones
+    { "effects/Laser.ds", 44100.0f },      // Ring modulation tracking the tone
+    { "acoustic/Brush1.ds", 44100.0f },    // Version 1 patch, lowpassed noise
+    { "acoustic/JazzKick.ds", 44100.0f },  // Pitch droop
+    { "acoustic/Ride.ds", 44100.0f },      // Second noise band
+    { "electro/K_8bit.ds", 44100.0f },     // Bit reduction and downsampling
+    { "ferraro/eel_bass.ds", 44100.0f },   // Resonant filter
+    { "ferraro/gerbil_snare.ds", 48000.0f } // Time stretch
+};
+#define NUM_SCENARIOS ((int)(sizeof(scenarios) / sizeof(scenarios[0])))
+
+static char text[MAX_PATCH_BYTES];
+
+static int readPatch(const char* path) {
+    char fullPath[1024];
+    snprintf(fullPath, sizeof(fullPath), "%s/%s", DRUMSYNTH_PATCH_DIR, path);
+
+    FILE* in = fopen(fullPath, "rb");
+    if (!in) return -1;
+    int length = (int)fread(text, 1, sizeof(text), in);
+    fclose(in);
+    return length;
+}
+
+int main(int argc, char** argv) {
+    Golden g;
+    if (!goldenOpen(&g, argc, argv)) return 1;
+
+    char name[128];
+
+    for (int s = 0; s < NUM_SCENARIOS; s++) {
+        const Scenario* scenario = &scenarios[s];
+        snprintf(name, sizeof(name), "%s@%.0f", scenario->path, scenario->sampleRate);
+
+        int length = readPatch(scenario->path);
+        int frames = length > 0 ? renderPatch(text, length, scenario->sampleRate) : 0;
+        if (frames <= 0) {
+            printf("FAIL %s: %s\n", name, length < 0 ? "cannot read patch" : "not rendered");
+            g.failures++;
+            continue;
+        }
+
+        goldenCheck(&g, name, getRenderOutput(), frames, 1);
+    }
+
+    // Renders of the same patch must match exactly
+    int length = readPatch("tr808/Hat_o.ds");
+    if (length > 0) {
+        int frames = renderPatch(text, length, 44100.0f);
+        float* first = (float*)malloc(frames * sizeof(float));
+        memcpy(first, getRenderOutput(), frames * sizeof(float));
+        renderPatch("[General]\nVersion=DrumSynth v2.0\n", 33, 44100.0f);
+
+        if (renderPatch(text, length, 44100.0f) != frames ||
+            memcmp(first, getRenderOutput(), frames * sizeof(float)) != 0) {
+            printf("FAIL repeated render of tr808/Hat_o.ds differs\n");
+            g.failures++;
+        }
+        free(first);
+    }
+
+    // Not a patch
+    if (renderPatch("[General]\nVersion=Other\n", 24, 44100.0f) != 0) {
+        printf("FAIL non-DrumSynth text rendered\n");
+        g.failures++;
+    }
+
+    releaseRender();
+    return goldenClose(&g);
+}
@@ -0,0 +1,334 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Golden-output test for effect_template.c
+ *
+ * Runs a test signal through every processing path with several parameter
+ * settings, ramps, automation curves and a silence gap (idle entry and wake-up), and compares
+ * the levels against tests/golden/effect.txt (see golden.h). Also checks
+ * that a state snapshot taken mid-ramp resumes exactly, and that
+ * processBatch() matches processing each instance on its own.
+ */
+
+#include "golden.h"
+#include "dsp/automation.h"
+
+// ============================================================================
+// Template ABI
+// ============================================================================
+
+void* create(float sr, int bs);
+void destroy(void* fx);
+void instanceProcess(void* fx, float* input, float* output, int numSamples);
+void instanceProcessBlock(void* fx, float* input, float* output, int numSamples, int numChannels);
+void instanceProcessOffline(void* fx, float* input, float* output, int numSamples, int numChannels);
+float* instanceGetInputBuffer(void* fx, int ch);
+float* instanceGetOutputBuffer(void* fx, int ch);
+void instanceProcessBuffers(void* fx, int numSamples, int numChannels);
+void instanceSetParameter(void* fx, int index, float value);
+void instanceSetParameterRamp(void* fx, int index, float target, int durationSamples);
+AutomationPoint* instanceGetAutomationBuffer(void* fx, int index);
+void instanceSetAutomation(void* fx, int index, int count);
+int instanceGetStateSize(void* fx);
+int instanceSaveState(void* fx, void* data);
+int instanceLoadState(void* fx, const void* data, int length);
+void processBatch(void** instances, int count, int numSamples, int numChannels);
+
+#define PARAM_GAIN 0
+#define PARAM_MIX 1
+#define PARAM_CUTOFF 2
+
+#define NUM_CHANNELS 2
+#define SAMPLE_RATE 44100.0f
+#define FRAMES 44100
+#define BLOCK 128
+
+// Frame the snapshot is taken at: mid-ramp, inside a control block
+#define SNAPSHOT_FRAME 10007
+
+// Instances in the batch: a full group of SIMD lanes and a partial one,
+// with one instance BATCH_SHIFT frames out of step with the rest
+#define BATCH_INSTANCES 6
+#define BATCH_OUT_OF_STEP 5
+#define BATCH_SHIFT 5
+
+typedef enum {
+    PATH_INTERLEAVED = 0,
+    PATH_PLANAR,
+    PATH_BUFFERS,
+    PATH_OFFLINE
+} ProcessPath;
+
+static float input[FRAMES * NUM_CHANNELS];
+static float output[FRAMES * NUM_CHANNELS];
+static float planarIn[FRAMES * NUM_CHANNELS];
+static float planarOut[FRAMES * NUM_CHANNELS];
+
+/**
+ * Stereo test signal: a low and a high sine per channel, so the lowpass
+ * visibly changes the level, with an optional silent gap
+ */
+static void makeSignal(int gap) {
+    for (int i = 0; i < FRAMES; i++) {
+        int silent = gap && i >= FRAMES / 4 && i < FRAMES / 2;
+        float low = 0.4f * sinf(i * 0.02f);
+        float high = 0.3f * sinf(i * 0.9f);
+        input[i * 2] = silent ? 0.0f : low + high;
+        input[i * 2 + 1] = silent ? 0.0f : low - high;
+    }
+}
+
+static void renderPath(void* fx, ProcessPath path) {
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        for (int i = 0; i < FRAMES; i++) planarIn[ch * FRAMES + i] = input[i * NUM_CHANNELS + ch];
+    }
+
+    if (path == PATH_OFFLINE) {
+        instanceProcessOffline(fx, planarIn, planarOut, FRAMES, NUM_CHANNELS);
+    }
+
+    for (int pos = 0; pos < FRAMES && path != PATH_OFFLINE; pos += BLOCK) {
+        int frames = FRAMES - pos < BLOCK ? FRAMES - pos : BLOCK;
+
+        if (path == PATH_INTERLEAVED) {
+            instanceProcess(fx, input + pos * NUM_CHANNELS, output + pos * NUM_CHANNELS, frames);
+            continue;
+        }
+
+        float in[BLOCK * NUM_CHANNELS];
+        float out[BLOCK * NUM_CHANNELS];
+        for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+            memcpy(in + ch * frames, planarIn + ch * FRAMES + pos, frames * sizeof(float));
+        }
+
+        if (path == PATH_PLANAR) {
+            instanceProcessBlock(fx, in, out, frames, NUM_CHANNELS);
+        } else {
+            for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+                memcpy(instanceGetInputBuffer(fx, ch), in + ch * frames, frames * sizeof(float));
+            }
+            instanceProcessBuffers(fx, frames, NUM_CHANNELS);
+            for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+                memcpy(out + ch * frames, instanceGetOutputBuffer(fx, ch), frames * sizeof(float));
+            }
+        }
+
+        for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+            memcpy(planarOut + ch * FRAMES + pos, out + ch * frames, frames * sizeof(float));
+        }
+    }
+
+    if (path != PATH_INTERLEAVED) {
+        for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+            for (int i = 0; i < FRAMES; i++) output[i * NUM_CHANNELS + ch] = planarOut[ch * FRAMES + i];
+        }
+    }
+}
+
+static void* newEffect(float gain, float mix, float cutoff) {
+    void* fx = create(SAMPLE_RATE, BLOCK);
+    if (!fx) {
+        fprintf(stderr, "create() failed\n");
+        exit(1);
+    }
+    instanceSetParameter(fx, PARAM_GAIN, gain);
+    instanceSetParameter(fx, PARAM_MIX, mix);
+    instanceSetParameter(fx, PARAM_CUTOFF, cutoff);
+    return fx;
+}
+
+// Upload a lane of count points to parameter index
+static void automate(void* fx, int index, const AutomationPoint* points, int count) {
+    memcpy(instanceGetAutomationBuffer(fx, index), points, count * sizeof(AutomationPoint));
+    instanceSetAutomation(fx, index, count);
+}
+
+static void run(Golden* g, const char* name, void* fx, ProcessPath path) {
+    renderPath(fx, path);
+    goldenCheck(g, name, output, FRAMES, NUM_CHANNELS);
+    destroy(fx);
+}
+
+// Process frames from..to of the test signal interleaved, in BLOCK blocks
+static void processSpan(void* fx, int from, int to) {
+    for (int pos = from; pos < to; pos += BLOCK) {
+        int frames = to - pos < BLOCK ? to - pos : BLOCK;
+        instanceProcess(fx, input + pos * NUM_CHANNELS, output + pos * NUM_CHANNELS, frames);
+    }
+}
+
+/**
+ * Snapshot an effect mid-ramp, load it into a new instance and check that
+ * both process the rest identically
+ */
+static void checkSnapshot(Golden* g) {
+    static float expected[(FRAMES - SNAPSHOT_FRAME) * NUM_CHANNELS];
+
+    void* original = newEffect(0.2f, 0.0f, 200.0f);
+    instanceSetParameterRamp(original, PARAM_GAIN, 1.5f, FRAMES / 2);
+    instanceSetParameterRamp(original, PARAM_CUTOFF, 12000.0f, FRAMES);
+    processSpan(original, 0, SNAPSHOT_FRAME);
+
+    int size = instanceGetStateSize(original);
+    void* state = malloc(size);
+    if (instanceSaveState(original, state) != size) {
+        printf("FAIL snapshot: saveState() size differs from getStateSize()\n");
+        g->failures++;
+    }
+    processSpan(original, SNAPSHOT_FRAME, FRAMES);
+    memcpy(expected, output + SNAPSHOT_FRAME * NUM_CHANNELS, sizeof(expected));
+
+    void* restored = create(SAMPLE_RATE, BLOCK);
+    if (!instanceLoadState(restored, state, size)) {
+        printf("FAIL snapshot: loadState() rejected its own snapshot\n");
+        g->failures++;
+    }
+    processSpan(restored, SNAPSHOT_FRAME, FRAMES);
+    if (memcmp(expected, output + SNAPSHOT_FRAME * NUM_CHANNELS, sizeof(expected)) != 0) {
+        printf("FAIL snapshot: restored instance processes differently\n");
+        g->failures++;
+    }
+
+    // Truncated snapshots are rejected
+    if (instanceLoadState(restored, state, size - 1)) {
+        printf("FAIL snapshot: loadState() accepted a truncated snapshot\n");
+        g->failures++;
+    }
+
+    free(state);
+    destroy(original);
+    destroy(restored);
+}
+
+static void* newBatchEffect(int n) {
+    static const AutomationPoint cutoffCurve[] = {
+        { 0, 400.0f, CURVE_LINEAR, 0.0f },
+        { FRAMES / 3, 9000.0f, CURVE_EXPONENTIAL, 0.5f },
+        { FRAMES * 2 / 3, 800.0f, CURVE_SMOOTH, 0.0f }
+    };
+
+    void* fx = newEffect(0.5f + 0.25f * n, 0.2f * n, 300.0f + 2000.0f * n);
+    if (n % 2) instanceSetParameterRamp(fx, PARAM_CUTOFF, 12000.0f - 1500.0f * n, FRAMES / 2);
+    if (n == 2) instanceSetParameterRamp(fx, PARAM_GAIN, 1.8f, FRAMES / 3);
+    if (n == 4) automate(fx, PARAM_CUTOFF, cutoffCurve, 3);
+    return fx;
+}
+
+// Frames pos.. of batch instance n's input: the test signal, silent for a
+// while on instance 3 so it goes idle and wakes up
+static void loadBatchInput(void* fx, int n, int pos, int frames) {
+    int silent = n == 3 && pos >= FRAMES / 4 && pos < FRAMES / 2;
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        float* buffer = instanceGetInputBuffer(fx, ch);
+        for (int i = 0; i < frames; i++) {
+            buffer[i] = silent ? 0.0f : input[(pos + i) * NUM_CHANNELS + ch];
+        }
+    }
+}
+
+/**
+ * Process instances with different settings through processBatch() and
+ * each on its own, and check that both produce identical output
+ */
+static void checkBatch(Golden* g) {
+    void* single[BATCH_INSTANCES];
+    void* batched[BATCH_INSTANCES];
+    for (int n = 0; n < BATCH_INSTANCES; n++) {
+        single[n] = newBatchEffect(n);
+        batched[n] = newBatchEffect(n);
+    }
+
+    // Put one instance's control clock out of step
+    loadBatchInput(single[BATCH_OUT_OF_STEP], BATCH_OUT_OF_STEP, 0, BATCH_SHIFT);
+    instanceProcessBuffers(single[BATCH_OUT_OF_STEP], BATCH_SHIFT, NUM_CHANNELS);
+    loadBatchInput(batched[BATCH_OUT_OF_STEP], BATCH_OUT_OF_STEP, 0, BATCH_SHIFT);
+    instanceProcessBuffers(batched[BATCH_OUT_OF_STEP], BATCH_SHIFT, NUM_CHANNELS);
+
+    int mismatch = 0;
+    for (int pos = 0; pos < FRAMES - BATCH_SHIFT; pos += BLOCK) {
+        int frames = FRAMES - BATCH_SHIFT - pos < BLOCK ? FRAMES - BATCH_SHIFT - pos : BLOCK;
+
+        for (int n = 0; n < BATCH_INSTANCES; n++) {
+            int start = pos + (n == BATCH_OUT_OF_STEP ? BATCH_SHIFT : 0);
+            loadBatchInput(single[n], n, start, frames);
+            instanceProcessBuffers(single[n], frames, NUM_CHANNELS);
+            loadBatchInput(batched[n], n, start, frames);
+        }
+        processBatch(batched, BATCH_INSTANCES, frames, NUM_CHANNELS);
+
+        for (int n = 0; n < BATCH_INSTANCES; n++) {
+            for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+                mismatch = mismatch || memcmp(instanceGetOutputBuffer(single[n], ch),
+                                              instanceGetOutputBuffer(batched[n], ch),
+                                              frames * sizeof(float)) != 0;
+            }
+        }
+    }
+    if (mismatch) {
+        printf("FAIL batch: processBatch() output differs from processing each instance\n");
+        g->failures++;
+    }
+
+    for (int n = 0; n < BATCH_INSTANCES; n++) {
+        destroy(single[n]);
+        destroy(batched[n]);
+    }
+}
+
+int main(int argc, char** argv) {
+    Golden g;
+    if (!goldenOpen(&g, argc, argv)) return 1;
+
+    static const char* pathNames[] = { "interleaved", "planar", "buffers", "offline" };
+    char name[64];
+
+    makeSignal(0);
+
+    // Every path with the default settings
+    for (int path = PATH_INTERLEAVED; path <= PATH_OFFLINE; path++) {
+        snprintf(name, sizeof(name), "default-%s", pathNames[path]);
+        run(&g, name, newEffect(1.0f, 0.5f, 1000.0f), (ProcessPath)path);
+    }
+
+    // Parameter settings
+    run(&g, "wet-200hz", newEffect(1.0f, 1.0f, 200.0f), PATH_PLANAR);
+    run(&g, "wet-8khz-gain0.5", newEffect(0.5f, 1.0f, 8000.0f), PATH_PLANAR);
+    run(&g, "dry-gain2", newEffect(2.0f, 0.0f, 1000.0f), PATH_INTERLEAVED);
+
+    // Ramps, interpolated inside the plugin
+    void* ramped = newEffect(0.2f, 0.0f, 200.0f);
+    instanceSetParameterRamp(ramped, PARAM_GAIN, 1.5f, FRAMES / 2);
+    instanceSetParameterRamp(ramped, PARAM_MIX, 1.0f, FRAMES / 3);
+    instanceSetParameterRamp(ramped, PARAM_CUTOFF, 12000.0f, FRAMES);
+    run(&g, "ramps-planar", ramped, PATH_PLANAR);
+
+    // Automation curves of every shape, evaluated inside the plugin
+    static const AutomationPoint gainCurve[] = {
+        { 0, 0.2f, CURVE_LINEAR, 0.0f },
+        { FRAMES / 5, 1.5f, CURVE_SMOOTH, 0.0f },
+        { FRAMES * 2 / 5, 0.4f, CURVE_EXPONENTIAL, 0.5f },
+        { FRAMES * 3 / 5, 1.8f, CURVE_BEZIER, -0.5f },
+        { FRAMES * 4 / 5, 0.6f, CURVE_STEP, 0.0f }
+    };
+    static const AutomationPoint cutoffCurve[] = {
+        { 1000, 200.0f, CURVE_LINEAR, 0.0f },
+        { FRAMES / 2, 12000.0f, CURVE_EXPONENTIAL, 1.0f },
+        { FRAMES - 1000, 500.0f, CURVE_LINEAR, 0.0f }
+    };
+    void* automated = newEffect(1.0f, 1.0f, 1000.0f);
+    automate(automated, PARAM_GAIN, gainCurve, 5);
+    automate(automated, PARAM_CUTOFF, cutoffCurve, 3);
+    run(&g, "automation-planar", automated, PATH_PLANAR);
+
+    // Silent gap: the plugin goes idle and must wake up cleanly
+    makeSignal(1);
+    run(&g, "gap-interleaved", newEffect(1.0f, 1.0f, 1000.0f), PATH_INTERLEAVED);
+    run(&g, "gap-planar", newEffect(1.0f, 1.0f, 1000.0f), PATH_PLANAR);
+
+    makeSignal(0);
+    checkSnapshot(&g);
+    checkBatch(&g);
+
+    return goldenClose(&g);
+}
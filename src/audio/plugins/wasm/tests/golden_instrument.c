@@ -0,0 +1,281 @@
+/* Copyright (c) 2025 Jema Technology.
+ * Distributed under the license specified in the root directory of this project.
+ */
+/**
+ * Golden-output test for instrument_template.c
+ *
+ * Renders a chord with every waveform and oscillator mode, plus scenarios
+ * for events, pitch bend, filter CCs, saturation, voice stealing, unison,
+ * custom wavetables, automation, block sizes and the offline path, and compares the levels
+ * against tests/golden/instrument.txt (see golden.h). Also checks that a
+ * state snapshot taken mid-note resumes exactly. A build with
+ * -DRENDER_THREADS=N renders on helper threads and must match the same
+ * references.
+ */
+
+#include "golden.h"
+#include "render_threads.h"
+#include "dsp/events.h"
+#include "dsp/automation.h"
+
+// ============================================================================
+// Template ABI
+// ============================================================================
+
+void* create(float sr, int bs);
+void destroy(void* synth);
+void instanceProcessWithEvents(void* synth, float* input, float* output, int numSamples,
+                               const TimedEvent* events, int numEvents);
+void instanceProcessOffline(void* synth, float* input, float* output, int numSamples,
+                            const TimedEvent* events, int numEvents);
+void instanceSetParameter(void* synth, int index, float value);
+int instanceLoadWavetable(void* synth, int slot, const float* data, int length);
+AutomationPoint* instanceGetAutomationBuffer(void* synth, int index);
+void instanceSetAutomation(void* synth, int index, int count);
+int instanceGetStateSize(void* synth);
+int instanceSaveState(void* synth, void* data);
+int instanceLoadState(void* synth, const void* data, int length);
+
+#define PARAM_WAVEFORM 0
+#define PARAM_CUTOFF 5
+#define PARAM_SATURATION 9
+#define PARAM_OSC_MODE 8
+#define PARAM_UNISON 10
+#define PARAM_UNISON_DETUNE 11
+#define PARAM_STEREO_SPREAD 12
+#define WAVE_CUSTOM 5
+
+#define SAMPLE_RATE 44100.0f
+#define FRAMES 44100
+#define MAX_SCENARIO_EVENTS 64
+
+// Frame the snapshot is taken at: mid-note, inside a control block
+#define SNAPSHOT_FRAME 10007
+
+static const char* waveformNames[] = { "sine", "square", "saw", "triangle", "noise" };
+static const char* modeNames[] = { "analytic", "wavetable" };
+
+static float output[FRAMES * 2];
+static float planar[FRAMES * 2];
+
+typedef struct {
+    TimedEvent events[MAX_SCENARIO_EVENTS];
+    int count;
+} Score;
+
+static void scoreAdd(Score* score, int frame, int type, int data1, int data2) {
+    if (score->count < MAX_SCENARIO_EVENTS) {
+        score->events[score->count++] = (TimedEvent){ frame, type, data1, data2, 0 };
+    }
+}
+
+// C major chord held for half a second, then released
+static Score chord() {
+    Score score = { .count = 0 };
+    scoreAdd(&score, 0, EVENT_NOTE_ON, 60, 100);
+    scoreAdd(&score, 0, EVENT_NOTE_ON, 64, 90);
+    scoreAdd(&score, 0, EVENT_NOTE_ON, 67, 80);
+    scoreAdd(&score, FRAMES / 2, EVENT_NOTE_OFF, 60, 0);
+    scoreAdd(&score, FRAMES / 2, EVENT_NOTE_OFF, 64, 0);
+    scoreAdd(&score, FRAMES / 2, EVENT_NOTE_OFF, 67, 0);
+    return score;
+}
+
+/**
+ * Render frames from..to of a score through processWithEvents() in
+ * blockSize blocks, as the worklet does
+ */
+static void renderSpan(void* synth, const Score* score, int blockSize, int from, int to) {
+    TimedEvent block[MAX_SCENARIO_EVENTS];
+    int next = 0;
+    while (next < score->count && score->events[next].sampleOffset < from) next++;
+
+    for (int pos = from; pos < to; pos += blockSize) {
+        int frames = to - pos < blockSize ? to - pos : blockSize;
+        int count = 0;
+        while (next < score->count && score->events[next].sampleOffset < pos + frames) {
+            block[count] = score->events[next++];
+            block[count++].sampleOffset -= pos;
+        }
+        instanceProcessWithEvents(synth, NULL, output + pos * 2, frames, block, count);
+    }
+}
+
+static void render(void* synth, const Score* score, int blockSize) {
+    renderSpan(synth, score, blockSize, 0, FRAMES);
+}
+
+static void* newSynth(int waveform, int mode) {
+    void* synth = create(SAMPLE_RATE, 128);
+    if (!synth) {
+        fprintf(stderr, "create() failed\n");
+        exit(1);
+    }
+    instanceSetParameter(synth, PARAM_WAVEFORM, (float)waveform);
+    instanceSetParameter(synth, PARAM_OSC_MODE, (float)mode);
+    return synth;
+}
+
+// Upload a lane of count points to parameter index
+static void automate(void* synth, int index, const AutomationPoint* points, int count) {
+    memcpy(instanceGetAutomationBuffer(synth, index), points, count * sizeof(AutomationPoint));
+    instanceSetAutomation(synth, index, count);
+}
+
+static void runScore(Golden* g, const char* name, void* synth, const Score* score, int blockSize) {
+    render(synth, score, blockSize);
+    goldenCheck(g, name, output, FRAMES, 2);
+    destroy(synth);
+}
+
+/**
+ * Snapshot a spread unison chord mid-note, load it into a new instance and
+ * check that both render the rest identically
+ */
+static void checkSnapshot(Golden* g) {
+    static float expected[(FRAMES - SNAPSHOT_FRAME) * 2];
+    Score score = chord();
+
+    void* original = newSynth(2, 1);
+    instanceSetParameter(original, PARAM_UNISON, 3.0f);
+    instanceSetParameter(original, PARAM_STEREO_SPREAD, 0.7f);
+    renderSpan(original, &score, 128, 0, SNAPSHOT_FRAME);
+
+    int size = instanceGetStateSize(original);
+    void* state = malloc(size);
+    if (instanceSaveState(original, state) != size) {
+        printf("FAIL snapshot: saveState() size differs from getStateSize()\n");
+        g->failures++;
+    }
+    renderSpan(original, &score, 128, SNAPSHOT_FRAME, FRAMES);
+    memcpy(expected, output + SNAPSHOT_FRAME * 2, sizeof(expected));
+
+    void* restored = create(SAMPLE_RATE, 128);
+    if (!instanceLoadState(restored, state, size)) {
+        printf("FAIL snapshot: loadState() rejected its own snapshot\n");
+        g->failures++;
+    }
+    renderSpan(restored, &score, 128, SNAPSHOT_FRAME, FRAMES);
+    if (memcmp(expected, output + SNAPSHOT_FRAME * 2, sizeof(expected)) != 0) {
+        printf("FAIL snapshot: restored instance renders differently\n");
+        g->failures++;
+    }
+
+    // Truncated snapshots are rejected
+    if (instanceLoadState(restored, state, size - 1)) {
+        printf("FAIL snapshot: loadState() accepted a truncated snapshot\n");
+        g->failures++;
+    }
+
+    free(state);
+    destroy(original);
+    destroy(restored);
+}
+
+int main(int argc, char** argv) {
+    Golden g;
+    if (!goldenOpen(&g, argc, argv)) return 1;
+    startHostRenderThreads();
+
+    char name[64];
+    Score score = chord();
+
+    // Every waveform and oscillator mode
+    for (int waveform = 0; waveform < 5; waveform++) {
+        int modes = waveform == 4 ? 1 : 2;
+        for (int mode = 0; mode < modes; mode++) {
+            snprintf(name, sizeof(name), "chord-%s-%s", waveformNames[waveform], modeNames[mode]);
+            runScore(&g, name, newSynth(waveform, mode), &score, 128);
+        }
+    }
+
+    // Block size must not change the sound
+    runScore(&g, "chord-saw-block32", newSynth(2, 1), &score, 32);
+    runScore(&g, "chord-saw-block4096", newSynth(2, 1), &score, 4096);
+
+    // Pitch bend sweep and filter CCs at exact offsets
+    Score bend = chord();
+    for (int i = 0; i < 16; i++) {
+        scoreAdd(&bend, 1000 + i * 1000, EVENT_PITCH_BEND, 8192 + i * 500, 0);
+    }
+    runScore(&g, "bend-saw", newSynth(2, 1), &bend, 128);
+
+    Score sweep = chord();
+    for (int i = 0; i < 16; i++) {
+        scoreAdd(&sweep, 500 + i * 1300, EVENT_CONTROL_CHANGE, 74, 127 - i * 8);
+        scoreAdd(&sweep, 700 + i * 1300, EVENT_CONTROL_CHANGE, 71, i * 8);
+    }
+    runScore(&g, "cutoff-cc-square", newSynth(1, 1), &sweep, 128);
+
+    // Saturation modes on a dense chord
+    Score loud = { .count = 0 };
+    for (int i = 0; i < 10; i++) {
+        scoreAdd(&loud, 0, EVENT_NOTE_ON, 48 + i * 2, 127);
+    }
+    for (int mode = 0; mode < 3; mode++) {
+        snprintf(name, sizeof(name), "saturation-%d", mode);
+        void* synth = newSynth(2, 1);
+        instanceSetParameter(synth, PARAM_SATURATION, (float)mode);
+        runScore(&g, name, synth, &loud, 128);
+    }
+
+    // More notes than voices
+    Score steal = { .count = 0 };
+    for (int i = 0; i < 24; i++) {
+        scoreAdd(&steal, i * 900, EVENT_NOTE_ON, 40 + i, 100 - i * 2);
+    }
+    runScore(&g, "voice-stealing", newSynth(3, 0), &steal, 128);
+
+    // Unison: three lanes per voice without spread (mono, voices straddling
+    // groups), and eight spread ones, so the chord's third note steals
+    void* unison = newSynth(2, 1);
+    instanceSetParameter(unison, PARAM_UNISON, 3.0f);
+    instanceSetParameter(unison, PARAM_STEREO_SPREAD, 0.0f);
+    runScore(&g, "unison-3-mono", unison, &score, 128);
+
+    unison = newSynth(2, 0);
+    instanceSetParameter(unison, PARAM_UNISON, 8.0f);
+    instanceSetParameter(unison, PARAM_UNISON_DETUNE, 0.3f);
+    instanceSetParameter(unison, PARAM_STEREO_SPREAD, 1.0f);
+    runScore(&g, "unison-8-spread", unison, &score, 128);
+
+    // Custom single-cycle wavetable (built with NUM_CUSTOM_WAVETABLES slots)
+    float shape[600];
+    for (int i = 0; i < 600; i++) {
+        float t = i / 600.0f;
+        shape[i] = t < 0.3f ? t / 0.3f : (t < 0.5f ? 1.0f : -t);
+    }
+    void* custom = newSynth(WAVE_CUSTOM, 1);
+    instanceLoadWavetable(custom, 0, shape, 600);
+    runScore(&g, "custom-wavetable", custom, &score, 128);
+
+    // Cutoff automation, evaluated inside the plugin at any block size
+    static const AutomationPoint cutoffCurve[] = {
+        { 0, 300.0f, CURVE_LINEAR, 0.0f },
+        { FRAMES / 4, 8000.0f, CURVE_EXPONENTIAL, 0.7f },
+        { FRAMES / 2, 600.0f, CURVE_SMOOTH, 0.0f },
+        { FRAMES * 3 / 4, 3000.0f, CURVE_STEP, 0.0f }
+    };
+    void* automated = newSynth(2, 1);
+    automate(automated, PARAM_CUTOFF, cutoffCurve, 4);
+    runScore(&g, "automation-cutoff", automated, &score, 128);
+
+    automated = newSynth(2, 1);
+    automate(automated, PARAM_CUTOFF, cutoffCurve, 4);
+    runScore(&g, "automation-cutoff-block4096", automated, &score, 4096);
+
+    // Offline path renders the same score in one call
+    void* offline = newSynth(2, 1);
+    instanceProcessOffline(offline, NULL, planar, FRAMES, score.events, score.count);
+    for (int i = 0; i < FRAMES; i++) {
+        output[i * 2] = planar[i];
+        output[i * 2 + 1] = planar[FRAMES + i];
+    }
+    goldenCheck(&g, "offline-chord-saw", output, FRAMES, 2);
+    destroy(offline);
+
+    checkSnapshot(&g);
+
+    stopHostRenderThreads();
+    return goldenClose(&g);
+}
@@ -10,10 +10,12 @@
  * - Sample info (duration, sample rate, channels)
  * - Drag and drop to tracks
  * - Favorites/recent samples
+ * - DrumSynth (.ds) patches, rendered for a folder as it is opened
  */
 
 import React, { memo, useCallback, useRef, useEffect, useMemo, useState } from 'react';
 import { SamplePreview, SampleInfo, createSamplePreview } from '../../audio/SamplePreview';
+import { getDrumSynthRenderer, isDrumSynthPatch } from '../../audio/plugins/DrumSynthRenderer';
 import { Button, Slider } from '../common';
 
 interface SampleFile {
@@ -372,6 +374,26 @@ export const SampleBrowser: React.FC<SampleBrowserProps> = memo(({
     setFiles(list);
   }, [currentPath, manifestFiles]);
   
+  // Render the folder's DrumSynth patches in the background, so auditioning
+  // them plays from the cache
+  useEffect(() => {
+    if (!audioContext) return;
+    
+    const patches = files
+      .filter(f => f.type === 'file' && isDrumSynthPatch(f.path))
+      .map(f => f.path);
+    if (patches.length === 0) return;
+    
+    let cancelled = false;
+    getDrumSynthRenderer()
+      .prerender(patches, audioContext.sampleRate, { isCancelled: () => cancelled })
+      .catch(error => console.warn('DrumSynth prerender failed:', error));
+    
+    return () => {
+      cancelled = true;
+    };
+  }, [files, audioContext]);
+  
   // Load favorites from localStorage
   useEffect(() => {
     const savedFavorites = localStorage.getItem('sampleBrowser_favorites');
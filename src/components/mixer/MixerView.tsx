@@ -9,6 +9,7 @@
 import React, { useState, useCallback, useRef, memo } from 'react';
 import { useMixerStore, useChannels, useMasterChannel, useHistoryStore } from '../../stores';
 import { MixerChannel } from './MixerChannel';
+import { PluginLoadPanel } from './PluginLoadPanel';
 import { Button } from '../common';
 import type { MixerChannelData } from '../../types/song';
 import { generateCommandId } from '../../utils/commands/Command';
@@ -27,6 +28,7 @@ export const MixerView: React.FC = memo(() => {
   
   const [dragState, setDragState] = useState<DragState | null>(null);
   const [showAddMenu, setShowAddMenu] = useState(false);
+  const [showLoadPanel, setShowLoadPanel] = useState(false);
   const [viewMode, setViewMode] = useState<'full' | 'compact'>('full');
   const containerRef = useRef<HTMLDivElement>(null);
 
@@ -214,6 +216,23 @@ export const MixerView: React.FC = memo(() => {
 
         <div className="flex-1" />
 
+        {/* Plugin DSP load */}
+        <div className="relative">
+          <Button
+            size="sm"
+            variant={showLoadPanel ? 'secondary' : 'ghost'}
+            onClick={() => setShowLoadPanel(!showLoadPanel)}
+          >
+            Charge DSP
+          </Button>
+
+          {showLoadPanel && (
+            <div className="absolute top-full right-0 mt-1 bg-daw-bg-elevated border border-daw-border rounded shadow-lg z-50">
+              <PluginLoadPanel />
+            </div>
+          )}
+        </div>
+
         {/* Channel count */}
         <span className="text-xs text-daw-text-muted">
           {channels.length} {channels.length !== 1 ? 'canaux' : 'canal'}
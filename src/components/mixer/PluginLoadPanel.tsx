@@ -0,0 +1,75 @@
+// Copyright (c) 2025 Jema Technology.
+// Distributed under the license specified in the root directory of this project.
+/**
+ * PluginLoadPanel - DSP load per WASM plugin
+ * Features: average/peak load of the realtime budget, xrun-risk block count,
+ * trace export for chrome://tracing or Perfetto
+ */
+
+import React, { useState, useEffect, useCallback, memo } from 'react';
+import { Button } from '../common';
+import { AudioExporter } from '../../audio/AudioExporter';
+import { getPluginLoadMonitor, type PluginLoadEntry } from '../../audio/plugins/PluginLoadMonitor';
+
+const loadColor = (load: number): string =>
+  load > 0.8 ? 'text-red-500' : load > 0.5 ? 'text-yellow-500' : 'text-daw-text-secondary';
+
+const formatLoad = (load: number): string => `${(load * 100).toFixed(1)}%`;
+
+export const PluginLoadPanel: React.FC = memo(() => {
+  const [entries, setEntries] = useState<PluginLoadEntry[]>(() => getPluginLoadMonitor().getEntries());
+
+  // Polling runs only while the panel is mounted
+  useEffect(() => {
+    return getPluginLoadMonitor().subscribe(next => setEntries([...next]));
+  }, []);
+
+  const handleExportTrace = useCallback(() => {
+    const blob = new Blob([getPluginLoadMonitor().exportTrace()], { type: 'application/json' });
+    AudioExporter.downloadBlob(blob, `dsp-load-${Date.now()}.json`);
+  }, []);
+
+  return (
+    <div className="w-80 p-2 text-xs">
+      <div className="flex items-center justify-between mb-2">
+        <span className="text-daw-text-primary font-medium">Charge DSP des plugins</span>
+        <Button size="sm" variant="ghost" onClick={handleExportTrace} disabled={entries.length === 0}>
+          Exporter la trace
+        </Button>
+      </div>
+
+      {entries.length === 0 ? (
+        <p className="text-daw-text-muted py-2">Aucun plugin WASM actif</p>
+      ) : (
+        <table className="w-full">
+          <thead>
+            <tr className="text-daw-text-muted text-left">
+              <th className="font-normal">Plugin</th>
+              <th className="font-normal text-right">Moy.</th>
+              <th className="font-normal text-right">Crête</th>
+              <th className="font-normal text-right" title="Blocs au-delà de 50 % du budget temps réel">Risque</th>
+            </tr>
+          </thead>
+          <tbody>
+            {entries.map(entry => (
+              <tr key={entry.id}>
+                <td className="text-daw-text-primary truncate max-w-[120px]" title={entry.name}>{entry.name}</td>
+                <td className={`font-mono text-right ${loadColor(entry.stats.load)}`}>
+                  {formatLoad(entry.stats.load)}
+                </td>
+                <td className={`font-mono text-right ${loadColor(entry.maxLoad)}`} title={`${entry.stats.peakBlockMs.toFixed(3)} ms`}>
+                  {formatLoad(entry.maxLoad)}
+                </td>
+                <td className={`font-mono text-right ${entry.stats.xrunRiskBlocks > 0 ? 'text-red-500' : 'text-daw-text-secondary'}`}>
+                  {entry.stats.xrunRiskBlocks}
+                </td>
+              </tr>
+            ))}
+          </tbody>
+        </table>
+      )}
+    </div>
+  );
+});
+
+PluginLoadPanel.displayName = 'PluginLoadPanel';
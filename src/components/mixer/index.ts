@@ -5,4 +5,5 @@
  */
 
 export { MixerView } from './MixerView';
-export { MixerChannel } from './MixerChannel';
\ No newline at end of file
+export { MixerChannel } from './MixerChannel';
+export { PluginLoadPanel } from './PluginLoadPanel';
\ No newline at end of file
@@ -0,0 +1,197 @@
+// Copyright (c) 2025 Jema Technology.
+// Distributed under the license specified in the root directory of this project.
+/**
+ * WASMEffectPlugin worklet processor smoke tests
+ *
+ * Evaluates the generated processor source against a stub
+ * AudioWorkletGlobalScope and a fake plugin (a gain of 2 on its planar
+ * buffers, quiescent after a silent block), so errors in the inlined source
+ * show up without a browser.
+ */
+
+import { describe, it, expect, beforeAll, afterAll, vi } from 'vitest';
+import { wasmEffectProcessorSource } from '../../audio/plugins/WASMEffectPlugin';
+
+const BLOCK = 128;
+
+interface StubProcessor {
+  sent: Array<{ type: string; [key: string]: unknown }>;
+  port: { onmessage: ((event: { data: unknown }) => void) | null };
+  process(inputs: Float32Array[][], outputs: Float32Array[][]): boolean;
+}
+
+type ProcessorClass = new () => StubProcessor;
+
+const scope = globalThis as Record<string, unknown>;
+let Processor: ProcessorClass;
+let batchCounts: number[];
+let failHandleArrays = false;
+
+// Fake plugin exports over the memory the worklet created
+function fakePlugin(memory: WebAssembly.Memory): WebAssembly.Exports {
+  let heap = 1024;
+  const buffers = new Map<number, number[]>();
+  const quiet = new Map<number, boolean>();
+  const malloc = (bytes: number) => {
+    // The smallest EffectBatchGroup handle array
+    if (failHandleArrays && bytes === 8 * 4) return 0;
+    const ptr = heap;
+    heap += (bytes + 15) & ~15;
+    return ptr;
+  };
+  const gain = (handle: number, frames: number, channels: number) => {
+    const floats = new Float32Array(memory.buffer);
+    let silent = true;
+    for (let ch = 0; ch < channels; ch++) {
+      const base = buffers.get(handle)![ch] / 4;
+      for (let i = 0; i < frames; i++) {
+        floats[base + i] *= 2;
+        if (floats[base + i] !== 0) silent = false;
+      }
+    }
+    quiet.set(handle, silent);
+  };
+
+  return {
+    malloc,
+    free: () => undefined,
+    create: () => {
+      const handle = malloc(16);
+      buffers.set(handle, [malloc(BLOCK * 4), malloc(BLOCK * 4)]);
+      return handle;
+    },
+    destroy: () => undefined,
+    instanceGetInputBuffer: (handle: number, ch: number) => buffers.get(handle)![ch],
+    instanceGetOutputBuffer: (handle: number, ch: number) => buffers.get(handle)![ch],
+    instanceProcessBuffers: gain,
+    instanceSetParameter: () => undefined,
+    instanceGetLatency: () => 0,
+    instanceIsQuiescent: (handle: number) => ((quiet.get(handle) ?? true) ? 1 : 0),
+    processBatch: (ptr: number, count: number, frames: number, channels: number) => {
+      batchCounts.push(count);
+      for (const handle of new Int32Array(memory.buffer, ptr, count)) gain(handle, frames, channels);
+    }
+  } as unknown as WebAssembly.Exports;
+}
+
+async function createProcessor(moduleKey: string, batch: boolean): Promise<StubProcessor> {
+  const processor = new Processor();
+  processor.port.onmessage?.({
+    data: {
+      type: 'init',
+      wasmModule: new WebAssembly.Module(new Uint8Array([0x00, 0x61, 0x73, 0x6d, 1, 0, 0, 0])),
+      moduleKey,
+      memoryDescriptor: { initial: 1, maximum: 4 },
+      params: [],
+      batch
+    }
+  });
+  await vi.waitFor(() => expect(processor.sent.length).toBeGreaterThan(0));
+  return processor;
+}
+
+function block(value: number): Float32Array[] {
+  return [new Float32Array(BLOCK).fill(value), new Float32Array(BLOCK).fill(value)];
+}
+
+describe('WASMEffectPlugin worklet processor', () => {
+  beforeAll(() => {
+    scope.sampleRate = 48000;
+    scope.currentFrame = 0;
+    scope.AudioWorkletProcessor = class {
+      sent: unknown[] = [];
+      port = { postMessage: (message: unknown) => this.sent.push(message), onmessage: null };
+    };
+    scope.registerProcessor = (_name: string, processor: ProcessorClass) => {
+      Processor = processor;
+    };
+    batchCounts = [];
+
+    vi.spyOn(WebAssembly, 'instantiate').mockImplementation((async (
+      _module: WebAssembly.Module,
+      imports: { env: { memory: WebAssembly.Memory } }
+    ) => ({ exports: fakePlugin(imports.env.memory) })) as unknown as typeof WebAssembly.instantiate);
+
+    new Function(wasmEffectProcessorSource)();
+  });
+
+  afterAll(() => {
+    vi.restoreAllMocks();
+    for (const name of ['sampleRate', 'currentFrame', 'AudioWorkletProcessor', 'registerProcessor']) {
+      delete scope[name];
+    }
+  });
+
+  it('should register and initialize', async () => {
+    expect(Processor).toBeDefined();
+
+    const processor = await createProcessor('single', false);
+    expect(processor.sent[0]).toEqual({ type: 'initialized', latency: 0 });
+
+    const output = block(0);
+    processor.process([block(0.5)], [output]);
+    expect(output[0][0]).toBe(1);
+    expect(output[1][BLOCK - 1]).toBe(1);
+  });
+
+  it('should process batched instances in one call, a render quantum later', async () => {
+    const a = await createProcessor('batched', true);
+    const b = await createProcessor('batched', true);
+    expect(a.sent[0]).toEqual({ type: 'initialized', latency: BLOCK });
+
+    const outA = block(0);
+    const outB = block(0);
+    scope.currentFrame = 0;
+    a.process([block(1)], [outA]);
+    b.process([block(3)], [outB]);
+    expect(batchCounts).toEqual([2]);
+    expect(outA[0][0]).toBe(0);
+
+    scope.currentFrame = BLOCK;
+    a.process([block(0)], [outA]);
+    b.process([block(0)], [outB]);
+    expect(outA[0][0]).toBe(2);
+    expect(outB[1][0]).toBe(6);
+  });
+  
+  it('should stay unbatched when the handle array cannot be allocated', async () => {
+    failHandleArrays = true;
+    const processor = await createProcessor('unbatched', true);
+    failHandleArrays = false;
+    expect(processor.sent[0]).toEqual({ type: 'initialized', latency: 0 });
+    
+    const output = block(0);
+    processor.process([block(2)], [output]);
+    expect(output[0][0]).toBe(4);
+  });
+  
+  it('should output a batched block queued while idle before bypassing again', async () => {
+    const a = await createProcessor('impulse', true);
+    const b = await createProcessor('impulse', true);
+    const outA = block(0);
+    const outB = block(0);
+    const quantum = (frame: number, inputA: number) => {
+      scope.currentFrame = frame;
+      a.process([block(inputA)], [outA]);
+      b.process([block(0)], [outB]);
+    };
+    
+    // Silence until both are idle
+    quantum(0, 0);
+    quantum(BLOCK, 0);
+    expect(a.sent).toContainEqual({ type: 'idle', idle: true });
+    
+    // One quantum of signal into the first to arrive, which the group only
+    // processes once the next quantum starts
+    quantum(2 * BLOCK, 1);
+    expect(outA[0][0]).toBe(0);
+    
+    quantum(3 * BLOCK, 0);
+    expect(outA[0][0]).toBe(2);
+    expect(outA[1][BLOCK - 1]).toBe(2);
+    
+    quantum(4 * BLOCK, 0);
+    expect(outA[0][0]).toBe(0);
+    expect(outB[0][0]).toBe(0);
+  });
+});